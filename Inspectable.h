@@ -23,38 +23,555 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
 #include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef xoins_thread_pool
+#include <condition_variable>
+#include <thread>
+#endif // xoins_thread_pool
+
+#ifdef xoins_journal
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // xoins_journal
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Customization
 //////////////////////////////////////////////////////////////////////////////////////////
-// You can manually define xoins_list, xoins_list_add and xoins_list_remove before
-// including this file to determine which std::vector compatible container and methods
-// are used.
+// Inspectable and its scoped helpers take a container policy as their last template
+// parameter (TPolicy). A policy decides which container stores an Inspectable's
+// transformations. It only needs a nested template 'List':
+//
+//   struct MyPolicy {
+//     template<typename E> using List = MyContainer<E>;
+//   };
+//
+// Where MyContainer<E> (E is always a pointer type) provides:
+//
+//   begin() / end()                   const forward iteration yielding E
+//   bool IsEmpty() const
+//   void Add(E e)                     append e
+//   void Insert(E e, Less less)       insert e ordered by 'less' (a template parameter)
+//   bool Remove(E e)                  remove e, keeping the order of everything else
+//   bool Replace(E from, E to)        put 'to' where 'from' is (false if from isn't there)
+//   bool Contains(E e) const
+//   void Clear()
+//
+// Shipped policies:
+//   xoins::VectorPolicy<TAllocator>   std::vector with an optional allocator template.
+//   xoins::SmallVectorPolicy<N>       N elements stored inline, then spills to the heap.
+//   xoins::IntrusiveListPolicy        transformations are linked through a hook in
+//                                     InspectableTransformation so adding never
+//                                     allocates (see Hook below).
+//   xoins::SortedFlatPolicy<TAlloc>   a vector kept sorted on insert (binary search)
+//                                     instead of being re-sorted after every add.
+//   xoins::HotColdPolicy              what ForceUpdate reads packed next to the list,
+//                                     with an enabled bitmask (see HotColdList).
+//   xoins::PriorityBucketPolicy       one append-only vector per priority, so adding
+//                                     never sorts or shifts (see PriorityBucketList).
+//
+// xoins::DefaultListPolicy is SmallVectorPolicy<xoins_inline_transformations>. You can
+// define xoins_inline_transformations before including this file to change how many
+// transformations the default policy stores without allocating.
 //
-// Note: currently the container must also contain .begin() and .end() to be compatible
-// with find. We also pass an itterator found this way to the erase method.
+// A policy whose list links through its elements names the base they need as Hook, like
+// xoins::IntrusiveListPolicy does with xoins::IntrusiveListHook. The transformations an
+// Inspectable<T, TPolicy> takes are then InspectableTransformation<T, TPolicy::Hook>
+// (Inspectable<T, TPolicy>::TTransform), and the hook costs only those. Every other
+// policy takes plain InspectableTransformation<T>.
 //
-// Note: until noted otherwise: this functionality is completely untested. Let me know if
-// you end up using it, or want to be a use case.
+// Define xoins_thread_pool before including this file to get xoins::ThreadPoolDispatcher
+// (see Parallel dispatch). It is left out by default so this file doesn't pull in
+// <thread> for everyone.
+//
+// Define xoins_journal before including this file to get xoins::Journal and
+// InspectableJournal (see Journal). They memory map a file, so they need a POSIX system.
 //
 //////////////////////////////////////////////////////////////////////////////////////////
-#ifndef xoins_list
-#include <vector>
-#define xoins_list_internal         1
-#define xoins_list                  std::vector
-#endif // xoins_list
+#ifndef xoins_inline_transformations
+#define xoins_inline_transformations_internal 1
+#define xoins_inline_transformations 2
+#endif // xoins_inline_transformations
+
+namespace xoins {
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // IntrusiveListHook
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // Links an object into at most one IntrusiveList. Copying an object never copies its
+  // links; the copy starts out unlinked.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  class IntrusiveListHook {
+  public:
+    IntrusiveListHook();
+    IntrusiveListHook(const IntrusiveListHook&);
+    IntrusiveListHook& operator=(const IntrusiveListHook&);
+
+  private:
+    template<typename E> friend class IntrusiveList;
+
+    IntrusiveListHook*  m_HookPrev;
+    IntrusiveListHook*  m_HookNext;
+    const void*         m_HookList; // the list this hook is linked into, or null
+  };
+
+  // the hook of a policy that doesn't name one. InspectableTransformation<T> derives
+  // from it as an empty base, so it costs nothing.
+  struct NoListHook {};
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // VectorList
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // A std::vector. Insert appends and then sorts, the same as Inspectable always has.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  template<typename E, typename TAllocator = std::allocator<E> >
+  class VectorList {
+  public:
+    typedef typename std::vector<E, TAllocator>::const_iterator const_iterator;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool IsEmpty() const;
+
+    void Add(E e);
+    template<typename TLess> void Insert(E e, TLess less);
+    bool Remove(E e);
+    bool Replace(E from, E to);
+    bool Contains(E e) const;
+    void Clear();
+
+  private:
+    std::vector<E, TAllocator> m_Elements;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // SmallVector
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // Stores up to N elements inside the object. Adding an N+1th element moves everything
+  // to the heap. The inline elements share their storage with the heap pointer, so E must
+  // be a trivial type (the lists in this file only store pointers). Insert places an
+  // element with a binary search, so equal elements keep their insertion order.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  template<typename E, unsigned N>
+  class SmallVector {
+    static_assert(N > 0, "SmallVector needs at least one inline element");
+    static_assert(std::is_trivial<E>::value, "SmallVector only stores trivial types");
+  public:
+    typedef const E* const_iterator;
+
+    SmallVector();
+    SmallVector(const SmallVector& other);
+    ~SmallVector();
+
+    SmallVector& operator=(const SmallVector& other);
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool IsEmpty() const;
+    unsigned GetSize() const;
+
+    void Add(E e);
+    template<typename TLess> void Insert(E e, TLess less);
+    bool Remove(E e);
+    bool Replace(E from, E to);
+    bool Contains(E e) const;
+    void Clear();
+
+  private:
+    E*        Data();
+    const E*  Data() const;
+    void      Reserve(unsigned capacity);
+
+    unsigned  m_Size;
+    unsigned  m_Capacity; // N while the elements are inline
+    union {
+      E       m_Inline[N];
+      E*      m_Heap;
+    };
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // IntrusiveList
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // A doubly linked list threaded through the IntrusiveListHook of each element. E must
+  // be a pointer to a type deriving from IntrusiveListHook. Adding and removing never
+  // allocate, and an element can only be in one IntrusiveList at a time. The list can't
+  // be copied since its elements can't be shared.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  template<typename E>
+  class IntrusiveList {
+    static_assert(std::is_base_of<IntrusiveListHook, typename std::remove_pointer<E>::type>::value,
+                  "IntrusiveList needs a hook in each element (see IntrusiveListPolicy::Hook)");
+  public:
+    class const_iterator {
+    public:
+      const_iterator(const IntrusiveListHook* hook);
+      E operator*() const;
+      const_iterator& operator++();
+      bool operator!=(const const_iterator& other) const;
+    private:
+      const IntrusiveListHook* m_Hook;
+    };
+
+    IntrusiveList();
+    ~IntrusiveList();
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool IsEmpty() const;
+
+    void Add(E e);
+    template<typename TLess> void Insert(E e, TLess less);
+    bool Remove(E e);
+    bool Replace(E from, E to);
+    bool Contains(E e) const;
+    void Clear();
+
+  private:
+    IntrusiveList(const IntrusiveList&);
+    IntrusiveList& operator=(const IntrusiveList&);
+
+    void LinkBefore(IntrusiveListHook* hook, IntrusiveListHook* next);
+
+    IntrusiveListHook* m_Head;
+    IntrusiveListHook* m_Tail;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // SortedFlatList
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // A vector which Insert keeps ordered with a binary search, so nothing is ever re-sorted.
+  // Equal elements keep their insertion order. Add still appends.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  template<typename E, typename TAllocator = std::allocator<E> >
+  class SortedFlatList {
+  public:
+    typedef typename std::vector<E, TAllocator>::const_iterator const_iterator;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool IsEmpty() const;
+
+    void Add(E e);
+    template<typename TLess> void Insert(E e, TLess less);
+    bool Remove(E e);
+    bool Replace(E from, E to);
+    bool Contains(E e) const;
+    void Clear();
+
+  private:
+    std::vector<E, TAllocator> m_Elements;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // HotColdList
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // A list of transformations that also keeps everything ForceUpdate needs packed in
+  // arrays: each transformation's priority and a pointer straight to its function, a copy
+  // of its op (see TransformOp) when it has one, in evaluation order, plus a bitmask of
+  // the ones that are enabled and have something to call. ForceUpdate scans the set bits
+  // and runs the copied ops with a switch, calling through a pointer only for functions,
+  // so it never reads the transformation objects. Insert finds its place from the cached
+  // priorities. Equal priorities keep their insertion order.
+  //
+  // When one of its transformations is enabled, disabled or set, or an InspectableToggle
+  // it uses flips, the owning Inspectable marks just this list stale (see MarkStale), and
+  // the list rebuilds its bitmask and op copies (reading each of its transformations
+  // once) the next time it runs. Lists of other Inspectables are left alone. This suits
+  // Inspectables that update far more often than their transformations are toggled.
+  //
+  // E must be an InspectableTransformation pointer. Insert orders by priority and
+  // ignores the ordering it's given.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  template<typename T> struct TransformOp;
+
+  template<typename E>
+  class HotColdList {
+    typedef typename std::remove_pointer<E>::type TCold;
+    typedef typename TCold::TValue TValue;
+    typedef TransformOp<TValue> TOp;
+
+  public:
+    typedef typename std::vector<E>::const_iterator const_iterator;
+
+    HotColdList();
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool IsEmpty() const;
+
+    void Add(E e);
+    template<typename TLess> void Insert(E e, TLess less);
+    bool Remove(E e);
+    bool Replace(E from, E to);
+    bool Contains(E e) const;
+    void Clear();
+
+    void Run(TValue& value); // runs every enabled transformation, in order
+    void MarkStale(); // rebuilds the bitmask and op copies on the next Run
+    bool IsStale() const;
+
+  private:
+    struct HotEntry {
+      void        (*invoke)(const void* context, TValue& value); // null to run the op copy
+      const void* context;
+      int         priority;
+    };
+
+    void Refresh();
+
+    std::vector<E>        m_Elements;
+    std::vector<HotEntry> m_Hot;      // parallel to m_Elements
+    std::vector<TOp>      m_Ops;      // parallel to m_Elements, empty for types without ops
+    std::vector<uint64_t> m_Enabled;  // one bit per element
+    bool                  m_Stale;    // the elements changed since m_Enabled was built
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // PriorityBucketList
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // Transformations grouped into one bucket per priority, with the buckets kept sorted
+  // from highest to lowest priority. Insert finds its bucket with a binary search over
+  // the (usually few) priorities in use and appends to it, so adding at a priority that's
+  // already used is amortized O(1), nothing is ever sorted, and equal priorities keep
+  // their insertion order. A bucket is dropped when its last element is removed.
+  //
+  // E must be an InspectableTransformation pointer. Insert orders by priority and
+  // ignores the ordering it's given. Add appends after everything else when E's priority
+  // is no higher than the last bucket's, and otherwise inserts it by priority.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  template<typename E>
+  class PriorityBucketList {
+    struct Bucket {
+      int             priority;
+      std::vector<E>  elements;
+    };
+
+  public:
+    class const_iterator {
+    public:
+      const_iterator(const Bucket* bucket, const Bucket* end);
+      E operator*() const;
+      const_iterator& operator++();
+      bool operator==(const const_iterator& other) const;
+      bool operator!=(const const_iterator& other) const;
+
+    private:
+      const Bucket* m_Bucket;
+      const Bucket* m_End;
+      size_t        m_Index;
+    };
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    bool IsEmpty() const;
+
+    void Add(E e);
+    template<typename TLess> void Insert(E e, TLess less);
+    bool Remove(E e);
+    bool Replace(E from, E to);
+    bool Contains(E e) const;
+    void Clear();
+
+  private:
+    std::vector<Bucket> m_Buckets;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // Policies
+  //////////////////////////////////////////////////////////////////////////////////////////
+  template<template<typename> class TAllocator = std::allocator>
+  struct VectorPolicy {
+    template<typename E> using List = VectorList<E, TAllocator<E> >;
+  };
+
+  template<unsigned N>
+  struct SmallVectorPolicy {
+    template<typename E> using List = SmallVector<E, N>;
+  };
+
+  struct IntrusiveListPolicy {
+    template<typename E> using List = IntrusiveList<E>;
+    typedef IntrusiveListHook Hook;
+  };
+
+  template<template<typename> class TAllocator = std::allocator>
+  struct SortedFlatPolicy {
+    template<typename E> using List = SortedFlatList<E, TAllocator<E> >;
+  };
+
+  struct HotColdPolicy {
+    template<typename E> using List = HotColdList<E>;
+  };
+
+  struct PriorityBucketPolicy {
+    template<typename E> using List = PriorityBucketList<E>;
+  };
+
+  namespace internal {
+    unsigned CountTrailingZeros(uint64_t bits); // bits can't be 0
+
+    // TPolicy::Hook if the policy names one, NoListHook otherwise.
+    template<typename> struct VoidType { typedef void Type; };
+    template<typename TPolicy, typename = void> struct PolicyHook { typedef NoListHook Type; };
+    template<typename TPolicy>
+    struct PolicyHook<TPolicy, typename VoidType<typename TPolicy::Hook>::Type> {
+      typedef typename TPolicy::Hook Type;
+    };
+  }
+
+  typedef SmallVectorPolicy<xoins_inline_transformations> DefaultListPolicy;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Transform ops
+//////////////////////////////////////////////////////////////////////////////////////////
+// A closed set of common transformations, which an InspectableTransformation can hold
+// instead of a function. Inspectable::ForceUpdate runs them with a switch over the op
+// kind rather than a call through std::function, so they can be inlined and branch
+// prediction sees the same code for every transformation. With xoins::HotColdPolicy the
+// list also keeps copies of the ops packed in evaluation order, so ForceUpdate doesn't
+// read the transformations at all (bench/Ops.cpp compares them):
+//
+//   InspectableTransformation<float> haste(xoins::MulOp(1.2f), 10);
+//   InspectableTransformation<float> cap(xoins::ClampOp(0.f, 100.f));
+//
+// Each op works on the value coming in (v):
+//   AddOp(a)             v + a
+//   MulOp(a)             v * a
+//   SetOp(a)             a
+//   MinOp(a), MaxOp(a)   the smaller or larger of v and a
+//   ClampOp(low, high)   v clamped to [low, high]
+//   LerpOp(target, t)    v + (target - v) * t
+//   CurveOp(points, n)   the piecewise linear curve through n points sorted by x,
+//                        held flat past either end. The points aren't copied, so they
+//                        have to outlive the op.
+//
+// Ops are only run for types where xoins::TransformOpTraits<T>::Enabled is true: every
+// arithmetic type but bool, and xoins::Fixed. Specialize it for your own value
+// types that have + - * and <. Curves divide through xoins::ModifierTraits<T>.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  enum TransformOpKind {
+    TransformOpNone, // the transformation uses its function instead
+    TransformOpAdd,
+    TransformOpMul,
+    TransformOpSet,
+    TransformOpMin,
+    TransformOpMax,
+    TransformOpClamp,
+    TransformOpLerp,
+    TransformOpCurve,
+  };
+
+  template<typename T>
+  struct CurvePoint {
+    T x;
+    T y;
+  };
+
+  // kind is last so it packs with curveCount. Make them with the functions below.
+  template<typename T>
+  struct TransformOp {
+    T                     a;
+    T                     b;
+    const CurvePoint<T>*  curve;
+    uint32_t              curveCount;
+    TransformOpKind       kind;
+  };
+
+  template<typename T>
+  struct TransformOpTraits {
+    static const bool Enabled = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value;
+  };
+
+  template<typename T> TransformOp<T> AddOp(const T& amount);
+  template<typename T> TransformOp<T> MulOp(const T& factor);
+  template<typename T> TransformOp<T> SetOp(const T& value);
+  template<typename T> TransformOp<T> MinOp(const T& value);
+  template<typename T> TransformOp<T> MaxOp(const T& value);
+  template<typename T> TransformOp<T> ClampOp(const T& minimum, const T& maximum);
+  template<typename T> TransformOp<T> LerpOp(const T& target, const T& t);
+  template<typename T> TransformOp<T> CurveOp(const CurvePoint<T>* points, size_t count);
+
+  namespace internal {
+    template<typename T> TransformOp<T> MakeTransformOp(TransformOpKind kind, const T& a, const T& b);
 
-#ifndef xoins_list_add
-#define xoins_list_add_internal     1
-#define xoins_list_add              push_back
-#endif // xoins_list_add
+    template<typename T> void ApplyTransformOp(const TransformOp<T>& op, T& value, std::true_type);
+    template<typename T> void ApplyTransformOp(const TransformOp<T>& op, T& value, std::false_type);
+    template<typename T> T EvaluateCurve(const CurvePoint<T>* points, uint32_t count, const T& x);
+  }
+}
+
+namespace xoins {
+  // A set of rule contexts (vs players, vs NPCs, in a safe zone...), one per bit. See
+  // InspectableTransformation::SetContextMask and Inspectable::GetContextValue.
+  typedef uint32_t ContextMask;
+  const ContextMask AllContexts = 0xffffffffu;
+
+  namespace internal {
+    // the Inspectables a transformation is attached to, so it can tell them when it
+    // changes or is destroyed. Most transformations have one, which is kept inline.
+    class TransformOwners {
+    public:
+      enum Event {
+        Changed,  // contexts says which context masks the change can affect
+        Destroyed,
+      };
+      typedef void (*Callback)(void* inspectable, void* transformation, Event event, ContextMask contexts);
+
+      TransformOwners();
+      TransformOwners(const TransformOwners&); // a copy isn't attached anywhere
+      TransformOwners& operator=(const TransformOwners&); // keeps its own owners
+      ~TransformOwners();
+
+      void Add(void* inspectable, Callback callback); // once per time it's attached
+      void Remove(void* inspectable); // one of the inspectable's registrations
+      bool Contains(const void* inspectable) const; // whether it's registered at all
+      void Notify(void* transformation, ContextMask contexts) const;
+      // forgets every owner, then tells each that the transformation is going away.
+      void NotifyDestroyed(void* transformation);
+      // takes every owner of 'other', which is left with none, for a transformation that
+      // moved to a new address.
+      void TakeOver(TransformOwners& other);
 
-#ifndef xoins_list_erase
-#define xoins_list_erase_internal   1
-#define xoins_list_erase            erase
-#endif // xoins_list_erase
+    private:
+      struct Owner {
+        void*     inspectable;
+        Callback  callback;
+      };
+      typedef std::vector<Owner> Overflow;
+
+      bool IsOverflowing() const;
+
+      // the only owner. With a null callback, inspectable is an Overflow of them all.
+      Owner m_First;
+    };
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // InspectableTransform
@@ -68,20 +585,61 @@
 // To attach an inspectable transform to an inspectable value see:
 // Inspectable<T>::AddTransform
 //
+// THook is the base a list policy links through (see Customization), so only the
+// transformations of Inspectables using xoins::IntrusiveListPolicy carry its three
+// pointers. A transformation holds a function, an op or a definition, never more than
+// one, so they share their storage.
+//
+// A transformation knows which Inspectables it's attached to. Enable, Disable and
+// SetAbsorbing tell them, so they can drop what they cached about it (see HotColdList
+// and Inspectable::GetContextValue), and destroying an attached transformation removes
+// it from them the way RemoveTransformation does, without updating.
+//
+// Instead of its own function a transformation can use a shared
+// InspectableTransformDefinition (see below), or one of the built in xoins::TransformOp
+// (see above), which runs without calling through std::function.
+//
 //////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
-class InspectableTransformation {
+template<typename T> class InspectableTransformDefinition;
+class InspectableToggle;
+
+template<typename T, typename THook = xoins::NoListHook>
+class InspectableTransformation : public THook
+{
 public:
   typedef std::function<void(T&)> TTransformFunc;
+  typedef T TValue;
 
   InspectableTransformation();
+  InspectableTransformation(const InspectableTransformation& other); // not attached anywhere
+  InspectableTransformation& operator=(const InspectableTransformation& other); // keeps its owners
+  // the same, except the function is moved rather than copied.
+  InspectableTransformation(InspectableTransformation&& other) noexcept;
+  InspectableTransformation& operator=(InspectableTransformation&& other) noexcept;
   InspectableTransformation(TTransformFunc func,
                             int priority = 0,
                             bool enabled = true);
+  InspectableTransformation(InspectableTransformDefinition<T>& definition,
+                            int priority = 0,
+                            bool enabled = true);
+  InspectableTransformation(const xoins::TransformOp<T>& op,
+                            int priority = 0,
+                            bool enabled = true);
 
+  // Don't call any Set while this is attached to an Inspectable.
   void Set(TTransformFunc func,
            int priority = 0,
            bool enabled = true);
+  void Set(InspectableTransformDefinition<T>& definition,
+           int priority = 0,
+           bool enabled = true);
+  void Set(const xoins::TransformOp<T>& op,
+           int priority = 0,
+           bool enabled = true);
+
+  // Inspectables order their transformations as they're added, so only change the
+  // priority of a transformation that isn't attached.
+  void SetPriority(int priority);
 
   // note: there's no reliable and performant way to automatically call ForceUpdate
   // from InspectableTransformation's Enable/Disable methods. You will need to call
@@ -92,20 +650,476 @@ public:
   bool IsEnabled() const;
   int GetPriority() const;
 
+  // Puts this transformation in a group switched on and off by an InspectableToggle
+  // (null for none). Like Set, don't call it while this is attached to an Inspectable.
+  void SetToggle(InspectableToggle* toggle);
+  InspectableToggle* GetToggle() const;
+  // whether this runs: it's enabled and so is its toggle, if it has one.
+  bool IsActive() const;
+
+  // The contexts this transformation applies in, for Inspectable::GetContextValue. It's
+  // xoins::AllContexts by default, and GetValue always runs it. Like Set, don't call
+  // it while this is attached to an Inspectable. Snapshots don't record it.
+  void SetContextMask(xoins::ContextMask contextMask);
+  xoins::ContextMask GetContextMask() const;
+
+  // An absorbing transformation overrides everything after it (a stun setting speed to
+  // 0): while it's active, evaluation stops once it has run, so the lower priority
+  // transformations aren't called and changing them can't change the value. Such
+  // shadowed transformations (see Inspectable::IsShadowed) can be enabled, disabled,
+  // added and removed, and their toggles and definitions changed, without the
+  // Inspectable being marked dirty or updated (andUpdate is skipped), and without
+  // dropping the context values the override also applies in. Observers still hear
+  // about additions and removals, since the list itself changed. Off by default.
+  // Snapshots don't record it.
+  //
+  //   InspectableTransformation<float> stun(xoins::SetOp(0.f), InspectableTransformation<float>::MaxPriority);
+  //   stun.SetAbsorbing(true);
+  void SetAbsorbing(bool absorbing);
+  bool IsAbsorbing() const;
+
   const TTransformFunc & GetTransformFunc() const; // Get the attached transformation
+  const xoins::TransformOp<T>& GetOp() const; // kind is TransformOpNone when using a function
+  bool HasTransform() const; // whether there's an op or a function to call
   void operator()(T& input); // Call the attached transformation
 
+  // An optional stable id for what this transformation does (0 means none). Snapshots
+  // only record transformations with a definition id, since a function can't be saved.
+  void SetDefinitionId(unsigned definitionId);
+  unsigned GetDefinitionId() const;
+
+  InspectableTransformDefinition<T>* GetDefinition() const; // null when using its own function
+
+  static const int MaxPriority = INT_MAX;
+  static const int MinPriority = INT_MIN + 1;
+  static const int InvalidPriority = INT_MIN;
 
-  const int MaxPriority = INT_MAX;
-  const int MinPriority = INT_MIN + 1;
-  const int InvalidPriority = INT_MIN;
+  ~InspectableTransformation(); // detaches this from the Inspectables it's attached to
 
 private:
+  template<typename> friend class xoins::HotColdList;
+  template<typename, typename> friend class Inspectable;
+  template<typename, typename> friend class InspectableFrameArena;
+  template<typename, typename> friend class InspectableSourceIndex;
+
+  void NotifyOwners(xoins::ContextMask contexts);
+
+  // what xoins::HotColdList calls instead of operator(), or null when it runs a copy of
+  // the op instead. False if there's nothing to call.
+  bool GetInvoker(void (*&outInvoke)(const void*, T&), const void*& outContext) const;
+  static void InvokeFunction(const void* function, T& value);
+  static void InvokeDefinition(const void* definition, T& value);
+
+  // which member of the union is alive. Only one of them is ever used at a time.
+  enum Stored {
+    StoresFunction,
+    StoresOp,
+    StoresDefinition,
+  };
+  void StoreCopy(const InspectableTransformation& other);
+  void StoreMove(InspectableTransformation& other);
+  void DestroyStored();
+
   int m_Priority;
+  unsigned m_DefinitionId;
+  xoins::ContextMask m_ContextMask;
   bool m_Enabled;
-  TTransformFunc m_Function;
+  bool m_Absorbing;
+  unsigned char m_Stored;
+  union {
+    TTransformFunc m_Function;
+    xoins::TransformOp<T> m_Op;
+    InspectableTransformDefinition<T>* m_Definition; // its function is looked up on every call
+  };
+  InspectableToggle* m_Toggle;
+  xoins::internal::TransformOwners m_Owners;
+};
+
+namespace xoins {
+  namespace internal {
+    // the Inspectables that use something shared (a definition or a toggle), with how
+    // many of their transformations use it, so they can be told when it changes.
+    class Dependents {
+    public:
+      typedef void (*Callback)(void* inspectable, const void* shared);
+
+      void    Add(void* inspectable, Callback changed);
+      void    Remove(void* inspectable);
+      void    NotifyChanged(const void* shared);
+      size_t  GetCount() const;
+
+    private:
+      struct Dependent {
+        Callback changed;
+        unsigned count;
+      };
+
+      std::unordered_map<void*, Dependent> m_Dependents;
+    };
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableTransformDefinition
+//////////////////////////////////////////////////////////////////////////////////////////
+// A transformation function shared by many InspectableTransformations, for tuning a
+// formula while the game runs. Set replaces the function for every transformation using
+// the definition at once. It also marks each Inspectable those transformations are
+// attached to dirty (see Inspectable::MarkDirty), so a single
+// xoins::UpdateDirtyInspectables recomputes exactly the affected Inspectables.
+//
+//   InspectableTransformDefinition<float> haste(xoins::MakeMulTransform(1.2f));
+//   InspectableTransformation<float> unitHaste(haste, 10); // one per unit, attached as usual
+//   ...
+//   haste.Set(xoins::MakeMulTransform(1.3f));
+//   xoins::UpdateDirtyInspectables();
+//
+// A definition has to outlive the transformations using it, since the Inspectables they
+// are attached to unregister themselves through it. Like Inspectable it isn't thread
+// safe, and Set shouldn't be called from inside the definition's own function.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+class InspectableTransformDefinition {
+public:
+  typedef std::function<void(T&)> TTransformFunc;
+
+  explicit InspectableTransformDefinition(TTransformFunc func = TTransformFunc());
+
+  void Set(TTransformFunc func);
+  const TTransformFunc& GetTransformFunc() const;
+  size_t GetDependentCount() const; // how many Inspectables use this definition
+
+private:
+  template<typename, typename> friend class Inspectable;
+
+  InspectableTransformDefinition(const InspectableTransformDefinition&);
+  InspectableTransformDefinition& operator=(const InspectableTransformDefinition&);
+
+  TTransformFunc                  m_Function;
+  xoins::internal::Dependents     m_Dependents;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableToggle
+//////////////////////////////////////////////////////////////////////////////////////////
+// A shared enable switch for a group of transformations (a rule set, a set bonus), so
+// they can be turned on and off together without touching each of them. A
+// transformation using a toggle (see InspectableTransformation::SetToggle) only runs
+// while both it and its toggle are enabled. Flipping the toggle is O(1) for the
+// transformations, and marks dirty (see Inspectable::MarkDirty) only the Inspectables
+// they're attached to, so a single xoins::UpdateDirtyInspectables recomputes them.
+//
+//   InspectableToggle pvpRules(false);
+//   InspectableTransformation<float> pvpDamage(xoins::MulOp(0.5f), 10);
+//   pvpDamage.SetToggle(&pvpRules); // before it's attached
+//   unit.m_Damage.AddTransformation(&pvpDamage);
+//   ...
+//   pvpRules.Enable();
+//   xoins::UpdateDirtyInspectables();
+//
+// Like an InspectableTransformDefinition, a toggle has to outlive the transformations
+// using it. Like Inspectable it isn't thread safe.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+class InspectableToggle {
+public:
+  explicit InspectableToggle(bool enabled = true);
+
+  void    Enable();
+  void    Disable();
+  void    Set(bool enabled);
+  bool    IsEnabled() const;
+  size_t  GetDependentCount() const; // how many Inspectables use this toggle
+
+private:
+  template<typename, typename> friend class Inspectable;
+
+  InspectableToggle(const InspectableToggle&);
+  InspectableToggle& operator=(const InspectableToggle&);
+
+  bool                        m_Enabled;
+  xoins::internal::Dependents m_Dependents;
+};
+
+namespace xoins {
+  // Updates every Inspectable marked dirty, in the order they were marked. Inspectables
+  // marked dirty during the update (by a listener, say) are updated in the same call.
+  // Inside an InspectableBatch it does nothing, since the batch will do it.
+  void UpdateDirtyInspectables();
+  size_t GetDirtyInspectableCount();
+
+  namespace internal {
+    struct DirtyEntry {
+      void* inspectable; // null once the Inspectable was destroyed
+      void  (*update)(void*);
+    };
+
+    std::vector<DirtyEntry>& DirtyList();
+    unsigned& BatchDepth(); // how many InspectableBatch scopes are open
+
+    // a buffer kept between calls, for work that would otherwise allocate every time.
+    // Swap it into a local and back out when done, so a nested call (from an observer,
+    // say) just finds it empty.
+    template<typename E> std::vector<E>& Scratch();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableBatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Defers updates while it's in scope, for changes that touch many Inspectables at once:
+//
+//   {
+//     InspectableBatch batch;
+//     for(GearPiece& piece : gearSet)
+//       piece.stat->AddTransformations(piece.begin, piece.end, true);
+//   } // each touched Inspectable updates once here, and its listeners fire once
+//
+// While any batch is open, ForceUpdate (including the andUpdate of every add, remove
+// and scoped helper) only marks the Inspectable dirty. When the outermost batch ends it
+// calls xoins::UpdateDirtyInspectables, which also updates anything that was already
+// dirty. Values read inside a batch are the ones from before it. Batches nest, and like
+// Inspectable they aren't thread safe.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+class InspectableBatch {
+public:
+  InspectableBatch();
+  ~InspectableBatch();
+
+private:
+  InspectableBatch(const InspectableBatch&);
+  InspectableBatch& operator=(const InspectableBatch&);
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableConnection
+//////////////////////////////////////////////////////////////////////////////////////////
+// A token returned when connecting a listener to an Inspectable. It names the listener's
+// slot and the generation of that slot, so Inspectable::Disconnect is O(1) and a stale
+// token (one that was already disconnected) is safely ignored. A default constructed
+// connection is not connected to anything.
+//
+// See InspectableScopedConnection to disconnect automatically.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+class InspectableConnection {
+public:
+  InspectableConnection();
+
+  bool IsValid() const; // true if this was returned by a Connect call
+  bool IsIdentityChanged() const; // false for value changed connections
+
+private:
+  template<typename, typename> friend class Inspectable;
+
+  InspectableConnection(unsigned index, unsigned generation, bool identityChanged);
+
+  unsigned m_Index;
+  unsigned m_Generation; // 0 is never used by a live slot
+  bool     m_IdentityChanged;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Parallel dispatch
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inspectables with a very large number of listeners can spread a change notification
+// across threads. It is opt-in twice over: install a ParallelDispatcher with
+// xoins::SetParallelDispatcher, then call SetParallelDispatch(true) on the Inspectables
+// that need it.
+//
+// Listeners say whether they may run on another thread when they connect
+// (xoins::AnyThread). MainThreadOnly listeners, the default, always run on the thread
+// that made the change, in order, after the AnyThread listeners have all finished.
+// AnyThread listeners run in no particular order and may only read. Every Inspectable
+// of a type shares tables that aren't locked (listeners, the dirty list, context values
+// and observers), so they must not change, update, connect to, disconnect from or
+// destroy any Inspectable, not just the one being dispatched. Debug builds assert this.
+// To change something in response, hand it to xoins::DeferFromListener, which runs it
+// on the thread that made the change once the AnyThread listeners have finished, before
+// the MainThreadOnly ones:
+//
+//   stat.ConnectOnValueChanged([&](InspectableF*, const float&, const float& value) {
+//     float scaled = Scale(value); // the expensive part runs in parallel
+//     xoins::DeferFromListener([&, scaled] { total.SetIdentity(total.GetIdentity() + scaled, true); });
+//   }, xoins::AnyThread);
+//
+// Lists with fewer than 'minListeners' AnyThread listeners are dispatched in order on the
+// calling thread as usual.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  enum ListenerThreading {
+    MainThreadOnly,
+    AnyThread,
+  };
+
+  class ParallelDispatcher {
+  public:
+    typedef void (*TJobFunc)(void* context, unsigned jobIndex);
+
+    virtual ~ParallelDispatcher() {}
+    // Call job(context, i) for every i in [0, jobCount) using any threads, including the
+    // calling one, and only return once every job has finished.
+    virtual void Run(unsigned jobCount, TJobFunc job, void* context) = 0;
+  };
+
+  void SetParallelDispatcher(ParallelDispatcher* dispatcher,
+                             unsigned minListeners = 4096,
+                             unsigned listenersPerJob = 1024);
+
+  // From an AnyThread listener, queues 'work' until the dispatch's AnyThread listeners
+  // have finished, then runs it on the thread that made the change. Anywhere else it
+  // runs right away.
+  void DeferFromListener(std::function<void()> work);
+  bool IsInAnyThreadListener(); // whether this thread is running AnyThread listeners
+
+#ifdef xoins_thread_pool
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // ThreadPoolDispatcher
+  //////////////////////////////////////////////////////////////////////////////////////////
+  // A ParallelDispatcher running jobs on its own std::threads plus the calling thread.
+  // Only compiled when xoins_thread_pool is defined before including this file. If you
+  // already have a job system, implement ParallelDispatcher on top of it instead.
+  //
+  // A job that calls Run on the dispatcher running it has its jobs run right away on its
+  // own thread. A Run from any other thread while the pool is busy waits for it.
+  //
+  //////////////////////////////////////////////////////////////////////////////////////////
+  class ThreadPoolDispatcher : public ParallelDispatcher {
+  public:
+    // threadCount is the number of worker threads, the calling thread also runs jobs.
+    // 0 uses one less than std::thread::hardware_concurrency().
+    explicit ThreadPoolDispatcher(unsigned threadCount = 0);
+    ~ThreadPoolDispatcher();
+
+    void Run(unsigned jobCount, TJobFunc job, void* context) override;
+
+  private:
+    // the dispatchers whose jobs a thread is inside of, innermost first.
+    struct RunningJob {
+      const ThreadPoolDispatcher* dispatcher;
+      const RunningJob*           outer;
+    };
+
+    ThreadPoolDispatcher(const ThreadPoolDispatcher&);
+    ThreadPoolDispatcher& operator=(const ThreadPoolDispatcher&);
+
+    void WorkerLoop();
+    void Work(std::unique_lock<std::mutex>& lock);
+    bool IsRunningJobOnThisThread() const;
+    static const RunningJob*& ThreadRunningJobs();
+
+    std::vector<std::thread>  m_Threads;
+    std::mutex                m_Mutex;
+    std::condition_variable   m_Wake;
+    std::condition_variable   m_Done;
+    TJobFunc                  m_Job;
+    void*                     m_Context;
+    unsigned                  m_JobCount;
+    unsigned                  m_NextJob;
+    unsigned                  m_Finished;
+    unsigned                  m_Active;     // threads inside Work
+    unsigned                  m_Generation; // bumped by every Run so workers wake once
+    bool                      m_Running;
+    bool                      m_Quit;
+  };
+#endif // xoins_thread_pool
+
+  namespace internal {
+    struct ParallelDispatchSettings {
+      ParallelDispatcher* dispatcher;
+      unsigned            minListeners;
+      unsigned            listenersPerJob;
+    };
+
+    ParallelDispatchSettings& GetParallelDispatchSettings();
+
+    // what AnyThread listeners hand to xoins::DeferFromListener during one dispatch.
+    struct DeferredWork {
+      std::mutex                          mutex;
+      std::vector<std::function<void()> > work;
+    };
+    // the one this thread's AnyThread listeners defer to, null outside of them.
+    DeferredWork*& CurrentDeferredWork();
+    void AssertNotInAnyThreadListener(); // see Parallel dispatch, only in debug builds
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    // ListenerSlots
+    //////////////////////////////////////////////////////////////////////////////////////
+    // The listeners of one kind for one Inspectable. Listeners sit in generation tagged
+    // slots that are reused once freed. Disconnecting while a dispatch is walking the
+    // slots only marks the slot dead: its function is destroyed, and the slot reused,
+    // when the outermost dispatch finishes. Slots live in a deque so connecting during a
+    // dispatch never moves a function that is being called. A listener connected during a
+    // dispatch may or may not be called for the change being dispatched.
+    //
+    //////////////////////////////////////////////////////////////////////////////////////
+    template<typename TOwner, typename T>
+    class ListenerSlots {
+    public:
+      typedef std::function<void(TOwner*, const T& /*lastValue*/, const T& /*newValue*/)> TFunc;
+
+      ListenerSlots();
+      // copies the live listeners, in the same slots so connections stay valid, but not
+      // the state of a dispatch that may be running on 'other'. Don't assign to slots
+      // that are dispatching.
+      ListenerSlots(const ListenerSlots& other);
+      ListenerSlots& operator=(const ListenerSlots& other);
+
+      bool      IsEmpty() const;
+      bool      IsDispatching() const;
+
+      unsigned  Connect(const TFunc& function,
+                        TFunc* external,
+                        ListenerThreading threading,
+                        unsigned& outGeneration);
+      bool      Disconnect(unsigned index, unsigned generation);
+      bool      IsConnected(unsigned index, unsigned generation) const;
+
+      // linear lookups for the pointer based Add/Remove/Contains API.
+      bool      DisconnectExternal(TFunc* external);
+      bool      ContainsExternal(TFunc* external) const;
+
+      // allowParallel: the owner opted in to parallel dispatch.
+      void      Dispatch(TOwner* owner, const T& lastValue, const T& newValue, bool allowParallel);
+
+    private:
+      struct Slot {
+        TFunc     function;
+        TFunc*    external;   // used instead of function when set
+        unsigned  generation; // bumped every time the slot is freed
+        bool      alive;
+        bool      anyThread;
+      };
+
+      struct ParallelJob {
+        ListenerSlots*  slots;
+        TOwner*         owner;
+        const T*        lastValue;
+        const T*        newValue;
+        unsigned        count;
+        unsigned        perJob;
+        DeferredWork*   deferred;
+      };
+
+      void      Call(Slot& slot, TOwner* owner, const T& lastValue, const T& newValue);
+      void      Free(unsigned index);
+      static void RunParallelJob(void* context, unsigned jobIndex);
+
+      std::deque<Slot>      m_Slots;
+      std::vector<unsigned> m_Free;
+      std::vector<unsigned> m_PendingFree; // freed during a dispatch
+      unsigned              m_Live;
+      unsigned              m_LiveAnyThread;
+      unsigned              m_Dispatching; // dispatch depth
+    };
+  }
+}
+
+template<typename T, typename TPolicy> class InspectableObserver;
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Inspectable
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -133,57 +1147,211 @@ private:
 // GetValue with an 'andUpdate' bool to instruct it to update the value before retrieving
 // its cached value.
 //
-// You can subscribe to changes in the resulting inspectable value with AddOnValueChanged
-// Or just subscribe to changes in the identity with AddOnIdentityChanged.
+// You can subscribe to changes in the resulting inspectable value with
+// ConnectOnValueChanged Or just subscribe to changes in the identity with
+// ConnectOnIdentityChanged. Both return an InspectableConnection which Disconnect removes
+// in O(1), even from inside a listener. The older pointer based AddOn*/RemoveOn* methods
+// still work but have to search for the pointer.
 //
 // For your convenience there are also scoped values that can handle the lifecycle of
-// callbacks and transformations. See ScopedInspectableTransform,
-// InspectableScopedValueChangedFunc and InspectableScopedIdentityChangedFunc
+// callbacks and transformations. See ScopedInspectableTransform and
+// InspectableScopedConnection.
+//
+// Layout: transformations are stored in a TPolicy list held inline (with the default
+// policy the first xoins_inline_transformations don't allocate). Listeners are rare, so
+// they don't live in the Inspectable at all. They're kept in a side table keyed by the
+// Inspectable's address (see xoins::internal::ListenerTable) and a single inline bit
+// (HasListeners) says whether there is anything to look up. An Inspectable nobody
+// subscribes to never touches the table, and ForceUpdate skips notification entirely.
+//
+// On a 64 bit build an Inspectable<float> with the default policy is 40 bytes, 24 of
+// them the empty SmallVector (its inline slots and count, so an Inspectable without
+// transformations is not a single null pointer). With xoins::IntrusiveListPolicy it's 32.
+// An InspectableTransformation<float> is 72 bytes: the 32 of the std::function its op or
+// definition shares storage with, 16 for the Inspectables it's attached to, and its
+// priority, flags and toggle. The hook IntrusiveListPolicy needs adds 24.
+//
+// Systems that follow every Inspectable of a type (see InspectableObserver) cost a single
+// null check while none exist. Once one does (an InspectableRollback, DeltaTracker,
+// WorldHash or Journal), every change to any Inspectable of that type makes two virtual
+// calls per observer, and every destruction one, plus whatever the observer does there.
 //
 //////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
 class Inspectable {
   typedef std::function<void(T&)> TTransformFunc; // must reflect TTransformFunc in InspectableTransformation
-  typedef InspectableTransformation<T> TTransform;
 public:
-  typedef std::function<void(Inspectable<T>*, const T& /*lastValue*/, const T& /*newValue*/)> TValueChangedFunc;
+  // the transformations this takes, with the hook TPolicy links through if it has one.
+  typedef InspectableTransformation<T, typename xoins::internal::PolicyHook<TPolicy>::Type> TTransform;
+  typedef std::function<void(Inspectable<T, TPolicy>*, const T& /*lastValue*/, const T& /*newValue*/)> TValueChangedFunc;
 
   Inspectable();
   Inspectable(T identity);
+  Inspectable(const Inspectable<T, TPolicy>& other);
+  ~Inspectable();
+
+  Inspectable<T, TPolicy>&  operator=(const Inspectable<T, TPolicy>& other);
+
+  Inspectable<T, TPolicy>&  AddTransformation(TTransform& outTransformation,
+                                              TTransformFunc func,
+                                              int priority = 0,
+                                              bool enabled = true,
+                                              bool andUpdate = false);
+  Inspectable<T, TPolicy>&  AddTransformation(        TTransform* transformation, bool andUpdate = false);
+  Inspectable<T, TPolicy>&  AddTransformationUnique(  TTransform* transformation, bool andUpdate = false);
+  void                      RemoveTransformation(     TTransform* transformation, bool andUpdate = false);
+  bool                      ContainsTransformation(   TTransform* transformation) const;
+  // whether an active absorbing transformation comes before this one, so that changing,
+  // adding or removing it can't change GetValue (see SetAbsorbing).
+  bool                      IsShadowed(const TTransform* transformation) const;
+
+  // Adds or removes a range of transformations as a single change, so observers hear
+  // about it once, after andUpdate has recomputed the value. Null entries are skipped.
+  // Like RemoveTransformation, each entry removes one occurrence, so a transformation
+  // listed twice has two of its occurrences removed. Removing a range walks the list
+  // once, however many transformations go. Neither allocates once a range of that size
+  // has been seen before.
+  Inspectable<T, TPolicy>&  AddTransformations(   TTransform* const* begin, TTransform* const* end, bool andUpdate = false);
+  void                      RemoveTransformations(TTransform* const* begin, TTransform* const* end, bool andUpdate = false);
+
+  // Puts 'to' in the place of 'from' without updating, so 'to' should do the same as
+  // 'from'. Observers still hear about it since the list changed. Returns false if 'from'
+  // isn't attached.
+  bool                      ReplaceTransformation(TTransform* from, TTransform* to);
+
+  Inspectable<T, TPolicy>&  AddOnIdentityChanged(       TValueChangedFunc* f);
+  Inspectable<T, TPolicy>&  AddOnIdentityChangedUnique( TValueChangedFunc* f);
+  void                      RemoveOnIdentityChanged(    TValueChangedFunc* f);
+  bool                      ContainsOnIdentityChanged(  TValueChangedFunc* f) const;
 
-  Inspectable<T>&   AddTransformation(TTransform& outTransformation,
-                                      TTransformFunc func,
-                                      int priority = 0,
-                                      bool enabled = true,
-                                      bool andUpdate = false);
-  Inspectable<T>&   AddTransformation(        TTransform* transformation, bool andUpdate = false);
-  Inspectable<T>&   AddTransformationUnique(  TTransform* transformation, bool andUpdate = false);
-  void              RemoveTransformation(     TTransform* transformation, bool andUpdate = false);
-  bool              ContainsTransformation(   TTransform* transformation) const;
+  Inspectable<T, TPolicy>&  AddOnValueChanged(        TValueChangedFunc* f);
+  Inspectable<T, TPolicy>&  AddOnValueChangedUnique(  TValueChangedFunc* f);
+  void                      RemoveOnValueChanged(     TValueChangedFunc* f);
+  bool                      ContainsOnValueChanged(   TValueChangedFunc* f) const;
 
-  Inspectable<T>&   AddOnIdentityChanged(       TValueChangedFunc* f);
-  Inspectable<T>&   AddOnIdentityChangedUnique( TValueChangedFunc* f);
-  void              RemoveOnIdentityChanged(    TValueChangedFunc* f);
-  bool              ContainsOnIdentityChanged(  TValueChangedFunc* f) const;
+  InspectableConnection     ConnectOnIdentityChanged( TValueChangedFunc func,
+                                                      xoins::ListenerThreading threading = xoins::MainThreadOnly);
+  InspectableConnection     ConnectOnValueChanged(    TValueChangedFunc func,
+                                                      xoins::ListenerThreading threading = xoins::MainThreadOnly);
+  bool                      Disconnect(               InspectableConnection connection);
+  bool                      IsConnected(              InspectableConnection connection) const;
 
-  Inspectable<T>&   AddOnValueChanged(        TValueChangedFunc* f);
-  Inspectable<T>&   AddOnValueChangedUnique(  TValueChangedFunc* f);
-  void              RemoveOnValueChanged(     TValueChangedFunc* f);
-  bool              ContainsOnValueChanged(   TValueChangedFunc* f) const;
+  // see "Parallel dispatch". Off by default.
+  void                      SetParallelDispatch(bool enabled);
+  bool                      IsParallelDispatch() const;
 
-  void              ForceUpdate();
+  // Inside an InspectableBatch this only marks the Inspectable dirty (see below).
+  void                      ForceUpdate();
 
-  void              SetIdentity(const T& value, bool andUpdate = false);
-  const T&          GetValue(bool andUpdate = false);
+  // Queues this Inspectable for the next xoins::UpdateDirtyInspectables. Marking it
+  // again before then does nothing, and any ForceUpdate clears the mark.
+  void                      MarkDirty();
+  bool                      IsDirty() const;
+
+  void                      SetIdentity(const T& value, bool andUpdate = false);
+  const T&                  GetIdentity() const;
+  const T&                  GetValue(bool andUpdate = false);
+  const T&                  GetCachedValue() const; // GetValue for const Inspectables, never updates
+
+  // The value under a set of contexts: only transformations whose context mask shares a
+  // bit with contextMask are run. Each mask asked for gets its own cached value, kept
+  // until a change could affect it: adding, removing, enabling or disabling a
+  // transformation, changing its context mask, or flipping the toggle or setting the
+  // definition it uses, only drops the masks sharing a bit with that transformation's.
+  // A new identity drops them all. ForceUpdate drops none. If a transformation's function
+  // reads something else that changed, call InvalidateContextValues for its contexts.
+  // Dropped values are recomputed when next asked for. Listeners and observers only hear
+  // about GetValue's value.
+  T                         GetContextValue(xoins::ContextMask contextMask);
+  // drops the cached context values of the masks sharing a bit with contextMask.
+  void                      InvalidateContextValues(xoins::ContextMask contextMask = xoins::AllContexts);
+
+  // Sets the identity and the cached value without updating or notifying anyone. This is
+  // for restoring saved state (see xoins::RestoreSnapshot), not for gameplay code.
+  void                      RestoreState(const T& identity, const T& value);
+  // RestoreState, then calls the value and identity listeners if either changed, for
+  // mirroring another Inspectable (see InspectableDeltaReader). Nothing is recomputed,
+  // so the transformations aren't run on a value that already went through them.
+  void                      ReplicateState(const T& identity, const T& value);
+  // Replaces the transformations without updating. They must already be in evaluation
+  // order (as returned by GetTransformations).
+  void                      RestoreTransformations(TTransform* const* begin, TTransform* const* end);
+
+  typedef typename TPolicy::template List<TTransform*> TTransformList;
+  const TTransformList&     GetTransformations() const; // in evaluation order
 
 private:
-  void              SortTransformations();
+  template<typename, typename> friend class InspectableScopedTransformation;
+
+  typedef xoins::internal::ListenerSlots<Inspectable<T, TPolicy>, T> TListenerSlots;
+  typedef InspectableObserver<T, TPolicy> TObserver;
+
+  struct Listeners {
+    TListenerSlots identityChanged;
+    TListenerSlots valueChanged;
+  };
+
+  enum Flags {
+    HasListeners      = 1 << 0, // this Inspectable has an entry in the listener table
+    ParallelDispatch  = 1 << 1, // see SetParallelDispatch
+    Dirty             = 1 << 2, // queued in xoins::internal::DirtyList
+    HasContextValues  = 1 << 3, // this Inspectable has an entry in the context value table
+    MayAbsorb         = 1 << 4, // an absorbing transformation was attached, so some may be shadowed
+    DirtyListed       = 1 << 5, // has the entry at m_DirtyIndex in DirtyList, even once updated
+  };
+
+  struct ContextValue {
+    xoins::ContextMask  mask;
+    bool                valid;
+    T                   value;
+  };
+  typedef std::vector<ContextValue> ContextValues;
 
-  T                               m_Identity;
-  T                               m_LastValue;
-  xoins_list<TTransform*>         m_Transformations;
-  xoins_list<TValueChangedFunc*>  m_IdentityChanged;
-  xoins_list<TValueChangedFunc*>  m_ValueChanged;
+  Listeners*        FindListeners() const;
+  Listeners&        GetListeners();
+  void              ReleaseListenersIfEmpty();
+  void              CopyListenersFrom(const Inspectable<T, TPolicy>& other);
+  void              NotifyBeforeChange();
+  void              NotifyChanged();
+  // ends a change that began with NotifyBeforeChange. With andUpdate the value is
+  // recomputed first (or marked dirty inside an InspectableBatch), so observers hear
+  // about the change and its new value together.
+  void              FinishChange(bool andUpdate);
+  // registers as an owner of a transformation, and with its definition and toggle if it
+  // has them, so this hears about changes to any of them.
+  void              Subscribe(TTransform* transformation);
+  void              Unsubscribe(TTransform* transformation);
+  void              UnsubscribeShared(TTransform* transformation); // its definition and toggle
+  void              UnsubscribeAll();
+  // points the list at 'to', which a transformation was just moved into, and hands it
+  // from's registration. Nothing else changed, so nobody is told.
+  void              MoveTransformation(TTransform* from, TTransform* to);
+  void              OnTransformationChanged(TTransform* transformation, xoins::ContextMask contexts);
+  void              OnTransformationDestroyed(TTransform* transformation);
+  void              OnSharedChanged(const void* shared);
+  static void       TransformationThunk(void* inspectable, void* transformation,
+                                        xoins::internal::TransformOwners::Event event, xoins::ContextMask contexts);
+  static void       SharedChangedThunk(void* inspectable, const void* shared);
+  static void       UpdateDirtyThunk(void* inspectable);
+  void              DropContextValues(); // for when the identity changes
+  // the same as the public one, except for the masks sharing a bit with 'shadowed', where
+  // an absorbing transformation runs first.
+  void              InvalidateContextValues(xoins::ContextMask contextMask, xoins::ContextMask shadowed);
+  // IsShadowed, also giving the contexts it's shadowed in.
+  bool              IsShadowed(const TTransform* transformation, xoins::ContextMask& outShadowed) const;
+  // drops the context values a change to 'transformation' can affect, and returns
+  // whether it can affect GetValue. 'transformation' has to be in the list.
+  bool              InvalidateAffected(const TTransform* transformation, xoins::ContextMask contexts);
+  // the same for every transformation 'affected' picks out, in one walk over the list.
+  // At least one has to be in the list.
+  template<typename TAffected>
+  bool              InvalidateAffected(TAffected affected);
+
+  T                 m_Identity;
+  T                 m_LastValue;
+  TTransformList    m_Transformations;
+  unsigned char     m_Flags;
+  uint32_t          m_DirtyIndex; // where this is in xoins::internal::DirtyList, with DirtyListed
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -196,27 +1364,43 @@ private:
 //
 // Optionally the inspectable can be told to update on attach, as well as on detatch.
 //
+// Scoped transformations can be moved (into a std::vector, say). Moving re-points the
+// Inspectable at the new transformation in place and moves its function, without
+// allocating, updating or telling observers, since only its address changed. An
+// InspectableRollback keeps the addresses of transformations though, so a frame recorded
+// before a move would re-attach the old one: keep a scoped transformation in one place
+// (Reserve a HandlePool up front) while rollback frames may hold it.
+//
 //////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
 class InspectableScopedTransformation {
   typedef std::function<void(T&)> TTransformFunc; // must reflect TTransformFunc in InspectableTransformation
 
 public:
-  InspectableScopedTransformation(Inspectable<T>* inspectable = nullptr,
+  InspectableScopedTransformation(Inspectable<T, TPolicy>* inspectable = nullptr,
                                   bool updateOnDestroy = false);
-  InspectableScopedTransformation(Inspectable<T>* inspectable,
+  InspectableScopedTransformation(Inspectable<T, TPolicy>* inspectable,
                                   TTransformFunc func,
                                   int priority = 0,
                                   bool enabled = true,
                                   bool andUpdate = false,
                                   bool updateOnDestroy = false);
+  InspectableScopedTransformation(InspectableScopedTransformation&& other) noexcept;
 
   ~InspectableScopedTransformation();
 
+  // removes this transformation (updating if SetUpdateOnDestroy asked for it) and takes
+  // over the other's.
+  InspectableScopedTransformation& operator=(InspectableScopedTransformation&& other);
+
   void Set(TTransformFunc func,
            int priority = 0,
            bool enabled = true,
            bool andUpdate = false);
+  void Set(const xoins::TransformOp<T>& op,
+           int priority = 0,
+           bool enabled = true,
+           bool andUpdate = false);
 
   void SetUpdateOnDestroy(bool updateOnDestroy);
 
@@ -230,519 +1414,6742 @@ public:
   void operator()(T& input); // Call the attached transformation
 
 private:
-  Inspectable<T>*               m_Inspectable;
-  InspectableTransformation<T>  m_Transformation;
-  bool                          m_UpdateOnDestroy;
+  Inspectable<T, TPolicy>*                      m_Inspectable;
+  typename Inspectable<T, TPolicy>::TTransform  m_Transformation;
+  bool                                          m_UpdateOnDestroy;
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// InspectableScopedValueChangedFunc
+// InspectableScopedConnection
 //////////////////////////////////////////////////////////////////////////////////////////
-// This class wraps an std::function matching the OnValueChanged method signature in
-// Inspectable. It will add a given std::function from the inspectable on
-// construction (or Set) and remove it on destruction.
+// Owns an InspectableConnection and disconnects it on destruction (or Reset). It can't
+// be copied since only one owner may disconnect, but it can be moved.
+//
+//   InspectableScopedConnection<float> watch(&m_PlayerSpeed,
+//     m_PlayerSpeed.ConnectOnValueChanged(OnSpeedChanged));
 //
 //////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
-class InspectableScopedValueChangedFunc
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableScopedConnection
 {
 public:
-  typedef std::function<void(Inspectable<T>*, const T& /*lastValue*/, const T& /*newValue*/)> TValueChangedFunc;
+  InspectableScopedConnection();
+  InspectableScopedConnection(Inspectable<T, TPolicy>* inspectable, InspectableConnection connection);
+  InspectableScopedConnection(InspectableScopedConnection&& other) noexcept;
+  ~InspectableScopedConnection();
 
-  InspectableScopedValueChangedFunc();
-  InspectableScopedValueChangedFunc(Inspectable<T>* inspectable, TValueChangedFunc func);
-  ~InspectableScopedValueChangedFunc();
+  // disconnects the current connection (if any) and takes over the other's.
+  InspectableScopedConnection& operator=(InspectableScopedConnection&& other);
 
-  void Set(Inspectable<T>* inspectable, TValueChangedFunc func);
-  void SetInspectable(Inspectable<T>* inspectable);
-  void SetFunc(TValueChangedFunc func);
+  // disconnects the current connection (if any) and takes ownership of a new one.
+  void Reset(Inspectable<T, TPolicy>* inspectable = nullptr,
+             InspectableConnection connection = InspectableConnection());
+  // gives up ownership without disconnecting.
+  InspectableConnection Release();
+
+  bool IsConnected() const;
+  Inspectable<T, TPolicy>* GetInspectable() const;
+  InspectableConnection GetConnection() const;
 
 private:
-  Inspectable<T>* m_Inspectable;
-  TValueChangedFunc m_OnValueChanged;
+  InspectableScopedConnection(const InspectableScopedConnection&);
+  InspectableScopedConnection& operator=(const InspectableScopedConnection&);
+
+  Inspectable<T, TPolicy>*  m_Inspectable;
+  InspectableConnection     m_Connection;
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// InspectableScopedIdentityChangedFunc
+// InspectableScopedValueChangedFunc
 //////////////////////////////////////////////////////////////////////////////////////////
-// This class wraps an std::function matching the OnValueChanged method signature in
-// Inspectable. It will add a given std::function from the inspectable on
-// construction (or Set) and remove it on destruction.
+// An InspectableScopedConnection for OnValueChanged which keeps a copy of its function,
+// so it can be reconnected to another inspectable (SetInspectable) or swapped for another
+// function (SetFunc).
 //
 //////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
-class InspectableScopedIdentityChangedFunc
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableScopedValueChangedFunc : public InspectableScopedConnection<T, TPolicy>
+{
+public:
+  typedef typename Inspectable<T, TPolicy>::TValueChangedFunc TValueChangedFunc;
+
+  InspectableScopedValueChangedFunc();
+  InspectableScopedValueChangedFunc(Inspectable<T, TPolicy>* inspectable, TValueChangedFunc func);
+  InspectableScopedValueChangedFunc(InspectableScopedValueChangedFunc&& other) noexcept;
+
+  InspectableScopedValueChangedFunc& operator=(InspectableScopedValueChangedFunc&& other);
+
+  void Set(Inspectable<T, TPolicy>* inspectable, TValueChangedFunc func);
+  void SetInspectable(Inspectable<T, TPolicy>* inspectable);
+  void SetFunc(TValueChangedFunc func);
+
+private:
+  TValueChangedFunc m_OnValueChanged;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableScopedIdentityChangedFunc
+//////////////////////////////////////////////////////////////////////////////////////////
+// An InspectableScopedConnection for OnIdentityChanged which keeps a copy of its function,
+// so it can be reconnected to another inspectable (SetInspectable) or swapped for another
+// function (SetFunc).
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableScopedIdentityChangedFunc : public InspectableScopedConnection<T, TPolicy>
 {
 public:
-  typedef std::function<void(Inspectable<T>*, const T& /*lastValue*/, const T& /*newValue*/)> TValueChangedFunc;
+  typedef typename Inspectable<T, TPolicy>::TValueChangedFunc TValueChangedFunc;
 
   InspectableScopedIdentityChangedFunc();
-  InspectableScopedIdentityChangedFunc(Inspectable<T>* inspectable, TValueChangedFunc func);
-  ~InspectableScopedIdentityChangedFunc();
+  InspectableScopedIdentityChangedFunc(Inspectable<T, TPolicy>* inspectable, TValueChangedFunc func);
+  InspectableScopedIdentityChangedFunc(InspectableScopedIdentityChangedFunc&& other) noexcept;
+
+  InspectableScopedIdentityChangedFunc& operator=(InspectableScopedIdentityChangedFunc&& other);
 
-  void Set(Inspectable<T>* inspectable, TValueChangedFunc func);
-  void SetInspectable(Inspectable<T>* inspectable);
+  void Set(Inspectable<T, TPolicy>* inspectable, TValueChangedFunc func);
+  void SetInspectable(Inspectable<T, TPolicy>* inspectable);
   void SetFunc(TValueChangedFunc func);
 
 private:
-  Inspectable<T>* m_Inspectable;
   TValueChangedFunc m_OnValueChanged;
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// INTERNAL
+// HandlePool
 //////////////////////////////////////////////////////////////////////////////////////////
-// Below are a series of internal implementation details. The only API to note here is
-// a typedef for basic types, specifying the template on each of the classes in this file.
+// Stores many scoped handles (InspectableScopedTransformation, InspectableScopedConnection
+// and the rest) in one contiguous array, and hands out small ids instead of pointers:
 //
-// They take the form of: InspectableF (float) InspectableB (bool) InspectableU (unsigned)
-// and so on.
+//   xoins::HandlePool<InspectableScopedTransformation<float> > buffs;
+//   xoins::HandlePoolId haste = buffs.Acquire(InspectableScopedTransformation<float>(&speed, ...));
+//   ...
+//   buffs.Release(haste); // removes the transformation. The slot is reused later.
+//
+// Released slots are reused before the array grows, and growing moves the handles (which
+// re-points what they registered), so once a pool has reached its peak size (or after
+// Reserve) acquiring and releasing don't allocate. An id stays invalid after it's
+// released, even once its slot is reused. Handles have to be movable and default
+// constructible, and a released slot holds a default constructed one.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  struct HandlePoolId {
+    uint32_t index;
+    uint32_t generation;
+  };
+
+  template<typename THandle>
+  class HandlePool {
+  public:
+    HandlePool();
+
+    HandlePoolId    Acquire(THandle&& handle);
+    bool            Release(HandlePoolId id); // false if the id was already released
+    THandle*        Get(HandlePoolId id); // null if the id was released
+    const THandle*  Get(HandlePoolId id) const;
+
+    size_t          GetCount() const; // live handles
+    void            Reserve(size_t capacity);
+    void            Clear(); // releases every handle
+
+  private:
+    struct Slot {
+      explicit Slot(THandle&& value);
+
+      THandle   handle;
+      uint32_t  generation;
+      uint32_t  nextFree;
+      bool      live;
+    };
+
+    static const uint32_t NoSlot = UINT32_MAX;
+
+    std::vector<Slot> m_Slots;
+    uint32_t          m_FreeHead;
+    size_t            m_Count;
+  };
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableObserver
+//////////////////////////////////////////////////////////////////////////////////////////
+// Watches every Inspectable<T, TPolicy> at once, for systems like rollback that would
+// otherwise have to connect a listener to each one. An observer registers itself on
+// construction and unregisters on destruction.
+//
+// OnBeforeChange is called right before an Inspectable's identity, cached value or
+// transformation list changes, and OnChanged right after. ForceUpdate only reports a
+// change when the value actually changed. Like the rest of Inspectable, observers are not
+// thread safe.
+//
+// Every observer hears about every Inspectable of its type through virtual calls, so
+// keep what they do per call small, and destroy observers nobody needs any more.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableObserver
+{
+public:
+  typedef Inspectable<T, TPolicy> TInspectable;
+
+  InspectableObserver();
+  virtual ~InspectableObserver();
+
+  virtual void OnBeforeChange(TInspectable* inspectable);
+  virtual void OnChanged(TInspectable* inspectable);
+  virtual void OnDestroyed(TInspectable* inspectable);
+
+private:
+  friend class Inspectable<T, TPolicy>;
+
+  InspectableObserver(const InspectableObserver&);
+  InspectableObserver& operator=(const InspectableObserver&);
+
+  InspectableObserver*        m_Prev;
+  InspectableObserver*        m_Next;
+  static InspectableObserver* s_Head;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableRollback
+//////////////////////////////////////////////////////////////////////////////////////////
+// Keeps the last few frames of every Inspectable<T, TPolicy> so a netcode resimulation
+// can rewind them. Instead of copying the world each frame it keeps an undo log: the
+// first time an Inspectable changes after a Capture, its identity, cached value and
+// transformation list are recorded. Capture and Rewind both cost O(changed), and once the
+// ring of frames has warmed up neither allocates.
+//
+//   InspectableRollback<float> rollback(8);
+//   ...simulate a frame...
+//   rollback.Capture();
+//   ...a late input arrives for 3 frames ago...
+//   rollback.Rewind(3); // back to how things were 3 Captures before the last one
+//
+// Rewind(0) drops whatever changed since the last Capture. Rewinding restores state
+// quietly (through RestoreState and RestoreTransformations), no listener is called. The
+// transformations themselves are not copied, so any that a stored frame may re-attach must
+// outlive it, and their enabled state and functions are not rolled back.
+//
+// As an InspectableObserver it's told about every change: each costs a record the first
+// time an Inspectable changes in a frame, and a hash lookup after that. An Inspectable's
+// records are chained together, so destroying one drops its records with a hash lookup
+// and a walk over its own records. The lookup table keeps an entry per Inspectable that
+// has changed and is still alive, so once those have all been seen nothing allocates.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableRollback : public InspectableObserver<T, TPolicy>
+{
+public:
+  typedef Inspectable<T, TPolicy> TInspectable;
+
+  explicit InspectableRollback(unsigned maxFrames = 8);
+
+  void      Capture();                // ends the current frame
+  bool      Rewind(unsigned frames);  // false (and nothing changes) if frames > GetFrameCount()
+  unsigned  GetFrameCount() const;    // how many Captures can be rewound past
+  void      Clear();                  // forgets every frame, keeping the current state
+
+  void      OnBeforeChange(TInspectable* inspectable) override;
+  void      OnDestroyed(TInspectable* inspectable) override;
+
+private:
+  // where a record is. It's gone once its frame's generation moved on.
+  struct Location {
+    uint32_t frame;
+    uint32_t index;
+    uint32_t generation;
+  };
+
+  struct Record {
+    TInspectable*                                     inspectable; // null once it's destroyed
+    T                                                 identity;
+    T                                                 value;
+    std::vector<typename TInspectable::TTransform*>   transformations;
+    Location                                          previous; // the same Inspectable's last record
+  };
+
+  struct Frame {
+    std::vector<Record> records; // records past 'count' are kept for their storage
+    size_t              count;
+    uint32_t            generation; // bumped whenever the frame is emptied
+  };
+
+  void      Undo(Frame& frame);
+  void      Reset(Frame& frame);
+  bool      IsRecorded(const Location& location) const;
+  unsigned  FrameIndex(unsigned framesAgo) const;
+
+  std::vector<Frame>                          m_Frames;    // maxFrames + 1 frames used as a ring
+  std::unordered_map<TInspectable*, Location> m_Latest;    // each Inspectable's newest record
+  unsigned                                    m_Open;      // the frame recording changes since the last Capture
+  unsigned                                    m_Count;     // captured frames behind m_Open
+  bool                                        m_Restoring;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Delta replication
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sends the cached values of Inspectables that changed to another machine. The work on
+// both ends scales with the number of changes, not with the number of Inspectables.
+//
+// An InspectableDeltaTracker is told which Inspectables to replicate and the handle that
+// names each one on the wire. It keeps them ordered by the tick they last changed in, so
+// finding everything that changed since a tick only visits those. Each receiver gets its
+// own InspectableDeltaWriter, and the receiving side applies its output with an
+// InspectableDeltaReader:
+//
+//   InspectableDeltaTracker<float> tracker;
+//   tracker.Track(&m_Health, 1);
+//   InspectableDeltaWriter<float> toClient(tracker);
+//   ...each tick...
+//   tracker.AdvanceTick();
+//   toClient.Write(packet);
+//
+//   // on the client
+//   InspectableDeltaReader<float> fromServer;
+//   fromServer.Apply(packet.data(), packet.size(), [&](uint32_t handle) { return FindStat(handle); });
+//
+// A delta is a varint count followed by a varint handle, a varint encoded identity and a
+// varint encoded cached value per change. Both are encoded relative to the last ones sent
+// for the same handle by a codec (TCodec):
+//   xoins::BitwiseDeltaCodec<T>     the XOR of the raw bits, lossless. T must be trivially
+//                                   copyable and at most 8 bytes.
+//   xoins::QuantizedDeltaCodec<T>   rounds to a multiple of a step and sends the zigzag
+//                                   encoded difference in steps.
+// A custom codec provides 'uint64_t Encode(const T& last, const T& value) const' and
+// 'T Decode(const T& last, uint64_t delta) const', where a delta of 0 means unchanged.
+//
+// Because values are relative, every delta a writer produces has to be applied, in order,
+// by its reader. After a lost connection Reset both and everything is sent again.
+// Received values are applied with Inspectable::ReplicateState, so the receiving side
+// ends up with the sender's identity and value without running its own transformations
+// on a value that already went through them, and its listeners are called as usual.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  template<typename T>
+  struct BitwiseDeltaCodec {
+    static_assert(std::is_trivially_copyable<T>::value && sizeof(T) <= sizeof(uint64_t),
+                  "BitwiseDeltaCodec needs a trivially copyable type of at most 8 bytes");
+    uint64_t  Encode(const T& last, const T& value) const;
+    T         Decode(const T& last, uint64_t delta) const;
+  };
+
+  template<typename T>
+  struct QuantizedDeltaCodec {
+    explicit QuantizedDeltaCodec(T step = T(1));
+    uint64_t  Encode(const T& last, const T& value) const;
+    T         Decode(const T& last, uint64_t delta) const;
+    T         step;
+  };
+
+  namespace internal {
+    void      WriteVarint(uint64_t value, std::vector<unsigned char>& out);
+    bool      ReadVarint(const unsigned char*& read, const unsigned char* end, uint64_t& outValue);
+    uint64_t  ZigZag(int64_t value);
+    int64_t   UnZigZag(uint64_t value);
+  }
+}
+
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableDeltaTracker : public InspectableObserver<T, TPolicy>
+{
+public:
+  typedef Inspectable<T, TPolicy> TInspectable;
+
+  InspectableDeltaTracker();
+
+  // starts replicating an Inspectable. It counts as changed in the current tick.
+  void      Track(TInspectable* inspectable, uint32_t handle);
+  void      Untrack(TInspectable* inspectable);
+
+  uint64_t  AdvanceTick(); // returns the new tick
+  uint64_t  GetTick() const;
+
+  // Enabling or disabling a transformation doesn't change its Inspectable until it's
+  // updated. Call this to have the change replicated anyway.
+  void      MarkChanged(TInspectable* inspectable);
+
+  // calls f(handle, inspectable) for every tracked Inspectable that changed in 'tick' or
+  // later, most recent first.
+  template<typename F>
+  void      ForEachChangedSince(uint64_t tick, F f) const;
+
+  void      OnChanged(TInspectable* inspectable) override;
+  void      OnDestroyed(TInspectable* inspectable) override;
+
+private:
+  struct Entry {
+    const TInspectable* inspectable;
+    uint32_t            handle;
+    uint64_t            tick;  // the last tick this changed in
+    Entry*              prev;  // towards older changes
+    Entry*              next;  // towards newer changes
+  };
+
+  void      Unlink(Entry* entry);
+  void      LinkNewest(Entry* entry);
+
+  std::unordered_map<const TInspectable*, Entry>  m_Entries;
+  Entry*                                          m_Oldest;
+  Entry*                                          m_Newest;
+  uint64_t                                        m_Tick;
+};
+
+template<typename T, typename TPolicy = xoins::DefaultListPolicy, typename TCodec = xoins::BitwiseDeltaCodec<T> >
+class InspectableDeltaWriter
+{
+public:
+  explicit InspectableDeltaWriter(const InspectableDeltaTracker<T, TPolicy>& tracker, TCodec codec = TCodec());
+
+  // appends a delta of everything that changed since the last Write. Returns how many
+  // values it holds (a delta with no values is still written).
+  size_t    Write(std::vector<unsigned char>& out);
+  void      Reset(); // forget what was sent, the next Write sends every tracked value
+
+private:
+  struct State {
+    T identity;
+    T value;
+  };
+
+  struct Change {
+    uint32_t  handle;
+    uint64_t  identity;
+    uint64_t  value;
+  };
+
+  const InspectableDeltaTracker<T, TPolicy>&  m_Tracker;
+  TCodec                                      m_Codec;
+  std::unordered_map<uint32_t, State>         m_Sent;     // the last state sent per handle
+  uint64_t                                    m_FromTick; // changes in this tick or later are unsent
+  std::vector<Change>                         m_Scratch;
+};
+
+template<typename T, typename TPolicy = xoins::DefaultListPolicy, typename TCodec = xoins::BitwiseDeltaCodec<T> >
+class InspectableDeltaReader
+{
+public:
+  explicit InspectableDeltaReader(TCodec codec = TCodec());
+
+  // applies one delta. resolve(handle) returns the Inspectable<T, TPolicy>* to update (or
+  // null to skip it). Returns false if the bytes don't hold a whole delta, in which case
+  // some values may already have been applied.
+  template<typename TResolve>
+  bool      Apply(const void* bytes, size_t size, TResolve resolve);
+  void      Reset();
+
+private:
+  struct State {
+    T identity;
+    T value;
+  };
+
+  TCodec                              m_Codec;
+  std::unordered_map<uint32_t, State> m_Received; // the last state received per handle
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Transformation set replication
+//////////////////////////////////////////////////////////////////////////////////////////
+// When the receiving side knows every transformation definition it's often cheaper to
+// send which transformations are attached than the values they produce. The transform
+// set of an Inspectable is the definition ids of its enabled transformations (ones with a
+// definition id, see InspectableTransformation::SetDefinitionId) in evaluation order.
+//
+// InspectableTransformSetWriter uses an InspectableDeltaTracker to find the Inspectables
+// that changed and sends the sets that differ from what it sent last. Each set goes out
+// either as a full id list or as an edit of the previous one (a bitset of the ids kept
+// plus the ids inserted), whichever is smaller. InspectableTransformSetReader rebuilds the
+// chain in the same order and updates the Inspectable, so the receiver evaluates it
+// exactly as the sender did:
+//
+//   InspectableTransformSetReader<float> fromServer;
+//   fromServer.Apply(packet.data(), packet.size(),
+//     [&](uint32_t handle) { return FindStat(handle); },
+//     [&](uint32_t handle, uint32_t definitionId) { return FindModifier(handle, definitionId); });
+//
+// The reader replaces the receiving Inspectable's transformations, so they belong to
+// replication. Like delta values, every set a writer produces has to be applied in order.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableTransformSetWriter
+{
+public:
+  explicit InspectableTransformSetWriter(const InspectableDeltaTracker<T, TPolicy>& tracker);
+
+  // appends every transform set that changed since the last Write. Returns how many sets
+  // it holds.
+  size_t    Write(std::vector<unsigned char>& out);
+  void      Reset(); // forget what was sent, the next Write sends every tracked set
+
+private:
+  typedef std::unordered_map<uint32_t, std::vector<uint32_t> > TSets;
+
+  const InspectableDeltaTracker<T, TPolicy>&  m_Tracker;
+  TSets                                       m_Sent;     // the last set sent per handle
+  uint64_t                                    m_FromTick;
+  std::vector<uint32_t>                       m_Current;
+  std::vector<unsigned char>                  m_Body;
+  std::vector<unsigned char>                  m_Full;
+  std::vector<unsigned char>                  m_Edit;
+};
+
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableTransformSetReader
+{
+public:
+  // applies the sets written by one Write. resolve(handle) returns the
+  // Inspectable<T, TPolicy>* to rebuild (or null to skip it), and
+  // resolveTransform(handle, definitionId) the Inspectable<T, TPolicy>::TTransform*
+  // for a definition (or null to leave it out). Returns false if the bytes are malformed.
+  template<typename TResolve, typename TResolveTransform>
+  bool      Apply(const void* bytes, size_t size, TResolve resolve, TResolveTransform resolveTransform);
+  void      Reset();
+
+private:
+  typedef std::unordered_map<uint32_t, std::vector<uint32_t> > TSets;
+
+  TSets                                                       m_Received; // the last set received per handle
+  std::vector<uint32_t>                                       m_Scratch;
+  std::vector<typename Inspectable<T, TPolicy>::TTransform*>  m_Chain;
+};
+
+namespace xoins {
+  namespace internal {
+    enum TransformSetEncoding {
+      TransformSetFull = 0,
+      TransformSetEdit = 1,
+    };
+
+    template<typename T, typename TPolicy>
+    void CollectTransformSet(const Inspectable<T, TPolicy>& inspectable, std::vector<uint32_t>& out);
+    void WriteTransformSetEdit(const std::vector<uint32_t>& last, const std::vector<uint32_t>& current, std::vector<unsigned char>& out);
+    bool ReadTransformSetEdit(const unsigned char*& read, const unsigned char* end, const std::vector<uint32_t>& last, std::vector<uint32_t>& out);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Fixed point
+//////////////////////////////////////////////////////////////////////////////////////////
+// Floating point transformation chains can round differently between compilers, flags
+// and CPUs, which is fatal to a lockstep simulation. xoins::Fixed is a fixed point number
+// that only uses integer math, so the same inputs give the same bits everywhere:
+//
+//   xoins::Fixed16_16   Q16.16 in an int32_t
+//   xoins::Fixed32_32   Q32.32 in an int64_t
+//
+// It works with Inspectable like any other value type, and the Make*Transform helpers
+// build the common transformations for it (or for any other T):
+//
+//   Inspectable<xoins::Fixed16_16> speed(xoins::Fixed16_16::FromInt(5));
+//   InspectableTransformation<xoins::Fixed16_16> mud(xoins::MakeAddTransform(xoins::Fixed16_16::FromInt(-1)));
+//
+// Arithmetic wraps on overflow. Multiplication rounds towards negative infinity. There's
+// no division, multiply by a reciprocal instead. FromDouble is exact for constants with
+// few enough fraction bits and otherwise rounds the same way on every IEEE 754 machine,
+// but values built at runtime should come from FromInt or FromRaw.
+//
+// The Batch* functions apply one operation to a whole array of values in a loop simple
+// enough for the compiler to vectorize.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  template<typename TRaw, unsigned FractionBits>
+  class Fixed {
+    static_assert(std::is_integral<TRaw>::value && std::is_signed<TRaw>::value, "Fixed needs a signed integer");
+    static_assert(FractionBits > 0 && FractionBits < sizeof(TRaw) * CHAR_BIT, "Fixed needs some integer and fraction bits");
+  public:
+    typedef TRaw TRawType;
+    static const unsigned Fraction = FractionBits;
+
+    Fixed(); // zero
+
+    static Fixed  FromRaw(TRaw raw);
+    static Fixed  FromInt(TRaw value);
+    static Fixed  FromDouble(double value);
+
+    TRaw          GetRaw() const;
+    TRaw          ToInt() const;    // rounds towards negative infinity
+    double        ToDouble() const; // for display, not for simulation
+
+    Fixed         operator-() const;
+    Fixed         operator+(Fixed other) const;
+    Fixed         operator-(Fixed other) const;
+    Fixed         operator*(Fixed other) const;
+    Fixed&        operator+=(Fixed other);
+    Fixed&        operator-=(Fixed other);
+    Fixed&        operator*=(Fixed other);
+
+    bool          operator==(Fixed other) const;
+    bool          operator!=(Fixed other) const;
+    bool          operator<(Fixed other) const;
+    bool          operator<=(Fixed other) const;
+    bool          operator>(Fixed other) const;
+    bool          operator>=(Fixed other) const;
+
+  private:
+    TRaw          m_Raw;
+  };
+
+  typedef Fixed<int32_t, 16> Fixed16_16;
+  typedef Fixed<int64_t, 32> Fixed32_32;
+
+  template<typename T> std::function<void(T&)> MakeAddTransform(T amount);
+  template<typename T> std::function<void(T&)> MakeMulTransform(T factor);
+  template<typename T> std::function<void(T&)> MakeClampTransform(T minimum, T maximum);
+
+  template<typename TRaw, unsigned F> void BatchAdd(Fixed<TRaw, F>* values, size_t count, Fixed<TRaw, F> amount);
+  template<typename TRaw, unsigned F> void BatchMul(Fixed<TRaw, F>* values, size_t count, Fixed<TRaw, F> factor);
+  template<typename TRaw, unsigned F> void BatchClamp(Fixed<TRaw, F>* values, size_t count, Fixed<TRaw, F> minimum, Fixed<TRaw, F> maximum);
+
+  namespace internal {
+    // (a * b) >> shift with a wide enough intermediate, rounding towards negative infinity.
+    int32_t FixedMul(int32_t a, int32_t b, unsigned shift);
+    int64_t FixedMul(int64_t a, int64_t b, unsigned shift);
+
+    // wrapping add and subtract without signed overflow.
+    template<typename TRaw> TRaw FixedAdd(TRaw a, TRaw b);
+    template<typename TRaw> TRaw FixedSub(TRaw a, TRaw b);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Modifier programs
+//////////////////////////////////////////////////////////////////////////////////////////
+// Compiles a small expression language into transformations, so modifiers can be written
+// in data instead of as lambdas:
+//
+//   xoins::ModifierProgram<float> haste;
+//   if(!haste.Compile("(base + 5) * 1.2 clamp 0..100", &error))
+//     ReportError(error);
+//   InspectableTransformation<float> hasteModifier(haste.MakeTransform(), 10);
+//
+// 'base' is the value coming into the transformation. Expressions can use numbers,
+// parentheses, unary -, + - * /, min(a, b), max(a, b) and 'x clamp low..high', which
+// binds looser than everything else. Dividing by zero gives zero. Parentheses, min, max
+// and unary - can nest MaxNesting deep, and an expression can be at most MaxDepth
+// operations deep, so compiling untrusted text can't exhaust the stack.
+//
+// Compiling folds everything that doesn't depend on 'base' into constants and fuses a
+// constant with the operation using it, and runs of constant adds or multiplies into one.
+// The result is bytecode for a small stack machine. A program that is a chain of
+// constant operations on 'base' (like the example) runs without a stack, and a program
+// that's a single add, multiply or clamp becomes the same transformation
+// xoins::Make*Transform would make. Folding uses T's own arithmetic so it's as
+// deterministic as T is, but it may regroup constants.
+//
+// Numbers become T through xoins::ModifierTraits<T>, which also says how to divide.
+// Specialize it for your own value types.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  template<typename T>
+  struct ModifierTraits {
+    static T FromNumber(double number);
+    static T Divide(const T& a, const T& b);
+  };
+
+  template<typename TRaw, unsigned F>
+  struct ModifierTraits<Fixed<TRaw, F> > {
+    static Fixed<TRaw, F> FromNumber(double number);
+    static Fixed<TRaw, F> Divide(const Fixed<TRaw, F>& a, const Fixed<TRaw, F>& b);
+  };
+
+  enum ModifierOp {
+    ModifierPushBase,
+    ModifierPushConstant,
+    ModifierAdd,
+    ModifierSubtract,
+    ModifierMultiply,
+    ModifierDivide,
+    ModifierNegate,
+    ModifierMin,
+    ModifierMax,
+    ModifierClamp,
+    // the top of the stack combined with constants.
+    ModifierAddConstant,
+    ModifierSubtractFromConstant, // constant - top
+    ModifierMultiplyConstant,
+    ModifierDivideConstant,
+    ModifierDivideIntoConstant,   // constant / top
+    ModifierMinConstant,
+    ModifierMaxConstant,
+    ModifierClampConstant,
+  };
+
+  template<typename T>
+  class ModifierProgram {
+  public:
+    struct Instruction {
+      ModifierOp  op;
+      T           constant;
+      T           constant2; // the upper bound of ModifierClampConstant
+    };
+
+    static const unsigned MaxStack = 16;
+    static const unsigned MaxNesting = 64;
+    static const unsigned MaxDepth = 1024;
+
+    ModifierProgram(); // returns base unchanged
+
+    // replaces the program. On failure the program is left unchanged and outError (if
+    // given) says what went wrong and where.
+    bool                      Compile(const char* text, std::string* outError = nullptr);
+
+    T                         Evaluate(const T& base) const;
+    bool                      IsLinear() const; // runs without a stack
+    const std::vector<Instruction>& GetInstructions() const;
+
+    // a transformation function running this program. It holds its own copy, so it's
+    // unaffected by compiling something else into this program later.
+    std::function<void(T&)>   MakeTransform() const;
+
+  private:
+    template<typename> friend class ModifierTableView;
+
+    static T                  Run(const Instruction* instructions, size_t count, bool linear, const T& base);
+    static void               Apply(const Instruction& instruction, T& top); // unary and constant ops
+    static bool               IsLinear(const Instruction* instructions, size_t count);
+    // the simple transformations a program can become without holding on to its
+    // instructions, or false if it's not one of them.
+    static bool               MakeSimpleTransform(const Instruction* instructions, size_t count, bool linear,
+                                                  std::function<void(T&)>& out);
+
+    std::vector<Instruction>  m_Instructions;
+    bool                      m_Linear;
+  };
+
+  namespace internal {
+    int32_t FixedDiv(int32_t a, int32_t b, unsigned shift);
+    int64_t FixedDiv(int64_t a, int64_t b, unsigned shift);
+
+    template<typename T>
+    class ModifierCompiler {
+    public:
+      ModifierCompiler(const char* text);
+      bool Compile(std::vector<typename ModifierProgram<T>::Instruction>& out, std::string& error);
+
+    private:
+      enum NodeKind { NodeBase, NodeConstant, NodeUnary, NodeBinary, NodeClamp };
+
+      struct Node {
+        NodeKind    kind;
+        ModifierOp  op;       // for unary and binary nodes
+        T           value;    // for constants
+        int         children[3];
+        unsigned    depth;    // how deep Emit recurses for this node
+      };
+
+      int   ParseClamp();
+      int   ParseAdditive();
+      int   ParseTerm();
+      int   ParseUnary();
+      int   ParsePrimary();
+      bool  ParseNumber(double& outNumber);
+      bool  Accept(const char* token);
+      bool  AcceptWord(const char* word);
+      void  SkipSpace();
+      int   Fail(const char* message);
+
+      int   AddConstant(const T& value);
+      int   AddNode(NodeKind kind, ModifierOp op, int a, int b = -1, int c = -1);
+      bool  IsConstant(int node) const;
+      T     Fold(ModifierOp op, const T& a, const T& b) const;
+      void  Emit(int node);
+      void  EmitOp(ModifierOp op, int stackChange, const T& constant = T(), const T& constant2 = T());
+
+      const char*                                         m_Text;
+      const char*                                         m_Read;
+      std::vector<Node>                                   m_Nodes;
+      std::vector<typename ModifierProgram<T>::Instruction>* m_Out;
+      std::string                                         m_Error;
+      unsigned                                            m_Nesting;  // how deep ParseUnary recursed
+      unsigned                                            m_Depth;
+      unsigned                                            m_MaxDepth;
+    };
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Modifier tables
+//////////////////////////////////////////////////////////////////////////////////////////
+// Many modifier programs compiled ahead of time into one flat binary table, so a server
+// can start without parsing anything. xoins::CompileModifierTable runs offline (in a
+// build step or tool) and ModifierTableView reads the result in place, typically from a
+// memory mapped file:
+//
+//   // offline
+//   xoins::ModifierTableSource sources[] = { { HasteId, 10, "base * 1.2" }, ... };
+//   std::vector<unsigned char> bytes;
+//   if(!xoins::CompileModifierTable<float>(sources, sourceCount, bytes, &error))
+//     ReportError(error);
+//
+//   // at startup
+//   xoins::ModifierTableView<float> table(mapped, mappedSize);
+//   InspectableTransformation<float> haste;
+//   table.Bind(HasteId, haste);
+//
+// A table is a header, the entries sorted by id and every program's instructions. It
+// only holds offsets, so it can be mapped at any address. Bind gives a transformation the
+// entry's priority, its id as the definition id, and a function pointing straight at the
+// entry's instructions. That function holds no more than a pointer and a count, which
+// fits in std::function's inline storage on common implementations, so binding doesn't
+// allocate. The bytes have to outlive every transformation bound from them.
+//
+// Opening a view checks every entry once (op codes, stack use, bounds), so a corrupt
+// table is rejected instead of misbehaving later. Like snapshots, tables use the byte
+// order and layout of the machine that wrote them, T must be trivially copyable and the
+// bytes must be 8 byte aligned.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  struct ModifierTableSource {
+    uint32_t    id;
+    int32_t     priority;
+    const char* text; // a ModifierProgram expression
+  };
+
+  struct ModifierTableEntry {
+    uint32_t  id;
+    int32_t   priority;
+    uint32_t  firstInstruction;
+    uint16_t  instructionCount;
+    uint8_t   linear;
+    uint8_t   reserved;
+  };
+
+  // Appends a table holding every source to 'out'. Fails (leaving 'out' unchanged) if a
+  // source doesn't compile, an id is used twice or a program is too long, and outError
+  // (if given) says which one.
+  template<typename T>
+  bool CompileModifierTable(const ModifierTableSource* sources, size_t count, std::vector<unsigned char>& out,
+                            std::string* outError = nullptr);
+
+  template<typename T>
+  class ModifierTableView {
+    static_assert(std::is_trivially_copyable<T>::value, "modifier tables can only store trivially copyable values");
+  public:
+    typedef typename ModifierProgram<T>::Instruction Instruction;
+
+    ModifierTableView();
+    // bytes must outlive the view. The view is invalid if they don't hold a table for T.
+    ModifierTableView(const void* bytes, size_t size);
+
+    bool                      IsValid() const;
+    uint32_t                  GetCount() const;
+    const ModifierTableEntry* GetEntries() const; // GetCount() entries, sorted by id
+    const ModifierTableEntry* Find(uint32_t id) const; // null if there's no such entry
+
+    T                         Evaluate(const ModifierTableEntry& entry, const T& base) const;
+    std::function<void(T&)>   MakeTransform(const ModifierTableEntry& entry) const;
+
+    // sets the transformation's function, priority and definition id from the entry with
+    // the given id, keeping whether it's enabled. Returns false if there's no such entry.
+    // Like InspectableTransformation::Set, don't call it while the transformation is
+    // attached.
+    template<typename THook>
+    bool                      Bind(uint32_t id, InspectableTransformation<T, THook>& transformation) const;
+
+  private:
+    uint32_t                  m_Count;
+    const ModifierTableEntry* m_Entries;
+    const Instruction*        m_Instructions;
+  };
+
+  namespace internal {
+    struct ModifierTableHeader {
+      uint32_t  magic;
+      uint16_t  version;
+      uint16_t  instructionSize;
+      uint32_t  count;
+      uint32_t  instructionCount;
+    };
+
+    const uint32_t ModifierTableMagic = 0x4d494f58; // "XOIM" when written little endian
+    const uint16_t ModifierTableVersion = 1;
+
+    // whether instructions form a program that runs within ModifierProgram's stack and
+    // leaves exactly one value.
+    template<typename T>
+    bool ValidateModifierProgram(const typename ModifierProgram<T>::Instruction* instructions, size_t count);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableWorldHash
+//////////////////////////////////////////////////////////////////////////////////////////
+// An order independent hash of the cached values of many Inspectables, for catching
+// desyncs in lockstep games. Every tracked Inspectable contributes a hash of its key and
+// the bits of its value, and the world hash is the sum of those (modulo 2^64). When a
+// value changes only its contribution is replaced, so keeping the hash costs O(1) per
+// change and reading it costs nothing.
+//
+// Keys have to match across machines (an entity id and a stat index, not an address).
+// Tracked Inspectables can also be put in groups, each with its own hash. When two
+// machines disagree, compare group hashes to narrow down where.
+//
+//   InspectableWorldHash<float> hash;
+//   hash.Track(&unit.m_Health, MakeKey(unit.m_Id, StatHealth), GroupUnits);
+//   ...each tick...
+//   SendChecksum(hash.GetHash());
+//
+// Values are hashed bit for bit, so T must be trivially copyable and 0.0f and -0.0f are
+// different values.
 //
 //////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableWorldHash : public InspectableObserver<T, TPolicy>
+{
+  static_assert(std::is_trivially_copyable<T>::value, "world hashes only hash trivially copyable values");
+public:
+  typedef Inspectable<T, TPolicy> TInspectable;
+
+  InspectableWorldHash();
+
+  void      Track(TInspectable* inspectable, uint64_t key, unsigned group = 0);
+  void      Untrack(TInspectable* inspectable);
+
+  uint64_t  GetHash() const;
+  uint64_t  GetGroupHash(unsigned group) const; // 0 for groups nothing was tracked in
+  unsigned  GetGroupCount() const;              // one more than the highest group used
+
+  void      OnChanged(TInspectable* inspectable) override;
+  void      OnDestroyed(TInspectable* inspectable) override;
+
+private:
+  struct Entry {
+    uint64_t  key;
+    uint64_t  contribution; // what this Inspectable currently adds to the hash
+    unsigned  group;
+  };
+
+  void      Add(uint64_t contribution, unsigned group);
+  void      Subtract(uint64_t contribution, unsigned group);
+
+  std::unordered_map<const TInspectable*, Entry>  m_Entries;
+  std::vector<uint64_t>                           m_Groups;
+  uint64_t                                        m_Hash;
+};
+
+namespace xoins {
+  namespace internal {
+    uint64_t Mix64(uint64_t value);
+
+    template<typename T>
+    uint64_t HashValueBits(uint64_t key, const T& value);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableFrameArena
+//////////////////////////////////////////////////////////////////////////////////////////
+// Transient transformations that only last until the end of the frame (hit reactions,
+// per frame aura contributions), without an InspectableScopedTransformation for each.
+// Add takes a transformation from the arena and attaches it, and EndFrame detaches every
+// transformation added since the last EndFrame and hands them all back to the arena at
+// once. Each affected Inspectable loses its transient transformations in a single
+// RemoveTransformations and is marked dirty (see Inspectable::MarkDirty), so only those
+// are recomputed by the next xoins::UpdateDirtyInspectables.
+//
+//   InspectableFrameArena<float> transient;
+//   transient.Add(unit.m_Speed, xoins::MulOp(0.5f), 100); // slowed for this frame
+//   ...
+//   transient.EndFrame();
+//   xoins::UpdateDirtyInspectables();
+//
+// The arena's transformations are kept in fixed size chunks and reused every frame, so
+// after the first few frames adding one doesn't allocate unless it has a function that
+// does. A function and what it captures are only destroyed when its slot is reused or
+// the arena is destroyed.
+//
+// An added transformation is only valid until EndFrame. Don't copy an Inspectable that
+// holds one before then, since the copy won't lose it. An Inspectable destroyed during
+// the frame is simply forgotten: it unregistered from its transformations, which is how
+// EndFrame tells, so the arena doesn't watch every Inspectable as an InspectableObserver.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableFrameArena
+{
+public:
+  typedef Inspectable<T, TPolicy> TInspectable;
+  typedef typename TInspectable::TTransform TTransform;
+  typedef typename TTransform::TTransformFunc TTransformFunc;
+
+  InspectableFrameArena();
+  ~InspectableFrameArena(); // ends the frame
+
+  // Attaches a transformation until EndFrame. Unless andUpdate is set the Inspectable is
+  // marked dirty instead of updated.
+  TTransform* Add(TInspectable& inspectable, TTransformFunc func, int priority = 0, bool andUpdate = false);
+  TTransform* Add(TInspectable& inspectable, InspectableTransformDefinition<T>& definition, int priority = 0, bool andUpdate = false);
+  TTransform* Add(TInspectable& inspectable, const xoins::TransformOp<T>& op, int priority = 0, bool andUpdate = false);
+
+  void        EndFrame();
+  size_t      GetCount() const; // transformations added since the last EndFrame
+
+private:
+  static const size_t ChunkSize = 64;
+
+  struct Record {
+    TInspectable* inspectable; // may be destroyed, see EndFrame
+    TTransform*   transformation;
+  };
+
+  InspectableFrameArena(const InspectableFrameArena&);
+  InspectableFrameArena& operator=(const InspectableFrameArena&);
+
+  TTransform* Allocate();
+  TTransform* Attach(TInspectable& inspectable, TTransform* transformation, bool andUpdate);
+  static bool RecordPredicate(const Record& a, const Record& b);
+
+  std::vector<std::unique_ptr<TTransform[]> > m_Chunks;
+  std::vector<Record>                         m_Records; // one per transformation handed out
+  std::vector<TTransform*>                    m_Removing;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableSourceIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+// Transformations tagged with the id of whatever they come from (an aura, a piece of
+// gear, an effect), with a reverse index from each source to where its transformations
+// are attached. When the source goes away RemoveAllFromSource detaches all of them,
+// instead of destroying an InspectableScopedTransformation per Inspectable.
+//
+//   InspectableSourceIndex<float> sources;
+//   for(Unit& unit : unitsInRange)
+//     sources.Add(boss.m_Id, unit.m_Armor, xoins::AddOp(10.f));
+//   xoins::UpdateDirtyInspectables();
+//   ...when the boss dies...
+//   sources.RemoveAllFromSource(boss.m_Id);
+//
+// The index owns its transformations (they're valid until they're removed) and keeps
+// them in fixed size chunks, reusing the slots of removed ones. Adding marks the
+// Inspectable dirty unless andUpdate is set. Removing groups a source's transformations
+// by Inspectable and detaches each group with one RemoveTransformations, which walks
+// that Inspectable's list once and recomputes it once, before its observers hear about
+// the change. Inside an InspectableBatch the recompute waits for the batch as usual.
+// Listeners run by those recomputes may add and remove through the index.
+//
+// Don't copy an Inspectable that holds one of the index's transformations, since the
+// copy won't lose it. An Inspectable destroyed while it holds some lets go of them
+// itself, so the index isn't an InspectableObserver: their slots are freed the next time
+// the index reaches them (removing their source, or adding to an Inspectable built at
+// the same address), and until then they still count in GetCount and ContainsSource.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableSourceIndex
+{
+public:
+  typedef Inspectable<T, TPolicy> TInspectable;
+  typedef typename TInspectable::TTransform TTransform;
+  typedef typename TTransform::TTransformFunc TTransformFunc;
+
+  InspectableSourceIndex();
+  ~InspectableSourceIndex(); // removes everything
+
+  // Attaches a transformation on behalf of 'sourceId'. Unless andUpdate is set the
+  // Inspectable is marked dirty instead of updated.
+  TTransform* Add(uint64_t sourceId, TInspectable& inspectable, TTransformFunc func, int priority = 0, bool andUpdate = false);
+  TTransform* Add(uint64_t sourceId, TInspectable& inspectable, InspectableTransformDefinition<T>& definition, int priority = 0, bool andUpdate = false);
+  TTransform* Add(uint64_t sourceId, TInspectable& inspectable, const xoins::TransformOp<T>& op, int priority = 0, bool andUpdate = false);
+
+  // Each returns how many transformations were detached, which leaves out those of
+  // destroyed Inspectables.
+  size_t      RemoveAllFromSource(uint64_t sourceId);
+  size_t      Remove(uint64_t sourceId, TInspectable& inspectable); // e.g. a unit leaving an aura
+  void        Clear();
+
+  bool        ContainsSource(uint64_t sourceId) const;
+  size_t      GetCount() const; // transformations currently attached
+
+private:
+  static const size_t   ChunkSize = 64;
+  static const uint32_t None = UINT32_MAX;
+
+  struct Link {
+    uint32_t prev;
+    uint32_t next;
+  };
+
+  // what's known about the transformation with the same index.
+  struct Slot {
+    TInspectable* inspectable;   // null while the slot is free
+    uint64_t      source;
+    Link          bySource;      // bySource.next links free slots
+    Link          byInspectable;
+  };
+
+  struct Gathered {
+    TInspectable* inspectable;
+    uint32_t      index;
+  };
+
+  InspectableSourceIndex(const InspectableSourceIndex&);
+  InspectableSourceIndex& operator=(const InspectableSourceIndex&);
+
+  TTransform& GetTransform(uint32_t index);
+  uint32_t    Allocate();
+  TTransform* Attach(uint64_t sourceId, TInspectable& inspectable, uint32_t index, bool andUpdate);
+  void        UnlinkFromSource(uint32_t index);
+  void        UnlinkFromInspectable(uint32_t index);
+  void        Free(uint32_t index);
+  // frees the slots 'inspectable' no longer holds, since the Inspectable that was there
+  // was destroyed.
+  void        ForgetDestroyed(TInspectable* inspectable);
+  // unlinks the slots of m_Gathered, detaches their transformations with one
+  // RemoveTransformations per Inspectable, and frees them. Returns how many were detached.
+  size_t      RemoveGathered();
+  static bool GatheredPredicate(const Gathered& a, const Gathered& b);
+
+  std::vector<std::unique_ptr<TTransform[]> >   m_Chunks;
+  std::vector<Slot>                             m_Slots;
+  uint32_t                                      m_FreeHead;
+  size_t                                        m_Count;
+  std::unordered_map<uint64_t, uint32_t>        m_SourceHeads;      // the first slot of each source
+  std::unordered_map<TInspectable*, uint32_t>   m_InspectableHeads; // the first slot of each Inspectable
+  std::vector<Gathered>                         m_Gathered;         // kept for their storage
+  std::vector<TTransform*>                      m_Detaching;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Journal
+//////////////////////////////////////////////////////////////////////////////////////////
+// A low overhead record of every change to a set of Inspectables, for working out what
+// happened after the fact. Each identity change, value change and transformation added,
+// removed, enabled or disabled becomes a fixed size JournalRecord. Records are collected
+// in a per thread buffer and copied into a memory mapped ring file when it fills up, so
+// recording never makes a system call. Once the ring is full the oldest records are
+// overwritten.
+//
+//   xoins::Journal journal;
+//   journal.Open("stats.journal", 1 << 20); // a million records
+//   InspectableJournal<float> statJournal(journal, 1);
+//
+// Writing needs xoins_journal (see Customization). Reading doesn't, so offline tools can
+// include this file as is, load the journal file and call xoins::ReadJournal and
+// xoins::ReplayJournal to rebuild the Inspectables it describes:
+//
+//   std::vector<xoins::JournalRecord> records;
+//   xoins::ReadJournal(fileBytes, fileSize, records); // sorted oldest first
+//   std::unordered_map<uint64_t, InspectableF> stats;
+//   xoins::ReplayJournal(records.data(), records.size(), 1, stats, [&](const xoins::JournalRecord& r) {
+//     return FindModifier(r.data); // an InspectableTransformation<float>* for a definition id
+//   });
+//
+// Inspectables and transformations are named by their address. Beyond that a
+// transformation is only recorded by its definition id and priority (see
+// InspectableTransformation::SetDefinitionId), so several may share a definition id (or
+// have none) and still be told apart. A transformation doesn't tell its Inspectable when
+// it's enabled or disabled, so that's only recorded when it happens as part of another
+// change. A replay is exact as long as the ring hasn't wrapped.
+//
+// Records are only ordered by their sequence number, and a thread's records reach the
+// file when its buffer fills, the thread exits, or Journal::FlushThread is called. The
+// Journal has to outlive every thread writing to it.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  enum JournalRecordKind {
+    JournalEmpty                  = 0, // a slot nothing was written to
+    JournalIdentity               = 1, // data is the new identity
+    JournalValue                  = 2, // data is the new cached value
+    JournalTransformationAdded    = 3, // data is the definition id of 'transformation'
+    JournalTransformationRemoved  = 4,
+    JournalTransformationEnabled  = 5,
+    JournalTransformationDisabled = 6,
+    JournalDestroyed              = 7,
+  };
+
+  struct JournalRecord {
+    uint64_t  sequence;       // orders records across threads
+    uint64_t  inspectable;    // the address of the Inspectable
+    uint64_t  transformation; // the address of a transformation, for the transformation kinds
+    uint64_t  data;           // the bits of a value, or a definition id
+    int32_t   priority;    // of a transformation
+    uint8_t   kind;        // a JournalRecordKind
+    uint8_t   enabled;     // of a transformation
+    uint16_t  stream;      // which InspectableJournal wrote this
+  };
+
+  // Collects the records in a journal file, oldest first. Returns false if the bytes
+  // aren't a journal.
+  bool ReadJournal(const void* bytes, size_t size, std::vector<JournalRecord>& out);
+
+  // Replays the records of one stream into 'inspectables', keyed by the address they had.
+  // Identity and value records are applied with SetIdentity and RestoreState, so the
+  // result matches what was recorded even where a transformation can't be resolved.
+  // resolve(record) returns the Inspectable<T, TPolicy>::TTransform* for an added
+  // transformation, or null to skip it. It should return a different one for every added
+  // record, since records may share a definition id. Later records about the same
+  // recorded transformation apply to what was returned for it. T must match the stream's
+  // Inspectables.
+  template<typename T, typename TPolicy, typename TResolve>
+  void ReplayJournal(const JournalRecord* records,
+                     size_t count,
+                     uint16_t stream,
+                     std::unordered_map<uint64_t, Inspectable<T, TPolicy> >& inspectables,
+                     TResolve resolve);
+
+  namespace internal {
+    struct JournalHeader {
+      uint32_t  magic;
+      uint16_t  version;
+      uint16_t  recordSize;
+      uint64_t  capacity; // in records
+    };
+
+    const uint32_t JournalMagic = 0x4a494f58; // "XOIJ" when written little endian
+    const uint16_t JournalVersion = 2;
+    const size_t JournalRecordsOffset = sizeof(JournalRecord); // the header is padded to one record
+
+    template<typename T>
+    uint64_t JournalBits(const T& value);
+    template<typename T>
+    T JournalValue(uint64_t bits);
+  }
+
+#ifdef xoins_journal
+  class Journal {
+  public:
+    Journal();
+    ~Journal(); // flushes and closes
+
+    // creates (or replaces) a ring file of 'capacity' records and maps it.
+    bool Open(const char* path, uint64_t capacity);
+    void Close();
+    bool IsOpen() const;
+
+    // records from any thread. Dropped while the journal isn't open.
+    void Append(JournalRecord record);
+    // copies the calling thread's buffered records into the file.
+    void FlushThread();
+
+  private:
+    static const unsigned ThreadBufferSize = 64;
+
+    struct ThreadBuffer {
+      ThreadBuffer();
+      ~ThreadBuffer(); // flushes when a thread exits
+      Journal*      journal;
+      unsigned      count;
+      JournalRecord records[ThreadBufferSize];
+    };
+
+    Journal(const Journal&);
+    Journal& operator=(const Journal&);
+
+    static ThreadBuffer& GetThreadBuffer();
+    void Bind(ThreadBuffer& buffer);
+    void Unbind(ThreadBuffer& buffer);
+    void Flush(ThreadBuffer& buffer);
+
+    JournalRecord*              m_Records;
+    uint64_t                    m_Capacity;
+    void*                       m_Mapping;
+    size_t                      m_MappingSize;
+    std::atomic<uint64_t>       m_Cursor;   // slots reserved so far
+    std::atomic<uint64_t>       m_Sequence;
+    std::mutex                  m_BuffersMutex;
+    std::vector<ThreadBuffer*>  m_Buffers;  // thread buffers bound to this journal
+  };
+#endif // xoins_journal
+}
+
+#ifdef xoins_journal
+template<typename T, typename TPolicy = xoins::DefaultListPolicy>
+class InspectableJournal : public InspectableObserver<T, TPolicy>
+{
+  static_assert(std::is_trivially_copyable<T>::value && sizeof(T) <= sizeof(uint64_t),
+                "journals only record trivially copyable values of at most 8 bytes");
+public:
+  typedef Inspectable<T, TPolicy> TInspectable;
+
+  // records every Inspectable<T, TPolicy> into 'journal', tagging records with 'stream'.
+  InspectableJournal(xoins::Journal& journal, uint16_t stream);
+
+  void OnBeforeChange(TInspectable* inspectable) override;
+  void OnChanged(TInspectable* inspectable) override;
+  void OnDestroyed(TInspectable* inspectable) override;
+
+private:
+  struct TransformationState {
+    const typename TInspectable::TTransform*  transformation;
+    unsigned                                  definitionId;
+    int                                       priority;
+    bool                                      enabled;
+  };
+
+  // the state of the Inspectable being changed on this thread.
+  struct Before {
+    T                                 identity;
+    T                                 value;
+    std::vector<TransformationState>  transformations;
+  };
+
+  static Before& GetBefore();
+  void Append(const TInspectable* inspectable,
+              xoins::JournalRecordKind kind,
+              uint64_t data,
+              const typename TInspectable::TTransform* transformation = nullptr,
+              int32_t priority = 0,
+              bool enabled = false);
+
+  xoins::Journal& m_Journal;
+  uint16_t        m_Stream;
+};
+#endif // xoins_journal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Snapshots
+//////////////////////////////////////////////////////////////////////////////////////////
+// A snapshot is a flat binary image of many Inspectable<T>s: their identities, their
+// cached values and a descriptor (definition id, priority, enabled) for every
+// transformation with a definition id. Everything is stored as contiguous arrays, so
+// loading is a handful of bounds checks followed by straight copies, and a snapshot can
+// be read in place from a memory mapped file through SnapshotView without parsing
+// anything per object.
+//
+//   std::vector<unsigned char> bytes;
+//   xoins::WriteSnapshot(stats, statCount, bytes);
+//   ...
+//   xoins::SnapshotView<float> view(bytes.data(), bytes.size());
+//   xoins::RestoreSnapshot(view, stats, statCount, [&](size_t index, const xoins::SnapshotTransformDescriptor& d) {
+//     return MakeModifier(index, d.definitionId); // an InspectableTransformation<float>*
+//   });
+//
+// T must be trivially copyable. Snapshots use the byte order and layout of the machine
+// that wrote them, so they're meant for save files and caches on the same platform. The
+// bytes handed to SnapshotView must be 8 byte aligned (mmap and operator new both are).
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  struct SnapshotTransformDescriptor {
+    uint32_t  definitionId;
+    int32_t   priority;
+    uint32_t  enabled;
+  };
+
+  template<typename T>
+  class SnapshotView {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots can only store trivially copyable values");
+  public:
+    SnapshotView();
+    // bytes must outlive the view. The view is invalid if they don't hold a snapshot of T.
+    SnapshotView(const void* bytes, size_t size);
+
+    bool      IsValid() const;
+    uint32_t  GetCount() const;
+    const T*  GetIdentities() const; // GetCount() identities
+    const T*  GetValues() const;     // GetCount() cached values
+
+    // the transformation descriptors of the index'th Inspectable, in evaluation order.
+    const SnapshotTransformDescriptor* GetTransformsBegin(uint32_t index) const;
+    const SnapshotTransformDescriptor* GetTransformsEnd(uint32_t index) const;
+
+  private:
+    uint32_t                            m_Count;
+    const T*                            m_Identities;
+    const T*                            m_Values;
+    const uint32_t*                     m_TransformOffsets; // m_Count + 1 entries
+    const SnapshotTransformDescriptor*  m_Transforms;
+  };
+
+  // Appends a snapshot of 'count' Inspectables to 'out'. The first form takes a
+  // contiguous array, the second an array of pointers.
+  template<typename T, typename TPolicy>
+  void WriteSnapshot(const Inspectable<T, TPolicy>* inspectables, size_t count, std::vector<unsigned char>& out);
+  template<typename T, typename TPolicy>
+  void WriteSnapshot(const Inspectable<T, TPolicy>* const* inspectables, size_t count, std::vector<unsigned char>& out);
+
+  // Restores identities and cached values with Inspectable::RestoreState, so nothing is
+  // recomputed and no listener is called. Returns false (and restores nothing) if the
+  // view is invalid or holds a different number of Inspectables.
+  //
+  // The second form also rebuilds transformations: resolver(index, descriptor) returns
+  // the Inspectable<T, TPolicy>::TTransform* to attach (or null to skip it). The
+  // snapshot's priority, enabled state and definition id are applied to it before it's
+  // attached.
+  // The resolved transformations replace each Inspectable's current ones (see
+  // Inspectable::RestoreTransformations), including those without a definition id.
+  template<typename T, typename TPolicy>
+  bool RestoreSnapshot(const SnapshotView<T>& view, Inspectable<T, TPolicy>* inspectables, size_t count);
+  template<typename T, typename TPolicy, typename TResolver>
+  bool RestoreSnapshot(const SnapshotView<T>& view, Inspectable<T, TPolicy>* inspectables, size_t count, TResolver resolver);
+
+  namespace internal {
+    struct SnapshotHeader {
+      uint32_t  magic;
+      uint16_t  version;
+      uint16_t  valueSize;
+      uint32_t  count;
+      uint32_t  transformCount;
+    };
+
+    const uint32_t SnapshotMagic = 0x53494f58; // "XOIS" when written little endian
+    const uint16_t SnapshotVersion = 1;
+
+    size_t AlignSnapshotOffset(size_t offset);
+
+    template<typename T, typename TGet>
+    void WriteSnapshot(size_t count, TGet get, std::vector<unsigned char>& out);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// INTERNAL
+//////////////////////////////////////////////////////////////////////////////////////////
+// Below are a series of internal implementation details. The only API to note here is
+// a typedef for basic types, specifying the template on each of the classes in this file.
+//
+// They take the form of: InspectableF (float) InspectableB (bool) InspectableU (unsigned)
+// and so on.
+//
+//////////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// IntrusiveListHook
+//////////////////////////////////////////////////////////////////////////////////////////
+inline xoins::IntrusiveListHook::IntrusiveListHook()
+: m_HookPrev(nullptr),
+m_HookNext(nullptr),
+m_HookList(nullptr)
+{
+}
+
+inline xoins::IntrusiveListHook::IntrusiveListHook(const IntrusiveListHook&)
+: m_HookPrev(nullptr),
+m_HookNext(nullptr),
+m_HookList(nullptr)
+{
+}
+
+inline xoins::IntrusiveListHook& xoins::IntrusiveListHook::operator=(const IntrusiveListHook&) {
+  return *this; // links belong to the object, not its value.
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// VectorList
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename E, typename TAllocator>
+typename xoins::VectorList<E, TAllocator>::const_iterator xoins::VectorList<E, TAllocator>::begin() const {
+  return m_Elements.begin();
+}
+
+template<typename E, typename TAllocator>
+typename xoins::VectorList<E, TAllocator>::const_iterator xoins::VectorList<E, TAllocator>::end() const {
+  return m_Elements.end();
+}
+
+template<typename E, typename TAllocator>
+bool xoins::VectorList<E, TAllocator>::IsEmpty() const {
+  return m_Elements.empty();
+}
+
+template<typename E, typename TAllocator>
+void xoins::VectorList<E, TAllocator>::Add(E e) {
+  m_Elements.push_back(e);
+}
+
+template<typename E, typename TAllocator>
+template<typename TLess>
+void xoins::VectorList<E, TAllocator>::Insert(E e, TLess less) {
+  m_Elements.push_back(e);
+  std::sort(m_Elements.begin(), m_Elements.end(), less);
+}
+
+template<typename E, typename TAllocator>
+bool xoins::VectorList<E, TAllocator>::Remove(E e) {
+  auto found = std::find(m_Elements.begin(), m_Elements.end(), e);
+  if(found == m_Elements.end())
+    return false;
+  m_Elements.erase(found);
+  return true;
+}
+
+template<typename E, typename TAllocator>
+bool xoins::VectorList<E, TAllocator>::Replace(E from, E to) {
+  auto found = std::find(m_Elements.begin(), m_Elements.end(), from);
+  if(found == m_Elements.end())
+    return false;
+  *found = to;
+  return true;
+}
+
+template<typename E, typename TAllocator>
+bool xoins::VectorList<E, TAllocator>::Contains(E e) const {
+  return std::find(m_Elements.begin(), m_Elements.end(), e) != m_Elements.end();
+}
+
+template<typename E, typename TAllocator>
+void xoins::VectorList<E, TAllocator>::Clear() {
+  m_Elements.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SmallVector
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename E, unsigned N>
+xoins::SmallVector<E, N>::SmallVector()
+: m_Size(0),
+m_Capacity(N)
+{
+}
+
+template<typename E, unsigned N>
+xoins::SmallVector<E, N>::SmallVector(const SmallVector& other)
+: m_Size(0),
+m_Capacity(N)
+{
+  *this = other;
+}
+
+template<typename E, unsigned N>
+xoins::SmallVector<E, N>::~SmallVector() {
+  if(m_Capacity > N)
+    delete[] m_Heap;
+}
+
+template<typename E, unsigned N>
+xoins::SmallVector<E, N>& xoins::SmallVector<E, N>::operator=(const SmallVector& other) {
+  if(this == &other)
+    return *this;
+  Reserve(other.m_Size);
+  std::copy(other.begin(), other.end(), Data());
+  m_Size = other.m_Size;
+  return *this;
+}
+
+template<typename E, unsigned N>
+typename xoins::SmallVector<E, N>::const_iterator xoins::SmallVector<E, N>::begin() const {
+  return Data();
+}
+
+template<typename E, unsigned N>
+typename xoins::SmallVector<E, N>::const_iterator xoins::SmallVector<E, N>::end() const {
+  return Data() + m_Size;
+}
+
+template<typename E, unsigned N>
+bool xoins::SmallVector<E, N>::IsEmpty() const {
+  return m_Size == 0;
+}
+
+template<typename E, unsigned N>
+unsigned xoins::SmallVector<E, N>::GetSize() const {
+  return m_Size;
+}
+
+template<typename E, unsigned N>
+void xoins::SmallVector<E, N>::Add(E e) {
+  if(m_Size == m_Capacity)
+    Reserve(m_Capacity * 2);
+  Data()[m_Size++] = e;
+}
+
+template<typename E, unsigned N>
+template<typename TLess>
+void xoins::SmallVector<E, N>::Insert(E e, TLess less) {
+  Add(e);
+  // a binary search and a shift rather than a sort, so equal elements keep their order.
+  E* data = Data();
+  E* at = std::upper_bound(data, data + m_Size - 1, e, less);
+  std::copy_backward(at, data + m_Size - 1, data + m_Size);
+  *at = e;
+}
+
+template<typename E, unsigned N>
+bool xoins::SmallVector<E, N>::Remove(E e) {
+  E* end = Data() + m_Size;
+  E* found = std::find(Data(), end, e);
+  if(found == end)
+    return false;
+  std::copy(found + 1, end, found);
+  --m_Size;
+  return true;
+}
+
+template<typename E, unsigned N>
+bool xoins::SmallVector<E, N>::Replace(E from, E to) {
+  E* end = Data() + m_Size;
+  E* found = std::find(Data(), end, from);
+  if(found == end)
+    return false;
+  *found = to;
+  return true;
+}
+
+template<typename E, unsigned N>
+bool xoins::SmallVector<E, N>::Contains(E e) const {
+  return std::find(begin(), end(), e) != end();
+}
+
+template<typename E, unsigned N>
+void xoins::SmallVector<E, N>::Clear() {
+  m_Size = 0; // keeps any heap storage for reuse.
+}
+
+template<typename E, unsigned N>
+E* xoins::SmallVector<E, N>::Data() {
+  return m_Capacity > N ? m_Heap : m_Inline;
+}
+
+template<typename E, unsigned N>
+const E* xoins::SmallVector<E, N>::Data() const {
+  return m_Capacity > N ? m_Heap : m_Inline;
+}
+
+template<typename E, unsigned N>
+void xoins::SmallVector<E, N>::Reserve(unsigned capacity) {
+  if(capacity <= m_Capacity)
+    return;
+  E* data = new E[capacity];
+  std::copy(Data(), Data() + m_Size, data);
+  if(m_Capacity > N)
+    delete[] m_Heap;
+  m_Heap = data;
+  m_Capacity = capacity;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// IntrusiveList
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename E>
+xoins::IntrusiveList<E>::const_iterator::const_iterator(const IntrusiveListHook* hook)
+: m_Hook(hook)
+{
+}
+
+template<typename E>
+E xoins::IntrusiveList<E>::const_iterator::operator*() const {
+  return static_cast<E>(const_cast<IntrusiveListHook*>(m_Hook));
+}
+
+template<typename E>
+typename xoins::IntrusiveList<E>::const_iterator& xoins::IntrusiveList<E>::const_iterator::operator++() {
+  m_Hook = m_Hook->m_HookNext;
+  return *this;
+}
+
+template<typename E>
+bool xoins::IntrusiveList<E>::const_iterator::operator!=(const const_iterator& other) const {
+  return m_Hook != other.m_Hook;
+}
+
+template<typename E>
+xoins::IntrusiveList<E>::IntrusiveList()
+: m_Head(nullptr),
+m_Tail(nullptr)
+{
+}
+
+template<typename E>
+xoins::IntrusiveList<E>::~IntrusiveList() {
+  Clear();
+}
+
+template<typename E>
+typename xoins::IntrusiveList<E>::const_iterator xoins::IntrusiveList<E>::begin() const {
+  return const_iterator(m_Head);
+}
+
+template<typename E>
+typename xoins::IntrusiveList<E>::const_iterator xoins::IntrusiveList<E>::end() const {
+  return const_iterator(nullptr);
+}
+
+template<typename E>
+bool xoins::IntrusiveList<E>::IsEmpty() const {
+  return m_Head == nullptr;
+}
+
+template<typename E>
+void xoins::IntrusiveList<E>::Add(E e) {
+  LinkBefore(e, nullptr);
+}
+
+template<typename E>
+template<typename TLess>
+void xoins::IntrusiveList<E>::Insert(E e, TLess less) {
+  // walk to the first element that e should come before. Equal elements stay in order.
+  IntrusiveListHook* next = m_Head;
+  while(next && !less(e, static_cast<E>(next)))
+    next = next->m_HookNext;
+  LinkBefore(e, next);
+}
+
+template<typename E>
+bool xoins::IntrusiveList<E>::Remove(E e) {
+  IntrusiveListHook* hook = e;
+  if(hook->m_HookList != this)
+    return false;
+  (hook->m_HookPrev ? hook->m_HookPrev->m_HookNext : m_Head) = hook->m_HookNext;
+  (hook->m_HookNext ? hook->m_HookNext->m_HookPrev : m_Tail) = hook->m_HookPrev;
+  hook->m_HookPrev = hook->m_HookNext = nullptr;
+  hook->m_HookList = nullptr;
+  return true;
+}
+
+template<typename E>
+bool xoins::IntrusiveList<E>::Replace(E from, E to) {
+  IntrusiveListHook* hook = from;
+  IntrusiveListHook* replacement = to;
+  if(hook->m_HookList != this || replacement->m_HookList)
+    return false;
+  replacement->m_HookPrev = hook->m_HookPrev;
+  replacement->m_HookNext = hook->m_HookNext;
+  replacement->m_HookList = this;
+  (hook->m_HookPrev ? hook->m_HookPrev->m_HookNext : m_Head) = replacement;
+  (hook->m_HookNext ? hook->m_HookNext->m_HookPrev : m_Tail) = replacement;
+  hook->m_HookPrev = hook->m_HookNext = nullptr;
+  hook->m_HookList = nullptr;
+  return true;
+}
+
+template<typename E>
+bool xoins::IntrusiveList<E>::Contains(E e) const {
+  return static_cast<const IntrusiveListHook*>(e)->m_HookList == this;
+}
+
+template<typename E>
+void xoins::IntrusiveList<E>::Clear() {
+  // unlink everything so the elements can be added to another list later.
+  IntrusiveListHook* hook = m_Head;
+  while(hook) {
+    IntrusiveListHook* next = hook->m_HookNext;
+    hook->m_HookPrev = hook->m_HookNext = nullptr;
+    hook->m_HookList = nullptr;
+    hook = next;
+  }
+  m_Head = m_Tail = nullptr;
+}
+
+template<typename E>
+void xoins::IntrusiveList<E>::LinkBefore(IntrusiveListHook* hook, IntrusiveListHook* next) {
+  if(hook->m_HookList) // already in a list, intrusive elements can't be added twice.
+    return;
+  hook->m_HookList = this;
+  hook->m_HookNext = next;
+  hook->m_HookPrev = next ? next->m_HookPrev : m_Tail;
+  (hook->m_HookPrev ? hook->m_HookPrev->m_HookNext : m_Head) = hook;
+  (next ? next->m_HookPrev : m_Tail) = hook;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SortedFlatList
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename E, typename TAllocator>
+typename xoins::SortedFlatList<E, TAllocator>::const_iterator xoins::SortedFlatList<E, TAllocator>::begin() const {
+  return m_Elements.begin();
+}
+
+template<typename E, typename TAllocator>
+typename xoins::SortedFlatList<E, TAllocator>::const_iterator xoins::SortedFlatList<E, TAllocator>::end() const {
+  return m_Elements.end();
+}
+
+template<typename E, typename TAllocator>
+bool xoins::SortedFlatList<E, TAllocator>::IsEmpty() const {
+  return m_Elements.empty();
+}
+
+template<typename E, typename TAllocator>
+void xoins::SortedFlatList<E, TAllocator>::Add(E e) {
+  m_Elements.push_back(e);
+}
+
+template<typename E, typename TAllocator>
+template<typename TLess>
+void xoins::SortedFlatList<E, TAllocator>::Insert(E e, TLess less) {
+  m_Elements.insert(std::upper_bound(m_Elements.begin(), m_Elements.end(), e, less), e);
+}
+
+template<typename E, typename TAllocator>
+bool xoins::SortedFlatList<E, TAllocator>::Remove(E e) {
+  auto found = std::find(m_Elements.begin(), m_Elements.end(), e);
+  if(found == m_Elements.end())
+    return false;
+  m_Elements.erase(found);
+  return true;
+}
+
+template<typename E, typename TAllocator>
+bool xoins::SortedFlatList<E, TAllocator>::Replace(E from, E to) {
+  auto found = std::find(m_Elements.begin(), m_Elements.end(), from);
+  if(found == m_Elements.end())
+    return false;
+  *found = to;
+  return true;
+}
+
+template<typename E, typename TAllocator>
+bool xoins::SortedFlatList<E, TAllocator>::Contains(E e) const {
+  return std::find(m_Elements.begin(), m_Elements.end(), e) != m_Elements.end();
+}
+
+template<typename E, typename TAllocator>
+void xoins::SortedFlatList<E, TAllocator>::Clear() {
+  m_Elements.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// HotColdList
+//////////////////////////////////////////////////////////////////////////////////////////
+inline unsigned xoins::internal::CountTrailingZeros(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctzll(bits);
+#else
+  unsigned count = 0;
+  for(; !(bits & 1); bits >>= 1)
+    ++count;
+  return count;
+#endif
+}
+
+template<typename E>
+xoins::HotColdList<E>::HotColdList()
+: m_Stale(true)
+{
+}
+
+template<typename E>
+typename xoins::HotColdList<E>::const_iterator xoins::HotColdList<E>::begin() const {
+  return m_Elements.begin();
+}
+
+template<typename E>
+typename xoins::HotColdList<E>::const_iterator xoins::HotColdList<E>::end() const {
+  return m_Elements.end();
+}
+
+template<typename E>
+bool xoins::HotColdList<E>::IsEmpty() const {
+  return m_Elements.empty();
+}
+
+template<typename E>
+void xoins::HotColdList<E>::Add(E e) {
+  HotEntry hot = { nullptr, nullptr, e->GetPriority() };
+  m_Elements.push_back(e);
+  m_Hot.push_back(hot);
+  m_Stale = true;
+}
+
+template<typename E>
+template<typename TLess>
+void xoins::HotColdList<E>::Insert(E e, TLess) {
+  HotEntry hot = { nullptr, nullptr, e->GetPriority() };
+  auto at = std::upper_bound(m_Hot.begin(), m_Hot.end(), hot, [](const HotEntry& a, const HotEntry& b) {
+    return a.priority > b.priority;
+  });
+  m_Elements.insert(m_Elements.begin() + (at - m_Hot.begin()), e);
+  m_Hot.insert(at, hot);
+  m_Stale = true;
+}
+
+template<typename E>
+bool xoins::HotColdList<E>::Remove(E e) {
+  auto found = std::find(m_Elements.begin(), m_Elements.end(), e);
+  if(found == m_Elements.end())
+    return false;
+  m_Hot.erase(m_Hot.begin() + (found - m_Elements.begin()));
+  m_Elements.erase(found);
+  m_Stale = true;
+  return true;
+}
+
+template<typename E>
+bool xoins::HotColdList<E>::Replace(E from, E to) {
+  auto found = std::find(m_Elements.begin(), m_Elements.end(), from);
+  if(found == m_Elements.end())
+    return false;
+  *found = to;
+  m_Stale = true; // the hot entry still points into 'from'.
+  return true;
+}
+
+template<typename E>
+bool xoins::HotColdList<E>::Contains(E e) const {
+  return std::find(m_Elements.begin(), m_Elements.end(), e) != m_Elements.end();
+}
+
+template<typename E>
+void xoins::HotColdList<E>::Clear() {
+  m_Elements.clear();
+  m_Hot.clear();
+  m_Stale = true;
+}
+
+template<typename E>
+void xoins::HotColdList<E>::MarkStale() {
+  m_Stale = true;
+}
+
+template<typename E>
+bool xoins::HotColdList<E>::IsStale() const {
+  return m_Stale;
+}
+
+template<typename E>
+void xoins::HotColdList<E>::Run(TValue& value) {
+  if(m_Stale)
+    Refresh();
+  const HotEntry* hot = m_Hot.data();
+  const TOp* ops = m_Ops.data();
+  for(size_t word = 0; word < m_Enabled.size(); ++word) {
+    for(uint64_t bits = m_Enabled[word]; bits; bits &= bits - 1) {
+      size_t index = word * 64 + internal::CountTrailingZeros(bits);
+      const HotEntry& entry = hot[index];
+      if(entry.invoke)
+        entry.invoke(entry.context, value);
+      else
+        internal::ApplyTransformOp(ops[index], value, std::integral_constant<bool, TransformOpTraits<TValue>::Enabled>());
+    }
+  }
+}
+
+template<typename E>
+void xoins::HotColdList<E>::Refresh() {
+  m_Enabled.assign((m_Elements.size() + 63) / 64, 0);
+  if(TransformOpTraits<TValue>::Enabled)
+    m_Ops.resize(m_Elements.size());
+  for(size_t i = 0; i < m_Elements.size(); ++i) {
+    HotEntry& hot = m_Hot[i];
+    bool active = m_Elements[i]->IsActive();
+    bool callable = m_Elements[i]->GetInvoker(hot.invoke, hot.context);
+    if(callable && !hot.invoke) // ops can only be set for types with ops, so m_Ops has room.
+      m_Ops[i] = m_Elements[i]->GetOp();
+    if(callable && active)
+      m_Enabled[i / 64] |= uint64_t(1) << (i % 64);
+    if(active && m_Elements[i]->IsAbsorbing())
+      break; // nothing after it runs until the next refresh.
+  }
+  m_Stale = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// PriorityBucketList
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename E>
+xoins::PriorityBucketList<E>::const_iterator::const_iterator(const Bucket* bucket, const Bucket* end)
+: m_Bucket(bucket),
+m_End(end),
+m_Index(0)
+{
+}
+
+template<typename E>
+E xoins::PriorityBucketList<E>::const_iterator::operator*() const {
+  return m_Bucket->elements[m_Index];
+}
+
+template<typename E>
+typename xoins::PriorityBucketList<E>::const_iterator& xoins::PriorityBucketList<E>::const_iterator::operator++() {
+  // buckets are never empty, so moving to the next one always lands on an element.
+  if(++m_Index == m_Bucket->elements.size()) {
+    ++m_Bucket;
+    m_Index = 0;
+  }
+  return *this;
+}
+
+template<typename E>
+bool xoins::PriorityBucketList<E>::const_iterator::operator==(const const_iterator& other) const {
+  return m_Bucket == other.m_Bucket && m_Index == other.m_Index;
+}
+
+template<typename E>
+bool xoins::PriorityBucketList<E>::const_iterator::operator!=(const const_iterator& other) const {
+  return !(*this == other);
+}
+
+template<typename E>
+typename xoins::PriorityBucketList<E>::const_iterator xoins::PriorityBucketList<E>::begin() const {
+  return const_iterator(m_Buckets.data(), m_Buckets.data() + m_Buckets.size());
+}
+
+template<typename E>
+typename xoins::PriorityBucketList<E>::const_iterator xoins::PriorityBucketList<E>::end() const {
+  return const_iterator(m_Buckets.data() + m_Buckets.size(), m_Buckets.data() + m_Buckets.size());
+}
+
+template<typename E>
+bool xoins::PriorityBucketList<E>::IsEmpty() const {
+  return m_Buckets.empty();
+}
+
+template<typename E>
+void xoins::PriorityBucketList<E>::Add(E e) {
+  int priority = e->GetPriority();
+  if(!m_Buckets.empty() && priority < m_Buckets.back().priority) {
+    Bucket bucket;
+    bucket.priority = priority;
+    bucket.elements.push_back(e);
+    m_Buckets.push_back(bucket);
+  }
+  else if(!m_Buckets.empty() && priority == m_Buckets.back().priority) {
+    m_Buckets.back().elements.push_back(e);
+  }
+  else {
+    Insert(e, nullptr);
+  }
+}
+
+template<typename E>
+template<typename TLess>
+void xoins::PriorityBucketList<E>::Insert(E e, TLess) {
+  int priority = e->GetPriority();
+  auto at = std::lower_bound(m_Buckets.begin(), m_Buckets.end(), priority, [](const Bucket& bucket, int key) {
+    return bucket.priority > key;
+  });
+  if(at == m_Buckets.end() || at->priority != priority) {
+    Bucket bucket;
+    bucket.priority = priority;
+    at = m_Buckets.insert(at, bucket);
+  }
+  at->elements.push_back(e);
+}
+
+template<typename E>
+bool xoins::PriorityBucketList<E>::Remove(E e) {
+  // searched rather than looked up by priority, so nothing depends on it not changing.
+  for(auto bucket = m_Buckets.begin(); bucket != m_Buckets.end(); ++bucket) {
+    auto found = std::find(bucket->elements.begin(), bucket->elements.end(), e);
+    if(found == bucket->elements.end())
+      continue;
+    bucket->elements.erase(found);
+    if(bucket->elements.empty())
+      m_Buckets.erase(bucket);
+    return true;
+  }
+  return false;
+}
+
+template<typename E>
+bool xoins::PriorityBucketList<E>::Replace(E from, E to) {
+  for(Bucket& bucket : m_Buckets) {
+    auto found = std::find(bucket.elements.begin(), bucket.elements.end(), from);
+    if(found != bucket.elements.end()) {
+      *found = to;
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename E>
+bool xoins::PriorityBucketList<E>::Contains(E e) const {
+  for(const Bucket& bucket : m_Buckets)
+    if(std::find(bucket.elements.begin(), bucket.elements.end(), e) != bucket.elements.end())
+      return true;
+  return false;
+}
+
+template<typename E>
+void xoins::PriorityBucketList<E>::Clear() {
+  m_Buckets.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableConnection
+//////////////////////////////////////////////////////////////////////////////////////////
+inline InspectableConnection::InspectableConnection()
+: m_Index(0),
+m_Generation(0),
+m_IdentityChanged(false)
+{
+}
+
+inline InspectableConnection::InspectableConnection(unsigned index, unsigned generation, bool identityChanged)
+: m_Index(index),
+m_Generation(generation),
+m_IdentityChanged(identityChanged)
+{
+}
+
+inline bool InspectableConnection::IsValid() const {
+  return m_Generation != 0;
+}
+
+inline bool InspectableConnection::IsIdentityChanged() const {
+  return m_IdentityChanged;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Parallel dispatch
+//////////////////////////////////////////////////////////////////////////////////////////
+inline xoins::internal::ParallelDispatchSettings& xoins::internal::GetParallelDispatchSettings() {
+  static ParallelDispatchSettings settings = { nullptr, 4096, 1024 };
+  return settings;
+}
+
+inline void xoins::SetParallelDispatcher(ParallelDispatcher* dispatcher,
+                                         unsigned minListeners,
+                                         unsigned listenersPerJob) {
+  internal::ParallelDispatchSettings& settings = internal::GetParallelDispatchSettings();
+  settings.dispatcher = dispatcher;
+  settings.minListeners = minListeners;
+  settings.listenersPerJob = listenersPerJob ? listenersPerJob : 1;
+}
+
+inline xoins::internal::DeferredWork*& xoins::internal::CurrentDeferredWork() {
+  static thread_local DeferredWork* current = nullptr;
+  return current;
+}
+
+inline void xoins::internal::AssertNotInAnyThreadListener() {
+  assert(!CurrentDeferredWork() && "AnyThread listeners must not change Inspectables, see xoins::DeferFromListener");
+}
+
+inline void xoins::DeferFromListener(std::function<void()> work) {
+  internal::DeferredWork* deferred = internal::CurrentDeferredWork();
+  if(!deferred) {
+    work();
+    return;
+  }
+  std::lock_guard<std::mutex> lock(deferred->mutex);
+  deferred->work.push_back(std::move(work));
+}
+
+inline bool xoins::IsInAnyThreadListener() {
+  return internal::CurrentDeferredWork() != nullptr;
+}
+
+#ifdef xoins_thread_pool
+inline xoins::ThreadPoolDispatcher::ThreadPoolDispatcher(unsigned threadCount)
+: m_Job(nullptr),
+m_Context(nullptr),
+m_JobCount(0),
+m_NextJob(0),
+m_Finished(0),
+m_Active(0),
+m_Generation(0),
+m_Running(false),
+m_Quit(false)
+{
+  if(threadCount == 0) {
+    unsigned hardware = std::thread::hardware_concurrency();
+    threadCount = hardware > 1 ? hardware - 1 : 1;
+  }
+  for(unsigned i = 0; i < threadCount; ++i)
+    m_Threads.push_back(std::thread(&ThreadPoolDispatcher::WorkerLoop, this));
+}
+
+inline xoins::ThreadPoolDispatcher::~ThreadPoolDispatcher() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Quit = true;
+  }
+  m_Wake.notify_all();
+  for(auto& thread : m_Threads)
+    thread.join();
+}
+
+inline void xoins::ThreadPoolDispatcher::Run(unsigned jobCount, TJobFunc job, void* context) {
+  if(IsRunningJobOnThisThread()) {
+    // a job started another dispatch, run it right here rather than deadlocking.
+    for(unsigned i = 0; i < jobCount; ++i)
+      job(context, i);
+    return;
+  }
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  // another thread's dispatch.
+  m_Done.wait(lock, [this] { return !m_Running; });
+  m_Running = true;
+  m_Job = job;
+  m_Context = context;
+  m_JobCount = jobCount;
+  m_NextJob = 0;
+  m_Finished = 0;
+  ++m_Generation;
+  m_Wake.notify_all();
+  Work(lock);
+  // wait for the other threads to leave Work too, so none of them can pick up a job
+  // index from the next Run with this Run's job function.
+  m_Done.wait(lock, [this] { return m_Finished == m_JobCount && m_Active == 0; });
+  m_Running = false;
+  m_Done.notify_all(); // for Runs waiting their turn
+}
+
+inline void xoins::ThreadPoolDispatcher::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  unsigned seenGeneration = m_Generation;
+  for(;;) {
+    m_Wake.wait(lock, [&] { return m_Quit || seenGeneration != m_Generation; });
+    if(m_Quit)
+      return;
+    seenGeneration = m_Generation;
+    Work(lock);
+  }
+}
+
+inline void xoins::ThreadPoolDispatcher::Work(std::unique_lock<std::mutex>& lock) {
+  ++m_Active;
+  const RunningJob*& running = ThreadRunningJobs();
+  RunningJob job = { this, running };
+  running = &job;
+  while(m_NextJob < m_JobCount) {
+    unsigned index = m_NextJob++;
+    lock.unlock();
+    m_Job(m_Context, index);
+    lock.lock();
+    ++m_Finished;
+  }
+  running = job.outer;
+  --m_Active;
+  if(m_Finished == m_JobCount && m_Active == 0)
+    m_Done.notify_all();
+}
+
+inline bool xoins::ThreadPoolDispatcher::IsRunningJobOnThisThread() const {
+  for(const RunningJob* job = ThreadRunningJobs(); job; job = job->outer)
+    if(job->dispatcher == this)
+      return true;
+  return false;
+}
+
+inline const xoins::ThreadPoolDispatcher::RunningJob*& xoins::ThreadPoolDispatcher::ThreadRunningJobs() {
+  static thread_local const RunningJob* jobs = nullptr;
+  return jobs;
+}
+#endif // xoins_thread_pool
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// ListenerSlots
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename TOwner, typename T>
+xoins::internal::ListenerSlots<TOwner, T>::ListenerSlots()
+: m_Live(0),
+m_LiveAnyThread(0),
+m_Dispatching(0)
+{
+}
+
+template<typename TOwner, typename T>
+xoins::internal::ListenerSlots<TOwner, T>::ListenerSlots(const ListenerSlots& other)
+: m_Slots(other.m_Slots),
+m_Live(other.m_Live),
+m_LiveAnyThread(other.m_LiveAnyThread),
+m_Dispatching(0)
+{
+  // slots freed during a dispatch of 'other' are only pending there; here they're free.
+  for(unsigned i = 0; i < m_Slots.size(); ++i) {
+    if(!m_Slots[i].alive) {
+      m_Slots[i].function = nullptr;
+      m_Free.push_back(i);
+    }
+  }
+}
+
+template<typename TOwner, typename T>
+xoins::internal::ListenerSlots<TOwner, T>& xoins::internal::ListenerSlots<TOwner, T>::operator=(const ListenerSlots& other) {
+  if(this != &other) {
+    ListenerSlots copy(other);
+    m_Slots.swap(copy.m_Slots);
+    m_Free.swap(copy.m_Free);
+    m_PendingFree.clear();
+    m_Live = copy.m_Live;
+    m_LiveAnyThread = copy.m_LiveAnyThread;
+  }
+  return *this;
+}
+
+template<typename TOwner, typename T>
+bool xoins::internal::ListenerSlots<TOwner, T>::IsEmpty() const {
+  return m_Live == 0;
+}
+
+template<typename TOwner, typename T>
+bool xoins::internal::ListenerSlots<TOwner, T>::IsDispatching() const {
+  return m_Dispatching != 0;
+}
+
+template<typename TOwner, typename T>
+unsigned xoins::internal::ListenerSlots<TOwner, T>::Connect(const TFunc& function,
+                                                           TFunc* external,
+                                                           ListenerThreading threading,
+                                                           unsigned& outGeneration) {
+  unsigned index;
+  if(!m_Free.empty()) {
+    index = m_Free.back();
+    m_Free.pop_back();
+  }
+  else {
+    index = (unsigned)m_Slots.size();
+    m_Slots.push_back(Slot());
+    m_Slots.back().generation = 1;
+  }
+  Slot& slot = m_Slots[index];
+  slot.function = function;
+  slot.external = external;
+  slot.alive = true;
+  slot.anyThread = threading == AnyThread;
+  ++m_Live;
+  if(slot.anyThread)
+    ++m_LiveAnyThread;
+  outGeneration = slot.generation;
+  return index;
+}
+
+template<typename TOwner, typename T>
+bool xoins::internal::ListenerSlots<TOwner, T>::Disconnect(unsigned index, unsigned generation) {
+  if(!IsConnected(index, generation))
+    return false;
+  Free(index);
+  return true;
+}
+
+template<typename TOwner, typename T>
+bool xoins::internal::ListenerSlots<TOwner, T>::IsConnected(unsigned index, unsigned generation) const {
+  return index < m_Slots.size() && m_Slots[index].alive && m_Slots[index].generation == generation;
+}
+
+template<typename TOwner, typename T>
+bool xoins::internal::ListenerSlots<TOwner, T>::DisconnectExternal(TFunc* external) {
+  for(unsigned i = 0; i < m_Slots.size(); ++i) {
+    if(m_Slots[i].alive && m_Slots[i].external == external) {
+      Free(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename TOwner, typename T>
+bool xoins::internal::ListenerSlots<TOwner, T>::ContainsExternal(TFunc* external) const {
+  for(unsigned i = 0; i < m_Slots.size(); ++i)
+    if(m_Slots[i].alive && m_Slots[i].external == external)
+      return true;
+  return false;
+}
+
+template<typename TOwner, typename T>
+void xoins::internal::ListenerSlots<TOwner, T>::Dispatch(TOwner* owner,
+                                                        const T& lastValue,
+                                                        const T& newValue,
+                                                        bool allowParallel) {
+  ++m_Dispatching;
+  // slots are never erased, so indexing stays valid even if a listener connects or
+  // disconnects. A dead slot keeps its function until the dispatch is over.
+  const unsigned count = (unsigned)m_Slots.size();
+  const ParallelDispatchSettings& settings = GetParallelDispatchSettings();
+  if(allowParallel && settings.dispatcher && m_LiveAnyThread >= settings.minListeners) {
+    DeferredWork deferred;
+    ParallelJob job = { this, owner, &lastValue, &newValue, count, settings.listenersPerJob, &deferred };
+    settings.dispatcher->Run((count + job.perJob - 1) / job.perJob, &RunParallelJob, &job);
+    // every job has finished, so nothing else touches 'deferred' now.
+    for(std::function<void()>& work : deferred.work)
+      work();
+    for(unsigned i = 0; i < count; ++i)
+      if(!m_Slots[i].anyThread)
+        Call(m_Slots[i], owner, lastValue, newValue);
+  }
+  else {
+    for(unsigned i = 0; i < count; ++i)
+      Call(m_Slots[i], owner, lastValue, newValue);
+  }
+  if(--m_Dispatching == 0) {
+    for(unsigned index : m_PendingFree) {
+      m_Slots[index].function = nullptr;
+      m_Free.push_back(index);
+    }
+    m_PendingFree.clear();
+  }
+}
+
+template<typename TOwner, typename T>
+void xoins::internal::ListenerSlots<TOwner, T>::Call(Slot& slot,
+                                                    TOwner* owner,
+                                                    const T& lastValue,
+                                                    const T& newValue) {
+  if(slot.alive)
+    (slot.external ? *slot.external : slot.function)(owner, lastValue, newValue);
+}
+
+template<typename TOwner, typename T>
+void xoins::internal::ListenerSlots<TOwner, T>::Free(unsigned index) {
+  Slot& slot = m_Slots[index];
+  slot.alive = false;
+  slot.external = nullptr;
+  if(++slot.generation == 0) // skip 0, it marks an invalid connection.
+    slot.generation = 1;
+  --m_Live;
+  if(slot.anyThread)
+    --m_LiveAnyThread;
+  if(m_Dispatching) {
+    m_PendingFree.push_back(index); // the function may be running right now.
+  }
+  else {
+    slot.function = nullptr;
+    m_Free.push_back(index);
+  }
+}
+
+template<typename TOwner, typename T>
+void xoins::internal::ListenerSlots<TOwner, T>::RunParallelJob(void* context, unsigned jobIndex) {
+  ParallelJob& job = *static_cast<ParallelJob*>(context);
+  unsigned begin = jobIndex * job.perJob;
+  unsigned end = std::min(begin + job.perJob, job.count);
+  DeferredWork*& current = CurrentDeferredWork();
+  DeferredWork* outer = current; // a dispatcher may run this inside another job
+  current = job.deferred;
+  for(unsigned i = begin; i < end; ++i) {
+    Slot& slot = job.slots->m_Slots[i];
+    if(slot.anyThread)
+      job.slots->Call(slot, job.owner, *job.lastValue, *job.newValue);
+  }
+  current = outer;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Transform ops
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  template<typename TRaw, unsigned F>
+  struct TransformOpTraits<Fixed<TRaw, F> > {
+    static const bool Enabled = true;
+  };
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::AddOp(const T& amount) {
+  return internal::MakeTransformOp(TransformOpAdd, amount, T());
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::MulOp(const T& factor) {
+  return internal::MakeTransformOp(TransformOpMul, factor, T());
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::SetOp(const T& value) {
+  return internal::MakeTransformOp(TransformOpSet, value, T());
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::MinOp(const T& value) {
+  return internal::MakeTransformOp(TransformOpMin, value, T());
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::MaxOp(const T& value) {
+  return internal::MakeTransformOp(TransformOpMax, value, T());
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::ClampOp(const T& minimum, const T& maximum) {
+  return internal::MakeTransformOp(TransformOpClamp, minimum, maximum);
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::LerpOp(const T& target, const T& t) {
+  return internal::MakeTransformOp(TransformOpLerp, target, t);
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::CurveOp(const CurvePoint<T>* points, size_t count) {
+  TransformOp<T> op = internal::MakeTransformOp(TransformOpCurve, T(), T());
+  op.curve = points;
+  op.curveCount = (uint32_t)count;
+  return op;
+}
+
+template<typename T>
+xoins::TransformOp<T> xoins::internal::MakeTransformOp(TransformOpKind kind, const T& a, const T& b) {
+  TransformOp<T> op = { a, b, nullptr, 0, kind };
+  return op;
+}
+
+template<typename T>
+void xoins::internal::ApplyTransformOp(const TransformOp<T>& op, T& value, std::true_type) {
+  switch(op.kind) {
+  case TransformOpAdd:    value = value + op.a; break;
+  case TransformOpMul:    value = value * op.a; break;
+  case TransformOpSet:    value = op.a; break;
+  case TransformOpMin:    value = op.a < value ? op.a : value; break;
+  case TransformOpMax:    value = value < op.a ? op.a : value; break;
+  case TransformOpClamp:
+    if(value < op.a)
+      value = op.a;
+    else if(op.b < value)
+      value = op.b;
+    break;
+  case TransformOpLerp:   value = value + (op.a - value) * op.b; break;
+  case TransformOpCurve:  value = EvaluateCurve(op.curve, op.curveCount, value); break;
+  default: break;
+  }
+}
+
+template<typename T>
+void xoins::internal::ApplyTransformOp(const TransformOp<T>&, T&, std::false_type) {
+  // ops can't be set for this type (see TransformOpTraits).
+}
+
+template<typename T>
+T xoins::internal::EvaluateCurve(const CurvePoint<T>* points, uint32_t count, const T& x) {
+  if(count == 0)
+    return x;
+  if(!(points[0].x < x))
+    return points[0].y;
+  if(!(x < points[count - 1].x))
+    return points[count - 1].y;
+  // the first point past x. It's never the first one, given the checks above.
+  const CurvePoint<T>* upper = std::upper_bound(points, points + count, x, [](const T& key, const CurvePoint<T>& point) {
+    return key < point.x;
+  });
+  const CurvePoint<T>& lower = upper[-1];
+  return lower.y + (upper->y - lower.y) * ModifierTraits<T>::Divide(x - lower.x, upper->x - lower.x);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableTransform
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename THook>
+const int InspectableTransformation<T, THook>::MaxPriority;
+template<typename T, typename THook>
+const int InspectableTransformation<T, THook>::MinPriority;
+template<typename T, typename THook>
+const int InspectableTransformation<T, THook>::InvalidPriority;
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>::InspectableTransformation()
+: m_Priority(0),
+m_DefinitionId(0),
+m_ContextMask(xoins::AllContexts),
+m_Enabled(true),
+m_Absorbing(false),
+m_Stored(StoresFunction),
+m_Function(),
+m_Toggle(nullptr)
+{
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>::InspectableTransformation(TTransformFunc func,
+                                                        int priority,
+                                                        bool enabled)
+: m_Priority(priority),
+m_DefinitionId(0),
+m_ContextMask(xoins::AllContexts),
+m_Enabled(enabled),
+m_Absorbing(false),
+m_Stored(StoresFunction),
+m_Function(func),
+m_Toggle(nullptr)
+{
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>::InspectableTransformation(InspectableTransformDefinition<T>& definition,
+                                                        int priority,
+                                                        bool enabled)
+: m_Priority(priority),
+m_DefinitionId(0),
+m_ContextMask(xoins::AllContexts),
+m_Enabled(enabled),
+m_Absorbing(false),
+m_Stored(StoresDefinition),
+m_Definition(&definition),
+m_Toggle(nullptr)
+{
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>::InspectableTransformation(const xoins::TransformOp<T>& op,
+                                                        int priority,
+                                                        bool enabled)
+: m_Priority(priority),
+m_DefinitionId(0),
+m_ContextMask(xoins::AllContexts),
+m_Enabled(enabled),
+m_Absorbing(false),
+m_Stored(StoresOp),
+m_Op(op),
+m_Toggle(nullptr)
+{
+  static_assert(xoins::TransformOpTraits<T>::Enabled, "xoins::TransformOpTraits<T> doesn't enable ops for this type");
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>::InspectableTransformation(const InspectableTransformation& other)
+: THook(other),
+m_Priority(other.m_Priority),
+m_DefinitionId(other.m_DefinitionId),
+m_ContextMask(other.m_ContextMask),
+m_Enabled(other.m_Enabled),
+m_Absorbing(other.m_Absorbing),
+m_Toggle(other.m_Toggle),
+m_Owners(other.m_Owners)
+{
+  StoreCopy(other);
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>& InspectableTransformation<T, THook>::operator=(const InspectableTransformation& other) {
+  if(this == &other)
+    return *this;
+  DestroyStored();
+  StoreCopy(other);
+  m_Priority = other.m_Priority;
+  m_DefinitionId = other.m_DefinitionId;
+  m_ContextMask = other.m_ContextMask;
+  m_Enabled = other.m_Enabled;
+  m_Absorbing = other.m_Absorbing;
+  m_Toggle = other.m_Toggle;
+  return *this;
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>::InspectableTransformation(InspectableTransformation&& other) noexcept
+: THook(other),
+m_Priority(other.m_Priority),
+m_DefinitionId(other.m_DefinitionId),
+m_ContextMask(other.m_ContextMask),
+m_Enabled(other.m_Enabled),
+m_Absorbing(other.m_Absorbing),
+m_Toggle(other.m_Toggle)
+{
+  StoreMove(other);
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>& InspectableTransformation<T, THook>::operator=(InspectableTransformation&& other) noexcept {
+  if(this == &other)
+    return *this;
+  DestroyStored();
+  StoreMove(other);
+  m_Priority = other.m_Priority;
+  m_DefinitionId = other.m_DefinitionId;
+  m_ContextMask = other.m_ContextMask;
+  m_Enabled = other.m_Enabled;
+  m_Absorbing = other.m_Absorbing;
+  m_Toggle = other.m_Toggle;
+  return *this;
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::Set(TTransformFunc func, int priority, bool enabled) {
+  if(m_Stored == StoresFunction) {
+    m_Function = func;
+  } else {
+    DestroyStored();
+    new (&m_Function) TTransformFunc(func);
+    m_Stored = StoresFunction;
+  }
+  m_Priority = priority;
+  m_Enabled = enabled;
+  NotifyOwners(m_ContextMask);
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::Set(const xoins::TransformOp<T>& op, int priority, bool enabled) {
+  static_assert(xoins::TransformOpTraits<T>::Enabled, "xoins::TransformOpTraits<T> doesn't enable ops for this type");
+  DestroyStored();
+  new (&m_Op) xoins::TransformOp<T>(op);
+  m_Stored = StoresOp;
+  m_Priority = priority;
+  m_Enabled = enabled;
+  NotifyOwners(m_ContextMask);
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::Set(InspectableTransformDefinition<T>& definition, int priority, bool enabled) {
+  DestroyStored();
+  // looked up on every call, so Set on the definition reaches every user at once.
+  m_Definition = &definition;
+  m_Stored = StoresDefinition;
+  m_Priority = priority;
+  m_Enabled = enabled;
+  NotifyOwners(m_ContextMask);
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::StoreCopy(const InspectableTransformation& other) {
+  m_Stored = other.m_Stored;
+  if(m_Stored == StoresFunction)
+    new (&m_Function) TTransformFunc(other.m_Function);
+  else if(m_Stored == StoresOp)
+    new (&m_Op) xoins::TransformOp<T>(other.m_Op);
+  else
+    m_Definition = other.m_Definition;
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::StoreMove(InspectableTransformation& other) {
+  m_Stored = other.m_Stored;
+  if(m_Stored == StoresFunction)
+    new (&m_Function) TTransformFunc(std::move(other.m_Function));
+  else if(m_Stored == StoresOp)
+    new (&m_Op) xoins::TransformOp<T>(other.m_Op);
+  else
+    m_Definition = other.m_Definition;
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::DestroyStored() {
+  typedef xoins::TransformOp<T> TOp;
+  if(m_Stored == StoresFunction)
+    m_Function.~TTransformFunc();
+  else if(m_Stored == StoresOp)
+    m_Op.~TOp();
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::SetPriority(int priority) {
+  m_Priority = priority;
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::Enable() {
+  if(m_Enabled)
+    return;
+  m_Enabled = true;
+  NotifyOwners(m_ContextMask);
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::Disable() {
+  if(!m_Enabled)
+    return;
+  m_Enabled = false;
+  NotifyOwners(m_ContextMask);
+}
+
+template<typename T, typename THook>
+bool InspectableTransformation<T, THook>::IsEnabled() const {
+  return m_Enabled;
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::SetToggle(InspectableToggle* toggle) {
+  m_Toggle = toggle;
+  NotifyOwners(m_ContextMask);
+}
+
+template<typename T, typename THook>
+InspectableToggle* InspectableTransformation<T, THook>::GetToggle() const {
+  return m_Toggle;
+}
+
+template<typename T, typename THook>
+bool InspectableTransformation<T, THook>::IsActive() const {
+  return m_Enabled && (m_Toggle == nullptr || m_Toggle->IsEnabled());
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::SetContextMask(xoins::ContextMask contextMask) {
+  xoins::ContextMask affected = m_ContextMask | contextMask;
+  m_ContextMask = contextMask;
+  NotifyOwners(affected);
+}
+
+template<typename T, typename THook>
+xoins::ContextMask InspectableTransformation<T, THook>::GetContextMask() const {
+  return m_ContextMask;
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::SetAbsorbing(bool absorbing) {
+  if(m_Absorbing == absorbing)
+    return;
+  m_Absorbing = absorbing;
+  NotifyOwners(m_ContextMask);
+}
+
+template<typename T, typename THook>
+bool InspectableTransformation<T, THook>::IsAbsorbing() const {
+  return m_Absorbing;
+}
+
+template <typename T, typename THook>
+int InspectableTransformation<T, THook>::GetPriority() const {
+  return m_Priority;
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::operator ()(T& input) {
+  if(m_Stored == StoresFunction)
+    m_Function(input);
+  else if(m_Stored == StoresOp)
+    xoins::internal::ApplyTransformOp(m_Op, input, std::integral_constant<bool, xoins::TransformOpTraits<T>::Enabled>());
+  else
+    InvokeDefinition(m_Definition, input);
+}
+
+template<typename T, typename THook>
+const std::function<void(T&)>& InspectableTransformation<T, THook>::GetTransformFunc() const {
+  static const TTransformFunc none;
+  if(m_Stored == StoresFunction)
+    return m_Function;
+  return m_Stored == StoresDefinition ? m_Definition->GetTransformFunc() : none;
+}
+
+template<typename T, typename THook>
+const xoins::TransformOp<T>& InspectableTransformation<T, THook>::GetOp() const {
+  static const xoins::TransformOp<T> none = xoins::internal::MakeTransformOp(xoins::TransformOpNone, T(), T());
+  return m_Stored == StoresOp ? m_Op : none;
+}
+
+template<typename T, typename THook>
+bool InspectableTransformation<T, THook>::HasTransform() const {
+  if(m_Stored == StoresFunction)
+    return static_cast<bool>(m_Function);
+  return m_Stored == StoresDefinition || m_Op.kind != xoins::TransformOpNone;
+}
+
+template<typename T, typename THook>
+InspectableTransformation<T, THook>::~InspectableTransformation() {
+  m_Owners.NotifyDestroyed(this);
+  DestroyStored();
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::NotifyOwners(xoins::ContextMask contexts) {
+  m_Owners.Notify(this, contexts);
+}
+
+template<typename T, typename THook>
+bool InspectableTransformation<T, THook>::GetInvoker(void (*&outInvoke)(const void*, T&), const void*& outContext) const {
+  if(m_Stored == StoresOp) {
+    outInvoke = nullptr;
+    outContext = nullptr;
+    return true;
+  }
+  if(m_Stored == StoresDefinition) {
+    outInvoke = &InvokeDefinition;
+    outContext = m_Definition;
+    return true;
+  }
+  outInvoke = &InvokeFunction;
+  outContext = &m_Function;
+  return static_cast<bool>(m_Function);
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::InvokeFunction(const void* function, T& value) {
+  (*static_cast<const TTransformFunc*>(function))(value);
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::InvokeDefinition(const void* definition, T& value) {
+  const TTransformFunc& func = static_cast<const InspectableTransformDefinition<T>*>(definition)->GetTransformFunc();
+  if(func)
+    func(value);
+}
+
+template<typename T, typename THook>
+void InspectableTransformation<T, THook>::SetDefinitionId(unsigned definitionId) {
+  m_DefinitionId = definitionId;
+}
+
+template<typename T, typename THook>
+unsigned InspectableTransformation<T, THook>::GetDefinitionId() const {
+  return m_DefinitionId;
+}
+
+template<typename T, typename THook>
+InspectableTransformDefinition<T>* InspectableTransformation<T, THook>::GetDefinition() const {
+  return m_Stored == StoresDefinition ? m_Definition : nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableTransformDefinition
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+InspectableTransformDefinition<T>::InspectableTransformDefinition(TTransformFunc func)
+: m_Function(func)
+{
+}
+
+template<typename T>
+void InspectableTransformDefinition<T>::Set(TTransformFunc func) {
+  m_Function = func;
+  m_Dependents.NotifyChanged(this);
+}
+
+template<typename T>
+const typename InspectableTransformDefinition<T>::TTransformFunc& InspectableTransformDefinition<T>::GetTransformFunc() const {
+  return m_Function;
+}
+
+template<typename T>
+size_t InspectableTransformDefinition<T>::GetDependentCount() const {
+  return m_Dependents.GetCount();
+}
+
+inline void xoins::internal::Dependents::Add(void* inspectable, Callback changed) {
+  Dependent& dependent = m_Dependents[inspectable];
+  dependent.changed = changed;
+  ++dependent.count;
+}
+
+inline void xoins::internal::Dependents::Remove(void* inspectable) {
+  auto found = m_Dependents.find(inspectable);
+  if(found != m_Dependents.end() && --found->second.count == 0)
+    m_Dependents.erase(found);
+}
+
+inline void xoins::internal::Dependents::NotifyChanged(const void* shared) {
+  for(auto& dependent : m_Dependents)
+    dependent.second.changed(dependent.first, shared);
+}
+
+inline size_t xoins::internal::Dependents::GetCount() const {
+  return m_Dependents.size();
+}
+
+inline xoins::internal::TransformOwners::TransformOwners() {
+  m_First.inspectable = nullptr;
+  m_First.callback = nullptr;
+}
+
+inline xoins::internal::TransformOwners::TransformOwners(const TransformOwners&) {
+  m_First.inspectable = nullptr;
+  m_First.callback = nullptr;
+}
+
+inline xoins::internal::TransformOwners& xoins::internal::TransformOwners::operator=(const TransformOwners&) {
+  return *this;
+}
+
+inline xoins::internal::TransformOwners::~TransformOwners() {
+  if(IsOverflowing())
+    delete static_cast<Overflow*>(m_First.inspectable);
+}
+
+inline void xoins::internal::TransformOwners::Add(void* inspectable, Callback callback) {
+  Owner owner = { inspectable, callback };
+  if(m_First.inspectable == nullptr) {
+    m_First = owner;
+    return;
+  }
+  if(!IsOverflowing()) {
+    Overflow* owners = new Overflow(1, m_First);
+    m_First.inspectable = owners;
+    m_First.callback = nullptr;
+  }
+  static_cast<Overflow*>(m_First.inspectable)->push_back(owner);
+}
+
+inline void xoins::internal::TransformOwners::Remove(void* inspectable) {
+  if(!IsOverflowing()) {
+    if(m_First.inspectable == inspectable)
+      m_First.inspectable = nullptr;
+    return;
+  }
+  Overflow* owners = static_cast<Overflow*>(m_First.inspectable);
+  for(size_t i = 0; i < owners->size(); ++i) {
+    if((*owners)[i].inspectable == inspectable) {
+      owners->erase(owners->begin() + i);
+      break;
+    }
+  }
+  if(owners->size() == 1) { // back to one, which fits inline
+    m_First = owners->front();
+    delete owners;
+  }
+}
+
+inline bool xoins::internal::TransformOwners::Contains(const void* inspectable) const {
+  if(!IsOverflowing())
+    return m_First.inspectable == inspectable;
+  for(const Owner& owner : *static_cast<const Overflow*>(m_First.inspectable))
+    if(owner.inspectable == inspectable)
+      return true;
+  return false;
+}
+
+inline void xoins::internal::TransformOwners::Notify(void* transformation, ContextMask contexts) const {
+  if(!IsOverflowing()) {
+    if(m_First.inspectable)
+      m_First.callback(m_First.inspectable, transformation, Changed, contexts);
+    return;
+  }
+  for(const Owner& owner : *static_cast<const Overflow*>(m_First.inspectable))
+    owner.callback(owner.inspectable, transformation, Changed, contexts);
+}
+
+inline void xoins::internal::TransformOwners::NotifyDestroyed(void* transformation) {
+  Owner first = m_First;
+  m_First.inspectable = nullptr;
+  m_First.callback = nullptr;
+  if(first.callback) {
+    if(first.inspectable)
+      first.callback(first.inspectable, transformation, Destroyed, AllContexts);
+    return;
+  }
+  std::unique_ptr<Overflow> owners(static_cast<Overflow*>(first.inspectable));
+  if(owners) {
+    for(const Owner& owner : *owners)
+      owner.callback(owner.inspectable, transformation, Destroyed, AllContexts);
+  }
+}
+
+inline void xoins::internal::TransformOwners::TakeOver(TransformOwners& other) {
+  if(IsOverflowing())
+    delete static_cast<Overflow*>(m_First.inspectable);
+  m_First = other.m_First;
+  other.m_First.inspectable = nullptr;
+  other.m_First.callback = nullptr;
+}
+
+inline bool xoins::internal::TransformOwners::IsOverflowing() const {
+  return m_First.callback == nullptr && m_First.inspectable != nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableToggle
+//////////////////////////////////////////////////////////////////////////////////////////
+inline InspectableToggle::InspectableToggle(bool enabled)
+: m_Enabled(enabled)
+{
+}
+
+inline void InspectableToggle::Enable() {
+  Set(true);
+}
+
+inline void InspectableToggle::Disable() {
+  Set(false);
+}
+
+inline void InspectableToggle::Set(bool enabled) {
+  if(m_Enabled == enabled)
+    return;
+  m_Enabled = enabled;
+  m_Dependents.NotifyChanged(this);
+}
+
+inline bool InspectableToggle::IsEnabled() const {
+  return m_Enabled;
+}
+
+inline size_t InspectableToggle::GetDependentCount() const {
+  return m_Dependents.GetCount();
+}
+
+inline std::vector<xoins::internal::DirtyEntry>& xoins::internal::DirtyList() {
+  static std::vector<DirtyEntry> list;
+  return list;
+}
+
+template<typename E>
+std::vector<E>& xoins::internal::Scratch() {
+  static std::vector<E> scratch;
+  return scratch;
+}
+
+inline unsigned& xoins::internal::BatchDepth() {
+  static unsigned depth = 0;
+  return depth;
+}
+
+inline void xoins::UpdateDirtyInspectables() {
+  if(internal::BatchDepth())
+    return;
+  std::vector<internal::DirtyEntry>& list = internal::DirtyList();
+  // by index, since updating can mark more Inspectables dirty.
+  for(size_t i = 0; i < list.size(); ++i) {
+    internal::DirtyEntry entry = list[i];
+    if(entry.inspectable)
+      entry.update(entry.inspectable);
+  }
+  list.clear();
+}
+
+inline size_t xoins::GetDirtyInspectableCount() {
+  size_t count = 0;
+  for(const internal::DirtyEntry& entry : internal::DirtyList())
+    count += entry.inspectable ? 1 : 0;
+  return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableBatch
+//////////////////////////////////////////////////////////////////////////////////////////
+inline InspectableBatch::InspectableBatch() {
+  ++xoins::internal::BatchDepth();
+}
+
+inline InspectableBatch::~InspectableBatch() {
+  if(--xoins::internal::BatchDepth() == 0)
+    xoins::UpdateDirtyInspectables();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Inspectable
+//////////////////////////////////////////////////////////////////////////////////////////
+namespace xoins {
+  namespace internal {
+    // The side table holding the listeners of every Inspectable<T, TPolicy> that has any.
+    // Like the rest of Inspectable, it is not thread safe.
+    template<typename TListeners>
+    std::unordered_map<const void*, TListeners>& ListenerTable() {
+      static std::unordered_map<const void*, TListeners> table;
+      return table;
+    }
+
+    // The same for the context values of Inspectables (see Inspectable::GetContextValue).
+    template<typename TContextValues>
+    std::unordered_map<const void*, TContextValues>& ContextValueTable() {
+      static std::unordered_map<const void*, TContextValues> table;
+      return table;
+    }
+
+    template<typename TTransform>
+    bool TransformationPredicate(TTransform* a, TTransform* b) {
+      return a->GetPriority() > b->GetPriority();
+    }
+
+    // runs every enabled transformation in a list, in order, up to the first absorbing
+    // one. Lists that keep their own hot data (HotColdList) get an overload.
+    template<typename TList, typename T>
+    void RunTransformations(TList& transformations, T& value) {
+      for(auto transform : transformations) {
+        if(!transform->IsActive())
+          continue;
+        // note: having no target is supported, since it can be set after adding
+        // the transform to the inspectable.
+        if(transform->HasTransform())
+          (*transform)(value);
+        if(transform->IsAbsorbing())
+          break;
+      }
+    }
+
+    template<typename E, typename T>
+    void RunTransformations(HotColdList<E>& transformations, T& value) {
+      transformations.Run(value);
+    }
+
+    // for when one of a list's transformations changed. Only lists that cache what they
+    // read from their transformations (HotColdList) have anything to do.
+    template<typename TList>
+    void MarkListStale(TList&) {
+    }
+
+    template<typename E>
+    void MarkListStale(HotColdList<E>& transformations) {
+      transformations.MarkStale();
+    }
+
+    // the same for the transformations applying under contextMask.
+    template<typename TList, typename T>
+    void RunTransformations(TList& transformations, T& value, ContextMask contextMask) {
+      for(auto transform : transformations) {
+        if(!(transform->GetContextMask() & contextMask) || !transform->IsActive())
+          continue;
+        if(transform->HasTransform())
+          (*transform)(value);
+        if(transform->IsAbsorbing())
+          break;
+      }
+    }
+  }
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>::Inspectable()
+: m_Identity(),
+m_LastValue(),
+m_Flags(0),
+m_DirtyIndex(0)
+{
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>::Inspectable(T identity)
+: m_Identity(identity),
+m_LastValue(identity),
+m_Flags(0),
+m_DirtyIndex(0)
+{
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>::Inspectable(const Inspectable<T, TPolicy>& other)
+: m_Identity(other.m_Identity),
+m_LastValue(other.m_LastValue),
+m_Transformations(other.m_Transformations),
+m_Flags(other.m_Flags & ParallelDispatch),
+m_DirtyIndex(0)
+{
+  CopyListenersFrom(other);
+  for(auto transformation : m_Transformations)
+    Subscribe(transformation);
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>::~Inspectable() {
+  xoins::internal::AssertNotInAnyThreadListener();
+  for(TObserver* observer = TObserver::s_Head; observer; observer = observer->m_Next)
+    observer->OnDestroyed(this);
+  UnsubscribeAll();
+  if(m_Flags & DirtyListed) // updated or not, the entry would still reach this.
+    xoins::internal::DirtyList()[m_DirtyIndex].inspectable = nullptr;
+  if(m_Flags & HasListeners)
+    xoins::internal::ListenerTable<Listeners>().erase(this);
+  DropContextValues();
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::operator=(const Inspectable<T, TPolicy>& other) {
+  if(this == &other)
+    return *this;
+  CopyListenersFrom(other);
+  SetParallelDispatch(other.IsParallelDispatch());
+  NotifyBeforeChange();
+  UnsubscribeAll();
+  DropContextValues();
+  m_Identity = other.m_Identity;
+  m_LastValue = other.m_LastValue;
+  m_Transformations = other.m_Transformations;
+  for(auto transformation : m_Transformations)
+    Subscribe(transformation);
+  NotifyChanged();
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddTransformation(TTransform& outTransformation,
+                                                                    TTransformFunc func,
+                                                                    int priority,
+                                                                    bool enabled,
+                                                                    bool andUpdate) {
+  outTransformation.Set(func, priority, enabled);
+  return AddTransformation(&outTransformation, andUpdate);
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddTransformation(TTransform* transformation,
+                                                                    bool andUpdate) {
+  if(transformation == nullptr) // we don't store null transformations.
+    return *this;
+  NotifyBeforeChange();
+  m_Transformations.Insert(transformation, xoins::internal::TransformationPredicate<TTransform>);
+  Subscribe(transformation);
+  bool affected = InvalidateAffected(transformation, transformation->GetContextMask());
+  NotifyChanged();
+  if(andUpdate && affected)
+    ForceUpdate();
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddTransformationUnique(TTransform* transformation,
+                                                                          bool andUpdate) {
+  if(transformation == nullptr) // we don't store null transformations.
+    return *this;
+  if(!m_Transformations.Contains(transformation)) {
+    NotifyBeforeChange();
+    m_Transformations.Insert(transformation, xoins::internal::TransformationPredicate<TTransform>);
+    Subscribe(transformation);
+    bool affected = InvalidateAffected(transformation, transformation->GetContextMask());
+    NotifyChanged();
+    if(andUpdate && affected) // only update when a transformation was actually added.
+      ForceUpdate();
+  }
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::RemoveTransformation(TTransform* transformation,
+                                                   bool andUpdate) {
+  if(transformation == nullptr) // we don't store null transformations.
+    return;
+  if(TObserver::s_Head && transformation->m_Owners.Contains(this)) // it's attached here
+    NotifyBeforeChange();
+  // asked before removing it, while its place still says what it was shadowed by.
+  xoins::ContextMask shadowed = 0;
+  bool affected = !IsShadowed(transformation, shadowed);
+  if(!m_Transformations.Remove(transformation))
+    return;
+  Unsubscribe(transformation);
+  InvalidateContextValues(transformation->GetContextMask(), shadowed);
+  NotifyChanged();
+  if(andUpdate && affected) // only update when a transformation was actually removed.
+    ForceUpdate();
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddTransformations(TTransform* const* begin,
+                                                                     TTransform* const* end,
+                                                                     bool andUpdate) {
+  NotifyBeforeChange();
+  for(TTransform* const* added = begin; added != end; ++added) {
+    if(*added == nullptr) // we don't store null transformations.
+      continue;
+    m_Transformations.Insert(*added, xoins::internal::TransformationPredicate<TTransform>);
+    Subscribe(*added);
+  }
+  bool affected = false;
+  if(m_Flags & MayAbsorb) {
+    std::vector<TTransform*> added;
+    added.swap(xoins::internal::Scratch<TTransform*>());
+    added.assign(begin, end);
+    std::sort(added.begin(), added.end());
+    affected = InvalidateAffected([&added](TTransform* transformation) {
+      return std::binary_search(added.begin(), added.end(), transformation);
+    });
+    added.clear();
+    added.swap(xoins::internal::Scratch<TTransform*>());
+  } else {
+    for(; begin != end; ++begin) {
+      if(*begin == nullptr)
+        continue;
+      InvalidateContextValues((*begin)->GetContextMask());
+      affected = true;
+    }
+  }
+  FinishChange(andUpdate && affected);
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::RemoveTransformations(TTransform* const* begin,
+                                                    TTransform* const* end,
+                                                    bool andUpdate) {
+  if(end - begin == 1) {
+    TTransform* transformation = *begin;
+    if(transformation == nullptr || !m_Transformations.Contains(transformation))
+      return;
+    NotifyBeforeChange();
+    bool affected = InvalidateAffected(transformation, transformation->GetContextMask());
+    m_Transformations.Remove(transformation);
+    Unsubscribe(transformation);
+    FinishChange(andUpdate && affected);
+    return;
+  }
+  // the sorted transformations to remove, each once with how many of it to remove, then
+  // the ones staying. Removing each one from the list would search and shift it once per
+  // transformation.
+  typedef std::pair<TTransform*, size_t> TRemoval;
+  std::vector<TRemoval> removals;
+  std::vector<TTransform*> kept;
+  removals.swap(xoins::internal::Scratch<TRemoval>());
+  kept.swap(xoins::internal::Scratch<TTransform*>());
+  for(; begin != end; ++begin)
+    if(*begin)
+      removals.push_back(TRemoval(*begin, 1));
+  std::sort(removals.begin(), removals.end());
+  size_t unique = 0;
+  for(size_t i = 0; i < removals.size(); ++i) {
+    if(unique && removals[unique - 1].first == removals[i].first)
+      ++removals[unique - 1].second;
+    else
+      removals[unique++] = removals[i];
+  }
+  removals.resize(unique);
+  auto find = [&removals](TTransform* transformation) {
+    auto found = std::lower_bound(removals.begin(), removals.end(), TRemoval(transformation, 0));
+    return found != removals.end() && found->first == transformation ? &*found : nullptr;
+  };
+
+  bool removed = false;
+  for(auto transformation : m_Transformations)
+    removed = removed || find(transformation) != nullptr;
+  bool affected = false;
+  if(removed) { // only notify and update when a transformation is actually removed.
+    NotifyBeforeChange();
+    // the survivors are already in order, so appending them back keeps it. Those removed
+    // are left as nulls, so InvalidateAffected can tell them apart by position.
+    for(auto transformation : m_Transformations) {
+      TRemoval* removal = find(transformation);
+      if(removal && removal->second) {
+        --removal->second;
+        Unsubscribe(transformation);
+        kept.push_back(nullptr);
+      } else {
+        kept.push_back(transformation);
+      }
+    }
+    size_t position = 0;
+    affected = InvalidateAffected([&kept, &position](TTransform*) {
+      return kept[position++] == nullptr;
+    });
+    m_Transformations.Clear();
+    for(auto transformation : kept)
+      if(transformation)
+        m_Transformations.Add(transformation);
+  }
+  removals.clear();
+  kept.clear();
+  removals.swap(xoins::internal::Scratch<TRemoval>());
+  kept.swap(xoins::internal::Scratch<TTransform*>());
+  if(removed)
+    FinishChange(andUpdate && affected);
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::ReplaceTransformation(TTransform* from, TTransform* to) {
+  if(from == nullptr || to == nullptr || !m_Transformations.Contains(from))
+    return false;
+  NotifyBeforeChange();
+  m_Transformations.Replace(from, to);
+  Unsubscribe(from);
+  Subscribe(to);
+  if(from->GetContextMask() != to->GetContextMask())
+    InvalidateContextValues(from->GetContextMask() | to->GetContextMask());
+  NotifyChanged();
+  return true;
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::IsShadowed(const TTransform* transformation) const {
+  xoins::ContextMask shadowed;
+  return IsShadowed(transformation, shadowed);
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::ContainsTransformation(TTransform* transformation) const {
+  if(!transformation) // we don't store null transformations.
+    return false;
+  return m_Transformations.Contains(transformation);
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddOnIdentityChanged(TValueChangedFunc* f) {
+  if(f && *f) { // we don't store null or targetless functions
+    unsigned generation;
+    GetListeners().identityChanged.Connect(nullptr, f, xoins::MainThreadOnly, generation);
+  }
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddOnIdentityChangedUnique(TValueChangedFunc* f) {
+  if(f && *f && !ContainsOnIdentityChanged(f)) // we don't store null or targetless functions
+    AddOnIdentityChanged(f);
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::RemoveOnIdentityChanged(TValueChangedFunc* f) {
+  Listeners* listeners = FindListeners();
+  if(f && *f && listeners) { // we don't store null or targetless functions
+    if(listeners->identityChanged.DisconnectExternal(f))
+      ReleaseListenersIfEmpty();
+  }
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::ContainsOnIdentityChanged(TValueChangedFunc* f) const {
+  Listeners* listeners = FindListeners();
+  if(f && *f && listeners) // we don't store null or targetless functions
+    return listeners->identityChanged.ContainsExternal(f);
+  return false;
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddOnValueChanged(TValueChangedFunc* f) {
+  if(f && *f) { // we don't store null or targetless functions
+    unsigned generation;
+    GetListeners().valueChanged.Connect(nullptr, f, xoins::MainThreadOnly, generation);
+  }
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>& Inspectable<T, TPolicy>::AddOnValueChangedUnique(TValueChangedFunc* f) {
+  if(f && *f && !ContainsOnValueChanged(f)) // we don't store null or targetless functions
+    AddOnValueChanged(f);
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::RemoveOnValueChanged(TValueChangedFunc* f) {
+  Listeners* listeners = FindListeners();
+  if(f && *f && listeners) { // we don't store null or targetless functions
+    if(listeners->valueChanged.DisconnectExternal(f))
+      ReleaseListenersIfEmpty();
+  }
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::ContainsOnValueChanged(TValueChangedFunc* f) const {
+  Listeners* listeners = FindListeners();
+  if(f && *f && listeners) // we don't store null or targetless functions
+    return listeners->valueChanged.ContainsExternal(f);
+  return false;
+}
+
+template<typename T, typename TPolicy>
+InspectableConnection Inspectable<T, TPolicy>::ConnectOnIdentityChanged(TValueChangedFunc func,
+                                                                        xoins::ListenerThreading threading) {
+  if(!func) // we don't store targetless functions
+    return InspectableConnection();
+  unsigned generation;
+  unsigned index = GetListeners().identityChanged.Connect(func, nullptr, threading, generation);
+  return InspectableConnection(index, generation, true);
+}
+
+template<typename T, typename TPolicy>
+InspectableConnection Inspectable<T, TPolicy>::ConnectOnValueChanged(TValueChangedFunc func,
+                                                                     xoins::ListenerThreading threading) {
+  if(!func) // we don't store targetless functions
+    return InspectableConnection();
+  unsigned generation;
+  unsigned index = GetListeners().valueChanged.Connect(func, nullptr, threading, generation);
+  return InspectableConnection(index, generation, false);
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::Disconnect(InspectableConnection connection) {
+  xoins::internal::AssertNotInAnyThreadListener();
+  Listeners* listeners = FindListeners();
+  if(!listeners || !connection.IsValid())
+    return false;
+  TListenerSlots& slots = connection.m_IdentityChanged ? listeners->identityChanged : listeners->valueChanged;
+  if(!slots.Disconnect(connection.m_Index, connection.m_Generation))
+    return false;
+  ReleaseListenersIfEmpty();
+  return true;
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::IsConnected(InspectableConnection connection) const {
+  Listeners* listeners = FindListeners();
+  if(!listeners || !connection.IsValid())
+    return false;
+  const TListenerSlots& slots = connection.m_IdentityChanged ? listeners->identityChanged : listeners->valueChanged;
+  return slots.IsConnected(connection.m_Index, connection.m_Generation);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::ForceUpdate()
+{
+  xoins::internal::AssertNotInAnyThreadListener();
+  if(xoins::internal::BatchDepth()) {
+    MarkDirty();
+    return;
+  }
+  m_Flags &= ~Dirty; // still listed in xoins::internal::DirtyList, but skipped there.
+  T value = m_Identity;
+  // do a copy here so our m_LastValue can be correct for the duration of all callbacks.
+  T lastValue = m_LastValue;
+
+  xoins::internal::RunTransformations(m_Transformations, value);
+
+  bool changed = lastValue != value;
+  if(changed)
+    NotifyBeforeChange();
+  m_LastValue = value;
+  if(!changed)
+    return;
+  NotifyChanged();
+  if(m_Flags & HasListeners) {
+    // having no target here is not supported since it could not be updated later.
+    // because of that, no check for unset target is required here (it's done when adding)
+    FindListeners()->valueChanged.Dispatch(this, lastValue, value, (m_Flags & ParallelDispatch) != 0);
+    ReleaseListenersIfEmpty(); // in case listeners disconnected during the dispatch.
+  }
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::SetIdentity(const T& value, bool andUpdate) {
+  if(m_Identity != value) {
+    T last = m_Identity;
+    NotifyBeforeChange();
+    m_Identity = value;
+    DropContextValues();
+    NotifyChanged();
+    if(andUpdate)
+      ForceUpdate();
+    if(m_Flags & HasListeners) {
+      FindListeners()->identityChanged.Dispatch(this, last, m_Identity, (m_Flags & ParallelDispatch) != 0);
+      ReleaseListenersIfEmpty(); // in case listeners disconnected during the dispatch.
+    }
+  }
+}
+
+template<typename T, typename TPolicy>
+const T& Inspectable<T, TPolicy>::GetIdentity() const {
+  return m_Identity;
+}
+
+template<typename T, typename TPolicy>
+const T& Inspectable<T, TPolicy>::GetValue(bool andForceUpdate) {
+  if(andForceUpdate)
+    ForceUpdate();
+  return m_LastValue;
+}
+
+template<typename T, typename TPolicy>
+const T& Inspectable<T, TPolicy>::GetCachedValue() const {
+  return m_LastValue;
+}
+
+template<typename T, typename TPolicy>
+T Inspectable<T, TPolicy>::GetContextValue(xoins::ContextMask contextMask) {
+  xoins::internal::AssertNotInAnyThreadListener(); // it caches what it computes
+  auto& table = xoins::internal::ContextValueTable<ContextValues>();
+  if(m_Flags & HasContextValues) {
+    for(const ContextValue& cached : table[this])
+      if(cached.mask == contextMask && cached.valid)
+        return cached.value;
+  }
+  T value = m_Identity;
+  // computed before touching the table, in case a transformation asks for a context too.
+  xoins::internal::RunTransformations(m_Transformations, value, contextMask);
+  m_Flags |= HasContextValues;
+  ContextValues& values = table[this];
+  for(ContextValue& cached : values) {
+    if(cached.mask == contextMask) {
+      cached.valid = true;
+      cached.value = value;
+      return value;
+    }
+  }
+  ContextValue cached = { contextMask, true, value };
+  values.push_back(cached);
+  return value;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::RestoreState(const T& identity, const T& value) {
+  NotifyBeforeChange();
+  m_Identity = identity;
+  m_LastValue = value;
+  DropContextValues();
+  NotifyChanged();
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::ReplicateState(const T& identity, const T& value) {
+  T lastIdentity = m_Identity;
+  T lastValue = m_LastValue;
+  RestoreState(identity, value);
+  // in the order SetIdentity(identity, true) calls them.
+  if((m_Flags & HasListeners) && lastValue != value) {
+    FindListeners()->valueChanged.Dispatch(this, lastValue, value, (m_Flags & ParallelDispatch) != 0);
+    ReleaseListenersIfEmpty(); // in case listeners disconnected during the dispatch.
+  }
+  if((m_Flags & HasListeners) && lastIdentity != identity) {
+    FindListeners()->identityChanged.Dispatch(this, lastIdentity, identity, (m_Flags & ParallelDispatch) != 0);
+    ReleaseListenersIfEmpty();
+  }
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::RestoreTransformations(TTransform* const* begin, TTransform* const* end) {
+  NotifyBeforeChange();
+  UnsubscribeAll();
+  InvalidateContextValues(xoins::AllContexts);
+  m_Transformations.Clear();
+  for(; begin != end; ++begin) {
+    m_Transformations.Add(*begin);
+    Subscribe(*begin);
+  }
+  NotifyChanged();
+}
+
+template<typename T, typename TPolicy>
+const typename Inspectable<T, TPolicy>::TTransformList& Inspectable<T, TPolicy>::GetTransformations() const {
+  return m_Transformations;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::SetParallelDispatch(bool enabled) {
+  if(enabled)
+    m_Flags |= ParallelDispatch;
+  else
+    m_Flags &= ~ParallelDispatch;
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::IsParallelDispatch() const {
+  return (m_Flags & ParallelDispatch) != 0;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::MarkDirty() {
+  xoins::internal::AssertNotInAnyThreadListener();
+  if(m_Flags & Dirty)
+    return;
+  m_Flags |= Dirty;
+  if(m_Flags & DirtyListed) // still listed from before a ForceUpdate, so reuse it.
+    return;
+  m_Flags |= DirtyListed;
+  std::vector<xoins::internal::DirtyEntry>& list = xoins::internal::DirtyList();
+  xoins::internal::DirtyEntry entry = { this, &UpdateDirtyThunk };
+  m_DirtyIndex = (uint32_t)list.size();
+  list.push_back(entry);
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::IsDirty() const {
+  return (m_Flags & Dirty) != 0;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::Subscribe(TTransform* transformation) {
+  transformation->m_Owners.Add(this, &TransformationThunk);
+  if(transformation->IsAbsorbing())
+    m_Flags |= MayAbsorb;
+  if(InspectableTransformDefinition<T>* definition = transformation->GetDefinition())
+    definition->m_Dependents.Add(this, &SharedChangedThunk);
+  if(InspectableToggle* toggle = transformation->GetToggle())
+    toggle->m_Dependents.Add(this, &SharedChangedThunk);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::Unsubscribe(TTransform* transformation) {
+  transformation->m_Owners.Remove(this);
+  UnsubscribeShared(transformation);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::UnsubscribeShared(TTransform* transformation) {
+  if(InspectableTransformDefinition<T>* definition = transformation->GetDefinition())
+    definition->m_Dependents.Remove(this);
+  if(InspectableToggle* toggle = transformation->GetToggle())
+    toggle->m_Dependents.Remove(this);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::UnsubscribeAll() {
+  for(auto transformation : m_Transformations)
+    Unsubscribe(transformation);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::MoveTransformation(TTransform* from, TTransform* to) {
+  // 'to' has from's definition and toggle, so what subscribed to them still counts it.
+  if(m_Transformations.Replace(from, to))
+    to->m_Owners.TakeOver(from->m_Owners);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::OnTransformationChanged(TTransform* transformation, xoins::ContextMask contexts) {
+  if(transformation->IsAbsorbing())
+    m_Flags |= MayAbsorb;
+  // a shadowed transformation doesn't run, so a HotColdList's bitmask can't change either.
+  if(InvalidateAffected(transformation, contexts))
+    xoins::internal::MarkListStale(m_Transformations);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::OnTransformationDestroyed(TTransform* transformation) {
+  // it has already forgotten its owners, so only the definition and toggle are left.
+  NotifyBeforeChange();
+  InvalidateAffected(transformation, transformation->GetContextMask());
+  m_Transformations.Remove(transformation);
+  UnsubscribeShared(transformation);
+  NotifyChanged();
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::OnSharedChanged(const void* shared) {
+  bool affected = InvalidateAffected([shared](TTransform* transformation) {
+    return transformation->GetDefinition() == shared || transformation->GetToggle() == shared;
+  });
+  if(!affected) // every user is shadowed, so nothing to update.
+    return;
+  xoins::internal::MarkListStale(m_Transformations);
+  MarkDirty();
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::TransformationThunk(void* inspectable,
+                                                  void* transformation,
+                                                  xoins::internal::TransformOwners::Event event,
+                                                  xoins::ContextMask contexts) {
+  Inspectable<T, TPolicy>* self = static_cast<Inspectable<T, TPolicy>*>(inspectable);
+  if(event == xoins::internal::TransformOwners::Destroyed)
+    self->OnTransformationDestroyed(static_cast<TTransform*>(transformation));
+  else
+    self->OnTransformationChanged(static_cast<TTransform*>(transformation), contexts);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::SharedChangedThunk(void* inspectable, const void* shared) {
+  static_cast<Inspectable<T, TPolicy>*>(inspectable)->OnSharedChanged(shared);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::UpdateDirtyThunk(void* inspectable) {
+  Inspectable<T, TPolicy>* self = static_cast<Inspectable<T, TPolicy>*>(inspectable);
+  self->m_Flags &= ~DirtyListed; // the list is cleared once every entry has been seen.
+  if(self->m_Flags & Dirty)
+    self->ForceUpdate();
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::InvalidateContextValues(xoins::ContextMask contextMask) {
+  InvalidateContextValues(contextMask, 0);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::InvalidateContextValues(xoins::ContextMask contextMask, xoins::ContextMask shadowed) {
+  if(!(m_Flags & HasContextValues))
+    return;
+  for(ContextValue& cached : xoins::internal::ContextValueTable<ContextValues>()[this])
+    if((cached.mask & contextMask) && !(cached.mask & shadowed))
+      cached.valid = false;
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::IsShadowed(const TTransform* transformation, xoins::ContextMask& outShadowed) const {
+  outShadowed = 0;
+  if(!(m_Flags & MayAbsorb))
+    return false;
+  bool shadowed = false;
+  for(auto other : m_Transformations) {
+    if(other == transformation)
+      break;
+    if(other->IsAbsorbing() && other->IsActive()) {
+      shadowed = true;
+      outShadowed |= other->GetContextMask();
+    }
+  }
+  return shadowed;
+}
+
+template<typename T, typename TPolicy>
+bool Inspectable<T, TPolicy>::InvalidateAffected(const TTransform* transformation, xoins::ContextMask contexts) {
+  xoins::ContextMask shadowed = 0;
+  bool affected = !IsShadowed(transformation, shadowed);
+  InvalidateContextValues(contexts, shadowed);
+  return affected;
+}
+
+template<typename T, typename TPolicy>
+template<typename TAffected>
+bool Inspectable<T, TPolicy>::InvalidateAffected(TAffected affected) {
+  if(!(m_Flags & (MayAbsorb | HasContextValues)))
+    return true;
+  bool unshadowed = false;
+  bool absorbed = false;
+  xoins::ContextMask shadowed = 0;
+  for(auto transformation : m_Transformations) {
+    if(affected(transformation)) {
+      unshadowed = unshadowed || !absorbed;
+      InvalidateContextValues(transformation->GetContextMask(), shadowed);
+    }
+    if(transformation->IsAbsorbing() && transformation->IsActive()) {
+      absorbed = true;
+      shadowed |= transformation->GetContextMask();
+    }
+  }
+  return unshadowed;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::DropContextValues() {
+  if(!(m_Flags & HasContextValues))
+    return;
+  xoins::internal::ContextValueTable<ContextValues>().erase(this);
+  m_Flags &= ~HasContextValues;
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::NotifyBeforeChange() {
+  xoins::internal::AssertNotInAnyThreadListener();
+  for(TObserver* observer = TObserver::s_Head; observer; observer = observer->m_Next)
+    observer->OnBeforeChange(this);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::NotifyChanged() {
+  xoins::internal::AssertNotInAnyThreadListener();
+  for(TObserver* observer = TObserver::s_Head; observer; observer = observer->m_Next)
+    observer->OnChanged(this);
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::FinishChange(bool andUpdate) {
+  if(!andUpdate || xoins::internal::BatchDepth()) {
+    NotifyChanged();
+    if(andUpdate)
+      MarkDirty();
+    return;
+  }
+  m_Flags &= ~Dirty;
+  T value = m_Identity;
+  T lastValue = m_LastValue;
+  xoins::internal::RunTransformations(m_Transformations, value);
+  m_LastValue = value;
+  NotifyChanged();
+  if(lastValue != value && (m_Flags & HasListeners)) {
+    FindListeners()->valueChanged.Dispatch(this, lastValue, value, (m_Flags & ParallelDispatch) != 0);
+    ReleaseListenersIfEmpty(); // in case listeners disconnected during the dispatch.
+  }
+}
+
+template<typename T, typename TPolicy>
+typename Inspectable<T, TPolicy>::Listeners* Inspectable<T, TPolicy>::FindListeners() const {
+  if(!(m_Flags & HasListeners))
+    return nullptr;
+  auto& table = xoins::internal::ListenerTable<Listeners>();
+  auto found = table.find(this);
+  return found != table.end() ? &found->second : nullptr;
+}
+
+template<typename T, typename TPolicy>
+typename Inspectable<T, TPolicy>::Listeners& Inspectable<T, TPolicy>::GetListeners() {
+  xoins::internal::AssertNotInAnyThreadListener();
+  m_Flags |= HasListeners;
+  return xoins::internal::ListenerTable<Listeners>()[this];
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::ReleaseListenersIfEmpty() {
+  Listeners* listeners = FindListeners();
+  if(listeners &&
+     listeners->identityChanged.IsEmpty() && !listeners->identityChanged.IsDispatching() &&
+     listeners->valueChanged.IsEmpty() && !listeners->valueChanged.IsDispatching()) {
+    xoins::internal::ListenerTable<Listeners>().erase(this);
+    m_Flags &= ~HasListeners;
+  }
+}
+
+template<typename T, typename TPolicy>
+void Inspectable<T, TPolicy>::CopyListenersFrom(const Inspectable<T, TPolicy>& other) {
+  if(Listeners* listeners = other.FindListeners()) {
+    Listeners copy(*listeners); // copy first, inserting into the table may rehash it.
+    GetListeners() = copy;
+  }
+  else if(m_Flags & HasListeners) {
+    xoins::internal::ListenerTable<Listeners>().erase(this);
+    m_Flags &= ~HasListeners;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableScopedTransformation
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+InspectableScopedTransformation<T, TPolicy>::InspectableScopedTransformation(Inspectable<T, TPolicy>* inspectable, bool updateOnDestroy)
+: m_Inspectable(inspectable),
+m_UpdateOnDestroy(updateOnDestroy)
+{
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedTransformation<T, TPolicy>::InspectableScopedTransformation(Inspectable<T, TPolicy>* inspectable,
+                                                                    TTransformFunc func,
+                                                                    int priority,
+                                                                    bool enabled,
+                                                                    bool andUpdate,
+                                                                    bool updateOnDestroy)
+: m_Inspectable(inspectable),
+m_Transformation(func, priority, enabled),
+m_UpdateOnDestroy(updateOnDestroy)
+{
+  if(m_Inspectable) {
+    m_Inspectable->AddTransformation(&m_Transformation);
+    if(andUpdate)
+      m_Inspectable->ForceUpdate();
+  }
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedTransformation<T, TPolicy>::InspectableScopedTransformation(InspectableScopedTransformation&& other) noexcept
+: m_Inspectable(other.m_Inspectable),
+m_Transformation(std::move(other.m_Transformation)),
+m_UpdateOnDestroy(other.m_UpdateOnDestroy)
+{
+  if(m_Inspectable)
+    m_Inspectable->MoveTransformation(&other.m_Transformation, &m_Transformation);
+  other.m_Inspectable = nullptr;
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedTransformation<T, TPolicy>::~InspectableScopedTransformation() {
+  if(m_Inspectable) {
+    m_Inspectable->RemoveTransformation(&m_Transformation);
+    if(m_UpdateOnDestroy)
+      m_Inspectable->ForceUpdate();
+  }
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedTransformation<T, TPolicy>& InspectableScopedTransformation<T, TPolicy>::operator=(InspectableScopedTransformation&& other) {
+  if(this == &other)
+    return *this;
+  if(m_Inspectable) {
+    m_Inspectable->RemoveTransformation(&m_Transformation);
+    if(m_UpdateOnDestroy)
+      m_Inspectable->ForceUpdate();
+  }
+  m_Inspectable = other.m_Inspectable;
+  m_Transformation = std::move(other.m_Transformation);
+  m_UpdateOnDestroy = other.m_UpdateOnDestroy;
+  if(m_Inspectable)
+    m_Inspectable->MoveTransformation(&other.m_Transformation, &m_Transformation);
+  other.m_Inspectable = nullptr;
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedTransformation<T, TPolicy>::Set(TTransformFunc func,
+                                             int priority,
+                                             bool enabled,
+                                             bool andUpdate) {
+  m_Transformation.Set(func, priority, enabled);
+  if(m_Inspectable && andUpdate)
+    m_Inspectable->ForceUpdate();
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedTransformation<T, TPolicy>::Set(const xoins::TransformOp<T>& op,
+                                             int priority,
+                                             bool enabled,
+                                             bool andUpdate) {
+  m_Transformation.Set(op, priority, enabled);
+  if(m_Inspectable && andUpdate)
+    m_Inspectable->ForceUpdate();
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedTransformation<T, TPolicy>::SetUpdateOnDestroy(bool updateOnDestroy) {
+  m_UpdateOnDestroy = updateOnDestroy;
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedTransformation<T, TPolicy>::Enable(bool andUpdate) {
+  m_Transformation.Enable();
+  if(m_Inspectable && andUpdate) {
+    m_Inspectable->ForceUpdate();
+  }
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedTransformation<T, TPolicy>::Disable(bool andUpdate) {
+  m_Transformation.Disable();
+  if(m_Inspectable && andUpdate) {
+    m_Inspectable->ForceUpdate();
+  }
+}
+
+template<typename T, typename TPolicy>
+bool InspectableScopedTransformation<T, TPolicy>::IsEnabled() const {
+  return m_Transformation.IsEnabled();
+}
+
+template<typename T, typename TPolicy>
+int InspectableScopedTransformation<T, TPolicy>::GetPriority() const {
+  return m_Transformation.GetPriority();
+}
+
+template<typename T, typename TPolicy>
+const std::function<void(T&)>& InspectableScopedTransformation<T, TPolicy>::GetTransformFunc() const {
+  return m_Transformation.GetTransformFunc();
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedTransformation<T, TPolicy>::operator()(T& input) {
+  m_Transformation(input);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableScopedConnection
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+InspectableScopedConnection<T, TPolicy>::InspectableScopedConnection()
+: m_Inspectable(nullptr),
+m_Connection()
+{
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedConnection<T, TPolicy>::InspectableScopedConnection(Inspectable<T, TPolicy>* inspectable,
+                                                                     InspectableConnection connection)
+: m_Inspectable(inspectable),
+m_Connection(connection)
+{
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedConnection<T, TPolicy>::InspectableScopedConnection(InspectableScopedConnection&& other) noexcept
+: m_Inspectable(other.m_Inspectable),
+m_Connection(other.m_Connection)
+{
+  other.Release();
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedConnection<T, TPolicy>::~InspectableScopedConnection() {
+  Reset();
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedConnection<T, TPolicy>& InspectableScopedConnection<T, TPolicy>::operator=(InspectableScopedConnection&& other) {
+  if(this != &other) {
+    Inspectable<T, TPolicy>* inspectable = other.m_Inspectable;
+    Reset(inspectable, other.Release());
+  }
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedConnection<T, TPolicy>::Reset(Inspectable<T, TPolicy>* inspectable,
+                                                    InspectableConnection connection) {
+  if(m_Inspectable)
+    m_Inspectable->Disconnect(m_Connection);
+  m_Inspectable = inspectable;
+  m_Connection = connection;
+}
+
+template<typename T, typename TPolicy>
+InspectableConnection InspectableScopedConnection<T, TPolicy>::Release() {
+  InspectableConnection connection = m_Connection;
+  m_Inspectable = nullptr;
+  m_Connection = InspectableConnection();
+  return connection;
+}
+
+template<typename T, typename TPolicy>
+bool InspectableScopedConnection<T, TPolicy>::IsConnected() const {
+  return m_Inspectable && m_Inspectable->IsConnected(m_Connection);
+}
+
+template<typename T, typename TPolicy>
+Inspectable<T, TPolicy>* InspectableScopedConnection<T, TPolicy>::GetInspectable() const {
+  return m_Inspectable;
+}
+
+template<typename T, typename TPolicy>
+InspectableConnection InspectableScopedConnection<T, TPolicy>::GetConnection() const {
+  return m_Connection;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableScopedValueChangedFunc
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+InspectableScopedValueChangedFunc<T, TPolicy>::InspectableScopedValueChangedFunc()
+: m_OnValueChanged()
+{
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedValueChangedFunc<T, TPolicy>::InspectableScopedValueChangedFunc(Inspectable<T, TPolicy>* inspectable,
+                                                                                 TValueChangedFunc func)
+: m_OnValueChanged()
+{
+  Set(inspectable, func);
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedValueChangedFunc<T, TPolicy>::InspectableScopedValueChangedFunc(InspectableScopedValueChangedFunc&& other) noexcept
+: InspectableScopedConnection<T, TPolicy>(std::move(other)),
+m_OnValueChanged(std::move(other.m_OnValueChanged))
+{
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedValueChangedFunc<T, TPolicy>& InspectableScopedValueChangedFunc<T, TPolicy>::operator=(InspectableScopedValueChangedFunc&& other) {
+  if(this != &other) {
+    InspectableScopedConnection<T, TPolicy>::operator=(std::move(other));
+    m_OnValueChanged = std::move(other.m_OnValueChanged);
+  }
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedValueChangedFunc<T, TPolicy>::Set(Inspectable<T, TPolicy>* inspectable,
+                                                        TValueChangedFunc func) {
+  m_OnValueChanged = func;
+  if(inspectable && m_OnValueChanged)
+    this->Reset(inspectable, inspectable->ConnectOnValueChanged(m_OnValueChanged));
+  else
+    this->Reset(inspectable);
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedValueChangedFunc<T, TPolicy>::SetInspectable(Inspectable<T, TPolicy>* inspectable) {
+  Set(inspectable, m_OnValueChanged);
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedValueChangedFunc<T, TPolicy>::SetFunc(TValueChangedFunc func) {
+  Set(this->GetInspectable(), func);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableScopedIdentityChangedFunc
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+InspectableScopedIdentityChangedFunc<T, TPolicy>::InspectableScopedIdentityChangedFunc()
+: m_OnValueChanged()
+{
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedIdentityChangedFunc<T, TPolicy>::InspectableScopedIdentityChangedFunc(Inspectable<T, TPolicy>* inspectable,
+                                                                                       TValueChangedFunc func)
+: m_OnValueChanged()
+{
+  Set(inspectable, func);
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedIdentityChangedFunc<T, TPolicy>::InspectableScopedIdentityChangedFunc(InspectableScopedIdentityChangedFunc&& other) noexcept
+: InspectableScopedConnection<T, TPolicy>(std::move(other)),
+m_OnValueChanged(std::move(other.m_OnValueChanged))
+{
+}
+
+template<typename T, typename TPolicy>
+InspectableScopedIdentityChangedFunc<T, TPolicy>& InspectableScopedIdentityChangedFunc<T, TPolicy>::operator=(InspectableScopedIdentityChangedFunc&& other) {
+  if(this != &other) {
+    InspectableScopedConnection<T, TPolicy>::operator=(std::move(other));
+    m_OnValueChanged = std::move(other.m_OnValueChanged);
+  }
+  return *this;
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedIdentityChangedFunc<T, TPolicy>::Set(Inspectable<T, TPolicy>* inspectable,
+                                                           TValueChangedFunc func) {
+  m_OnValueChanged = func;
+  if(inspectable && m_OnValueChanged)
+    this->Reset(inspectable, inspectable->ConnectOnIdentityChanged(m_OnValueChanged));
+  else
+    this->Reset(inspectable);
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedIdentityChangedFunc<T, TPolicy>::SetInspectable(Inspectable<T, TPolicy>* inspectable) {
+  Set(inspectable, m_OnValueChanged);
+}
+
+template<typename T, typename TPolicy>
+void InspectableScopedIdentityChangedFunc<T, TPolicy>::SetFunc(TValueChangedFunc func) {
+  Set(this->GetInspectable(), func);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Snapshots
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+xoins::SnapshotView<T>::SnapshotView()
+: m_Count(0),
+m_Identities(nullptr),
+m_Values(nullptr),
+m_TransformOffsets(nullptr),
+m_Transforms(nullptr)
+{
+}
+
+template<typename T>
+xoins::SnapshotView<T>::SnapshotView(const void* bytes, size_t size)
+: m_Count(0),
+m_Identities(nullptr),
+m_Values(nullptr),
+m_TransformOffsets(nullptr),
+m_Transforms(nullptr)
+{
+  const internal::SnapshotHeader* header = static_cast<const internal::SnapshotHeader*>(bytes);
+  if(!bytes || size < sizeof(internal::SnapshotHeader) ||
+     header->magic != internal::SnapshotMagic ||
+     header->version != internal::SnapshotVersion ||
+     header->valueSize != sizeof(T))
+    return;
+  const unsigned char* base = static_cast<const unsigned char*>(bytes);
+  size_t identities = internal::AlignSnapshotOffset(sizeof(internal::SnapshotHeader));
+  size_t values = internal::AlignSnapshotOffset(identities + (size_t)header->count * sizeof(T));
+  size_t offsets = internal::AlignSnapshotOffset(values + (size_t)header->count * sizeof(T));
+  size_t transforms = internal::AlignSnapshotOffset(offsets + ((size_t)header->count + 1) * sizeof(uint32_t));
+  size_t end = transforms + (size_t)header->transformCount * sizeof(SnapshotTransformDescriptor);
+  if(end > size)
+    return;
+  // every Inspectable's range has to lie inside the descriptors, so the getters below
+  // never read past them whatever the bytes say.
+  const uint32_t* transformOffsets = reinterpret_cast<const uint32_t*>(base + offsets);
+  for(uint32_t i = 0; i < header->count; ++i) {
+    if(transformOffsets[i] > transformOffsets[i + 1])
+      return;
+  }
+  if(transformOffsets[header->count] != header->transformCount)
+    return;
+  m_TransformOffsets = transformOffsets;
+  m_Count = header->count;
+  m_Identities = reinterpret_cast<const T*>(base + identities);
+  m_Values = reinterpret_cast<const T*>(base + values);
+  m_Transforms = reinterpret_cast<const SnapshotTransformDescriptor*>(base + transforms);
+}
+
+template<typename T>
+bool xoins::SnapshotView<T>::IsValid() const {
+  return m_TransformOffsets != nullptr;
+}
+
+template<typename T>
+uint32_t xoins::SnapshotView<T>::GetCount() const {
+  return m_Count;
+}
+
+template<typename T>
+const T* xoins::SnapshotView<T>::GetIdentities() const {
+  return m_Identities;
+}
+
+template<typename T>
+const T* xoins::SnapshotView<T>::GetValues() const {
+  return m_Values;
+}
+
+template<typename T>
+const xoins::SnapshotTransformDescriptor* xoins::SnapshotView<T>::GetTransformsBegin(uint32_t index) const {
+  return m_Transforms + m_TransformOffsets[index];
+}
+
+template<typename T>
+const xoins::SnapshotTransformDescriptor* xoins::SnapshotView<T>::GetTransformsEnd(uint32_t index) const {
+  return m_Transforms + m_TransformOffsets[index + 1];
+}
+
+inline size_t xoins::internal::AlignSnapshotOffset(size_t offset) {
+  return (offset + 7) & ~(size_t)7;
+}
+
+template<typename T, typename TGet>
+void xoins::internal::WriteSnapshot(size_t count, TGet get, std::vector<unsigned char>& out) {
+  static_assert(std::is_trivially_copyable<T>::value, "snapshots can only store trivially copyable values");
+  uint32_t transformCount = 0;
+  for(size_t i = 0; i < count; ++i)
+    for(auto transform : get(i).GetTransformations())
+      if(transform->GetDefinitionId() != 0)
+        ++transformCount;
+
+  size_t identities = AlignSnapshotOffset(sizeof(SnapshotHeader));
+  size_t values = AlignSnapshotOffset(identities + count * sizeof(T));
+  size_t offsets = AlignSnapshotOffset(values + count * sizeof(T));
+  size_t transforms = AlignSnapshotOffset(offsets + (count + 1) * sizeof(uint32_t));
+  size_t size = AlignSnapshotOffset(transforms + transformCount * sizeof(SnapshotTransformDescriptor));
+
+  // keep the snapshot 8 byte aligned relative to the start of 'out'.
+  size_t start = AlignSnapshotOffset(out.size());
+  out.resize(start + size, 0);
+  unsigned char* base = &out[start];
+
+  SnapshotHeader header = { SnapshotMagic, SnapshotVersion, (uint16_t)sizeof(T), (uint32_t)count, transformCount };
+  std::memcpy(base, &header, sizeof(header));
+
+  uint32_t transformIndex = 0;
+  for(size_t i = 0; i < count; ++i) {
+    std::memcpy(base + identities + i * sizeof(T), &get(i).GetIdentity(), sizeof(T));
+    std::memcpy(base + values + i * sizeof(T), &get(i).GetCachedValue(), sizeof(T));
+    std::memcpy(base + offsets + i * sizeof(uint32_t), &transformIndex, sizeof(uint32_t));
+    for(auto transform : get(i).GetTransformations()) {
+      if(transform->GetDefinitionId() == 0)
+        continue;
+      SnapshotTransformDescriptor descriptor = {
+        transform->GetDefinitionId(),
+        transform->GetPriority(),
+        transform->IsEnabled() ? 1u : 0u
+      };
+      std::memcpy(base + transforms + transformIndex * sizeof(descriptor), &descriptor, sizeof(descriptor));
+      ++transformIndex;
+    }
+  }
+  std::memcpy(base + offsets + count * sizeof(uint32_t), &transformIndex, sizeof(uint32_t));
+}
+
+template<typename T, typename TPolicy>
+void xoins::WriteSnapshot(const Inspectable<T, TPolicy>* inspectables, size_t count, std::vector<unsigned char>& out) {
+  internal::WriteSnapshot<T>(count, [=](size_t i) -> const Inspectable<T, TPolicy>& { return inspectables[i]; }, out);
+}
+
+template<typename T, typename TPolicy>
+void xoins::WriteSnapshot(const Inspectable<T, TPolicy>* const* inspectables, size_t count, std::vector<unsigned char>& out) {
+  internal::WriteSnapshot<T>(count, [=](size_t i) -> const Inspectable<T, TPolicy>& { return *inspectables[i]; }, out);
+}
+
+template<typename T, typename TPolicy>
+bool xoins::RestoreSnapshot(const SnapshotView<T>& view, Inspectable<T, TPolicy>* inspectables, size_t count) {
+  if(!view.IsValid() || view.GetCount() != count)
+    return false;
+  const T* identities = view.GetIdentities();
+  const T* values = view.GetValues();
+  for(size_t i = 0; i < count; ++i)
+    inspectables[i].RestoreState(identities[i], values[i]);
+  return true;
+}
+
+template<typename T, typename TPolicy, typename TResolver>
+bool xoins::RestoreSnapshot(const SnapshotView<T>& view,
+                            Inspectable<T, TPolicy>* inspectables,
+                            size_t count,
+                            TResolver resolver) {
+  typedef typename Inspectable<T, TPolicy>::TTransform TTransform;
+  if(!RestoreSnapshot(view, inspectables, count))
+    return false;
+  std::vector<TTransform*> transformations;
+  for(size_t i = 0; i < count; ++i) {
+    transformations.clear();
+    const SnapshotTransformDescriptor* end = view.GetTransformsEnd((uint32_t)i);
+    for(const SnapshotTransformDescriptor* d = view.GetTransformsBegin((uint32_t)i); d != end; ++d) {
+      TTransform* transformation = resolver(i, *d);
+      if(!transformation)
+        continue;
+      transformation->SetPriority(d->priority);
+      if(d->enabled)
+        transformation->Enable();
+      else
+        transformation->Disable();
+      transformation->SetDefinitionId(d->definitionId);
+      transformations.push_back(transformation);
+    }
+    // the descriptors are already in evaluation order, and they replace whatever the
+    // Inspectable had rather than being added on top of it.
+    inspectables[i].RestoreTransformations(transformations.data(), transformations.data() + transformations.size());
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// HandlePool
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename THandle>
+const uint32_t xoins::HandlePool<THandle>::NoSlot;
+
+template<typename THandle>
+xoins::HandlePool<THandle>::Slot::Slot(THandle&& value)
+: handle(std::move(value)),
+generation(0),
+nextFree(NoSlot),
+live(true)
+{
+}
+
+template<typename THandle>
+xoins::HandlePool<THandle>::HandlePool()
+: m_FreeHead(NoSlot),
+m_Count(0)
+{
+}
+
+template<typename THandle>
+xoins::HandlePoolId xoins::HandlePool<THandle>::Acquire(THandle&& handle) {
+  ++m_Count;
+  if(m_FreeHead != NoSlot) {
+    uint32_t index = m_FreeHead;
+    Slot& slot = m_Slots[index];
+    m_FreeHead = slot.nextFree;
+    slot.handle = std::move(handle);
+    slot.live = true;
+    HandlePoolId id = { index, slot.generation };
+    return id;
+  }
+  m_Slots.emplace_back(std::move(handle));
+  HandlePoolId id = { (uint32_t)(m_Slots.size() - 1), 0 };
+  return id;
+}
+
+template<typename THandle>
+bool xoins::HandlePool<THandle>::Release(HandlePoolId id) {
+  if(!Get(id))
+    return false;
+  Slot& slot = m_Slots[id.index];
+  slot.handle = THandle();
+  slot.live = false;
+  ++slot.generation;
+  slot.nextFree = m_FreeHead;
+  m_FreeHead = id.index;
+  --m_Count;
+  return true;
+}
+
+template<typename THandle>
+THandle* xoins::HandlePool<THandle>::Get(HandlePoolId id) {
+  if(id.index >= m_Slots.size())
+    return nullptr;
+  Slot& slot = m_Slots[id.index];
+  return slot.live && slot.generation == id.generation ? &slot.handle : nullptr;
+}
+
+template<typename THandle>
+const THandle* xoins::HandlePool<THandle>::Get(HandlePoolId id) const {
+  return const_cast<HandlePool*>(this)->Get(id);
+}
+
+template<typename THandle>
+size_t xoins::HandlePool<THandle>::GetCount() const {
+  return m_Count;
+}
+
+template<typename THandle>
+void xoins::HandlePool<THandle>::Reserve(size_t capacity) {
+  m_Slots.reserve(capacity);
+}
+
+template<typename THandle>
+void xoins::HandlePool<THandle>::Clear() {
+  for(uint32_t i = 0; i < m_Slots.size(); ++i) {
+    HandlePoolId id = { i, m_Slots[i].generation };
+    Release(id);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableObserver
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+InspectableObserver<T, TPolicy>* InspectableObserver<T, TPolicy>::s_Head = nullptr;
+
+template<typename T, typename TPolicy>
+InspectableObserver<T, TPolicy>::InspectableObserver()
+: m_Prev(nullptr),
+m_Next(s_Head)
+{
+  if(s_Head)
+    s_Head->m_Prev = this;
+  s_Head = this;
+}
+
+template<typename T, typename TPolicy>
+InspectableObserver<T, TPolicy>::~InspectableObserver() {
+  (m_Prev ? m_Prev->m_Next : s_Head) = m_Next;
+  if(m_Next)
+    m_Next->m_Prev = m_Prev;
+}
+
+template<typename T, typename TPolicy>
+void InspectableObserver<T, TPolicy>::OnBeforeChange(TInspectable*) {
+}
+
+template<typename T, typename TPolicy>
+void InspectableObserver<T, TPolicy>::OnChanged(TInspectable*) {
+}
+
+template<typename T, typename TPolicy>
+void InspectableObserver<T, TPolicy>::OnDestroyed(TInspectable*) {
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableRollback
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+InspectableRollback<T, TPolicy>::InspectableRollback(unsigned maxFrames)
+: m_Frames(maxFrames + 1),
+m_Open(0),
+m_Count(0),
+m_Restoring(false)
+{
+  for(Frame& frame : m_Frames) {
+    frame.count = 0;
+    frame.generation = 0;
+  }
+}
+
+template<typename T, typename TPolicy>
+void InspectableRollback<T, TPolicy>::Capture() {
+  // the oldest frame is overwritten once the ring is full.
+  m_Open = FrameIndex(m_Frames.size() - 1);
+  Reset(m_Frames[m_Open]);
+  if(m_Count < m_Frames.size() - 1)
+    ++m_Count;
+}
+
+template<typename T, typename TPolicy>
+bool InspectableRollback<T, TPolicy>::Rewind(unsigned frames) {
+  if(frames > m_Count)
+    return false;
+  // newest first, so each Inspectable ends up with its oldest recorded state.
+  for(unsigned i = 0; i <= frames; ++i)
+    Undo(m_Frames[FrameIndex(i)]);
+  m_Open = FrameIndex(frames);
+  m_Count -= frames;
+  return true;
+}
+
+template<typename T, typename TPolicy>
+unsigned InspectableRollback<T, TPolicy>::GetFrameCount() const {
+  return m_Count;
+}
+
+template<typename T, typename TPolicy>
+void InspectableRollback<T, TPolicy>::Clear() {
+  // m_Latest keeps its entries, which no longer lead anywhere, for their storage.
+  for(Frame& frame : m_Frames)
+    Reset(frame);
+  m_Count = 0;
+}
+
+template<typename T, typename TPolicy>
+void InspectableRollback<T, TPolicy>::OnBeforeChange(TInspectable* inspectable) {
+  if(m_Restoring)
+    return;
+  Frame& frame = m_Frames[m_Open];
+  // only the first record of an Inspectable in a frame matters. This catches the common
+  // case of several changes in a row without a lookup.
+  if(frame.count > 0 && frame.records[frame.count - 1].inspectable == inspectable)
+    return;
+  Location location = { m_Open, (uint32_t)frame.count, frame.generation };
+  auto latest = m_Latest.insert(std::make_pair(inspectable, location));
+  if(!latest.second) {
+    if(latest.first->second.frame == m_Open && IsRecorded(latest.first->second))
+      return;
+    std::swap(latest.first->second, location); // 'location' is now the previous record
+  } else {
+    location.generation = frame.generation - 1; // leads nowhere
+  }
+  if(frame.count == frame.records.size())
+    frame.records.push_back(Record());
+  Record& record = frame.records[frame.count++];
+  record.inspectable = inspectable;
+  record.identity = inspectable->GetIdentity();
+  record.value = inspectable->GetCachedValue();
+  record.transformations.clear();
+  for(auto transformation : inspectable->GetTransformations())
+    record.transformations.push_back(transformation);
+  record.previous = location;
+}
+
+template<typename T, typename TPolicy>
+void InspectableRollback<T, TPolicy>::OnDestroyed(TInspectable* inspectable) {
+  auto latest = m_Latest.find(inspectable);
+  if(latest == m_Latest.end())
+    return;
+  // its records stay where they are, so the other chains still lead to theirs.
+  for(Location at = latest->second; IsRecorded(at);) {
+    Record& record = m_Frames[at.frame].records[at.index];
+    record.inspectable = nullptr;
+    at = record.previous;
+  }
+  m_Latest.erase(latest);
+}
+
+template<typename T, typename TPolicy>
+void InspectableRollback<T, TPolicy>::Undo(Frame& frame) {
+  m_Restoring = true;
+  for(size_t i = frame.count; i-- > 0;) {
+    Record& record = frame.records[i];
+    if(record.inspectable == nullptr) // destroyed since.
+      continue;
+    typename TInspectable::TTransform* const* transformations = record.transformations.data();
+    record.inspectable->RestoreState(record.identity, record.value);
+    record.inspectable->RestoreTransformations(transformations, transformations + record.transformations.size());
+    m_Latest[record.inspectable] = record.previous;
+  }
+  m_Restoring = false;
+  Reset(frame);
+}
+
+template<typename T, typename TPolicy>
+void InspectableRollback<T, TPolicy>::Reset(Frame& frame) {
+  frame.count = 0;
+  ++frame.generation;
+}
+
+template<typename T, typename TPolicy>
+bool InspectableRollback<T, TPolicy>::IsRecorded(const Location& location) const {
+  const Frame& frame = m_Frames[location.frame];
+  return frame.generation == location.generation && location.index < frame.count;
+}
+
+template<typename T, typename TPolicy>
+unsigned InspectableRollback<T, TPolicy>::FrameIndex(unsigned framesAgo) const {
+  unsigned size = (unsigned)m_Frames.size();
+  return (m_Open + size - framesAgo) % size;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Delta replication
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+uint64_t xoins::BitwiseDeltaCodec<T>::Encode(const T& last, const T& value) const {
+  uint64_t lastBits = 0, valueBits = 0;
+  std::memcpy(&lastBits, &last, sizeof(T));
+  std::memcpy(&valueBits, &value, sizeof(T));
+  return lastBits ^ valueBits;
+}
+
+template<typename T>
+T xoins::BitwiseDeltaCodec<T>::Decode(const T& last, uint64_t delta) const {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &last, sizeof(T));
+  bits ^= delta;
+  T value;
+  std::memcpy(&value, &bits, sizeof(T));
+  return value;
+}
+
+template<typename T>
+xoins::QuantizedDeltaCodec<T>::QuantizedDeltaCodec(T step)
+: step(step)
+{
+}
+
+template<typename T>
+uint64_t xoins::QuantizedDeltaCodec<T>::Encode(const T& last, const T& value) const {
+  int64_t lastSteps = (int64_t)std::llround(last / step);
+  int64_t valueSteps = (int64_t)std::llround(value / step);
+  return internal::ZigZag(valueSteps - lastSteps);
+}
+
+template<typename T>
+T xoins::QuantizedDeltaCodec<T>::Decode(const T& last, uint64_t delta) const {
+  int64_t lastSteps = (int64_t)std::llround(last / step);
+  return (T)(lastSteps + internal::UnZigZag(delta)) * step;
+}
+
+inline void xoins::internal::WriteVarint(uint64_t value, std::vector<unsigned char>& out) {
+  while(value >= 0x80) {
+    out.push_back((unsigned char)(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((unsigned char)value);
+}
+
+inline bool xoins::internal::ReadVarint(const unsigned char*& read, const unsigned char* end, uint64_t& outValue) {
+  outValue = 0;
+  for(unsigned shift = 0; shift < 64 && read != end; shift += 7) {
+    unsigned char byte = *read++;
+    outValue |= (uint64_t)(byte & 0x7f) << shift;
+    if(!(byte & 0x80))
+      return true;
+  }
+  return false; // ran out of bytes or more than 10 of them.
+}
+
+inline uint64_t xoins::internal::ZigZag(int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t xoins::internal::UnZigZag(uint64_t value) {
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+template<typename T, typename TPolicy>
+InspectableDeltaTracker<T, TPolicy>::InspectableDeltaTracker()
+: m_Oldest(nullptr),
+m_Newest(nullptr),
+m_Tick(0)
+{
+}
+
+template<typename T, typename TPolicy>
+void InspectableDeltaTracker<T, TPolicy>::Track(TInspectable* inspectable, uint32_t handle) {
+  if(!inspectable) // we don't track null inspectables.
+    return;
+  auto inserted = m_Entries.insert(std::make_pair(inspectable, Entry()));
+  Entry& entry = inserted.first->second;
+  if(!inserted.second)
+    Unlink(&entry);
+  entry.inspectable = inspectable;
+  entry.handle = handle;
+  LinkNewest(&entry);
+}
+
+template<typename T, typename TPolicy>
+void InspectableDeltaTracker<T, TPolicy>::Untrack(TInspectable* inspectable) {
+  auto found = m_Entries.find(inspectable);
+  if(found == m_Entries.end())
+    return;
+  Unlink(&found->second);
+  m_Entries.erase(found);
+}
+
+template<typename T, typename TPolicy>
+uint64_t InspectableDeltaTracker<T, TPolicy>::AdvanceTick() {
+  return ++m_Tick;
+}
+
+template<typename T, typename TPolicy>
+uint64_t InspectableDeltaTracker<T, TPolicy>::GetTick() const {
+  return m_Tick;
+}
+
+template<typename T, typename TPolicy>
+template<typename F>
+void InspectableDeltaTracker<T, TPolicy>::ForEachChangedSince(uint64_t tick, F f) const {
+  for(const Entry* entry = m_Newest; entry && entry->tick >= tick; entry = entry->prev)
+    f(entry->handle, *entry->inspectable);
+}
+
+template<typename T, typename TPolicy>
+void InspectableDeltaTracker<T, TPolicy>::MarkChanged(TInspectable* inspectable) {
+  OnChanged(inspectable);
+}
+
+template<typename T, typename TPolicy>
+void InspectableDeltaTracker<T, TPolicy>::OnChanged(TInspectable* inspectable) {
+  auto found = m_Entries.find(inspectable);
+  if(found == m_Entries.end())
+    return;
+  Entry* entry = &found->second;
+  if(entry == m_Newest && entry->tick == m_Tick)
+    return;
+  Unlink(entry);
+  LinkNewest(entry);
+}
+
+template<typename T, typename TPolicy>
+void InspectableDeltaTracker<T, TPolicy>::OnDestroyed(TInspectable* inspectable) {
+  Untrack(inspectable);
+}
+
+template<typename T, typename TPolicy>
+void InspectableDeltaTracker<T, TPolicy>::Unlink(Entry* entry) {
+  (entry->prev ? entry->prev->next : m_Oldest) = entry->next;
+  (entry->next ? entry->next->prev : m_Newest) = entry->prev;
+  entry->prev = entry->next = nullptr;
+}
+
+template<typename T, typename TPolicy>
+void InspectableDeltaTracker<T, TPolicy>::LinkNewest(Entry* entry) {
+  entry->tick = m_Tick;
+  entry->next = nullptr;
+  entry->prev = m_Newest;
+  (m_Newest ? m_Newest->next : m_Oldest) = entry;
+  m_Newest = entry;
+}
+
+template<typename T, typename TPolicy, typename TCodec>
+InspectableDeltaWriter<T, TPolicy, TCodec>::InspectableDeltaWriter(const InspectableDeltaTracker<T, TPolicy>& tracker, TCodec codec)
+: m_Tracker(tracker),
+m_Codec(codec),
+m_FromTick(0)
+{
+}
+
+template<typename T, typename TPolicy, typename TCodec>
+size_t InspectableDeltaWriter<T, TPolicy, TCodec>::Write(std::vector<unsigned char>& out) {
+  m_Scratch.clear();
+  m_Tracker.ForEachChangedSince(m_FromTick, [this](uint32_t handle, const Inspectable<T, TPolicy>& inspectable) {
+    // a handle's first state is relative to T(), and always sent.
+    State initial = { T(), T() };
+    auto inserted = m_Sent.insert(std::make_pair(handle, initial));
+    State& sent = inserted.first->second;
+    Change change = {
+      handle,
+      m_Codec.Encode(sent.identity, inspectable.GetIdentity()),
+      m_Codec.Encode(sent.value, inspectable.GetCachedValue())
+    };
+    if(change.identity == 0 && change.value == 0 && !inserted.second) // unchanged as far as the receiver can tell.
+      return;
+    // what the receiver will have
+    sent.identity = m_Codec.Decode(sent.identity, change.identity);
+    sent.value = m_Codec.Decode(sent.value, change.value);
+    m_Scratch.push_back(change);
+  });
+  // the current tick can still change, so it's visited again next time. Anything that
+  // didn't change encodes to 0 and is skipped.
+  m_FromTick = m_Tracker.GetTick();
+
+  xoins::internal::WriteVarint(m_Scratch.size(), out);
+  for(const Change& change : m_Scratch) {
+    xoins::internal::WriteVarint(change.handle, out);
+    xoins::internal::WriteVarint(change.identity, out);
+    xoins::internal::WriteVarint(change.value, out);
+  }
+  return m_Scratch.size();
+}
+
+template<typename T, typename TPolicy, typename TCodec>
+void InspectableDeltaWriter<T, TPolicy, TCodec>::Reset() {
+  m_Sent.clear();
+  m_FromTick = 0;
+}
+
+template<typename T, typename TPolicy, typename TCodec>
+InspectableDeltaReader<T, TPolicy, TCodec>::InspectableDeltaReader(TCodec codec)
+: m_Codec(codec)
+{
+}
+
+template<typename T, typename TPolicy, typename TCodec>
+template<typename TResolve>
+bool InspectableDeltaReader<T, TPolicy, TCodec>::Apply(const void* bytes, size_t size, TResolve resolve) {
+  const unsigned char* read = static_cast<const unsigned char*>(bytes);
+  const unsigned char* end = read + size;
+  uint64_t count;
+  if(!xoins::internal::ReadVarint(read, end, count))
+    return false;
+  for(uint64_t i = 0; i < count; ++i) {
+    uint64_t handle, identity, value;
+    if(!xoins::internal::ReadVarint(read, end, handle) ||
+       !xoins::internal::ReadVarint(read, end, identity) ||
+       !xoins::internal::ReadVarint(read, end, value))
+      return false;
+    State initial = { T(), T() };
+    State& received = m_Received.insert(std::make_pair((uint32_t)handle, initial)).first->second;
+    received.identity = m_Codec.Decode(received.identity, identity);
+    received.value = m_Codec.Decode(received.value, value);
+    Inspectable<T, TPolicy>* inspectable = resolve((uint32_t)handle);
+    if(inspectable)
+      inspectable->ReplicateState(received.identity, received.value);
+  }
+  return true;
+}
+
+template<typename T, typename TPolicy, typename TCodec>
+void InspectableDeltaReader<T, TPolicy, TCodec>::Reset() {
+  m_Received.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Transformation set replication
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+void xoins::internal::CollectTransformSet(const Inspectable<T, TPolicy>& inspectable, std::vector<uint32_t>& out) {
+  out.clear();
+  for(auto transformation : inspectable.GetTransformations())
+    if(transformation->IsActive() && transformation->GetDefinitionId() != 0)
+      out.push_back(transformation->GetDefinitionId());
+}
+
+inline void xoins::internal::WriteTransformSetEdit(const std::vector<uint32_t>& last,
+                                                   const std::vector<uint32_t>& current,
+                                                   std::vector<unsigned char>& out) {
+  // greedily match current against last in order. Matched ids are kept, everything else
+  // in 'last' is dropped and everything else in 'current' is inserted.
+  size_t keepOffset = out.size();
+  out.resize(keepOffset + (last.size() + 7) / 8, 0);
+  uint64_t insertions = 0;
+  size_t from = 0;
+  for(uint32_t id : current) {
+    auto found = std::find(last.begin() + from, last.end(), id);
+    if(found == last.end()) {
+      ++insertions;
+      continue;
+    }
+    size_t index = found - last.begin();
+    out[keepOffset + index / 8] |= (unsigned char)(1 << (index % 8));
+    from = index + 1;
+  }
+
+  WriteVarint(insertions, out);
+  from = 0;
+  for(size_t position = 0; position < current.size(); ++position) {
+    auto found = std::find(last.begin() + from, last.end(), current[position]);
+    if(found != last.end()) {
+      from = found - last.begin() + 1;
+      continue;
+    }
+    WriteVarint(position, out);
+    WriteVarint(current[position], out);
+  }
+}
+
+inline bool xoins::internal::ReadTransformSetEdit(const unsigned char*& read,
+                                                  const unsigned char* end,
+                                                  const std::vector<uint32_t>& last,
+                                                  std::vector<uint32_t>& out) {
+  size_t keepBytes = (last.size() + 7) / 8;
+  if((size_t)(end - read) < keepBytes)
+    return false;
+  out.clear();
+  for(size_t i = 0; i < last.size(); ++i)
+    if(read[i / 8] & (1 << (i % 8)))
+      out.push_back(last[i]);
+  read += keepBytes;
+
+  uint64_t insertions;
+  if(!ReadVarint(read, end, insertions) || insertions > (uint64_t)(end - read))
+    return false;
+  for(uint64_t i = 0; i < insertions; ++i) {
+    uint64_t position, id;
+    if(!ReadVarint(read, end, position) || !ReadVarint(read, end, id) || position > out.size())
+      return false;
+    out.insert(out.begin() + (size_t)position, (uint32_t)id);
+  }
+  return true;
+}
+
+template<typename T, typename TPolicy>
+InspectableTransformSetWriter<T, TPolicy>::InspectableTransformSetWriter(const InspectableDeltaTracker<T, TPolicy>& tracker)
+: m_Tracker(tracker),
+m_FromTick(0)
+{
+}
+
+template<typename T, typename TPolicy>
+size_t InspectableTransformSetWriter<T, TPolicy>::Write(std::vector<unsigned char>& out) {
+  size_t count = 0;
+  m_Body.clear();
+  m_Tracker.ForEachChangedSince(m_FromTick, [&](uint32_t handle, const Inspectable<T, TPolicy>& inspectable) {
+    xoins::internal::CollectTransformSet(inspectable, m_Current);
+    // a handle's first set is always sent.
+    auto inserted = m_Sent.insert(std::make_pair(handle, std::vector<uint32_t>()));
+    std::vector<uint32_t>& sent = inserted.first->second;
+    if(!inserted.second && sent == m_Current)
+      return;
+
+    m_Full.clear();
+    xoins::internal::WriteVarint(m_Current.size(), m_Full);
+    for(uint32_t id : m_Current)
+      xoins::internal::WriteVarint(id, m_Full);
+    m_Edit.clear();
+    xoins::internal::WriteTransformSetEdit(sent, m_Current, m_Edit);
+
+    bool edit = m_Edit.size() < m_Full.size();
+    xoins::internal::WriteVarint(handle, m_Body);
+    m_Body.push_back(edit ? xoins::internal::TransformSetEdit : xoins::internal::TransformSetFull);
+    const std::vector<unsigned char>& encoded = edit ? m_Edit : m_Full;
+    m_Body.insert(m_Body.end(), encoded.begin(), encoded.end());
+    sent = m_Current;
+    ++count;
+  });
+  // see InspectableDeltaWriter::Write, the current tick is visited again next time.
+  m_FromTick = m_Tracker.GetTick();
+
+  xoins::internal::WriteVarint(count, out);
+  out.insert(out.end(), m_Body.begin(), m_Body.end());
+  return count;
+}
+
+template<typename T, typename TPolicy>
+void InspectableTransformSetWriter<T, TPolicy>::Reset() {
+  m_Sent.clear();
+  m_FromTick = 0;
+}
+
+template<typename T, typename TPolicy>
+template<typename TResolve, typename TResolveTransform>
+bool InspectableTransformSetReader<T, TPolicy>::Apply(const void* bytes,
+                                                      size_t size,
+                                                      TResolve resolve,
+                                                      TResolveTransform resolveTransform) {
+  const unsigned char* read = static_cast<const unsigned char*>(bytes);
+  const unsigned char* end = read + size;
+  uint64_t count;
+  if(!xoins::internal::ReadVarint(read, end, count))
+    return false;
+  for(uint64_t i = 0; i < count; ++i) {
+    uint64_t handle;
+    if(!xoins::internal::ReadVarint(read, end, handle) || read == end)
+      return false;
+    std::vector<uint32_t>& received = m_Received[(uint32_t)handle];
+    unsigned char encoding = *read++;
+    if(encoding == xoins::internal::TransformSetEdit) {
+      if(!xoins::internal::ReadTransformSetEdit(read, end, received, m_Scratch))
+        return false;
+    }
+    else if(encoding == xoins::internal::TransformSetFull) {
+      uint64_t ids;
+      if(!xoins::internal::ReadVarint(read, end, ids) || ids > (uint64_t)(end - read))
+        return false;
+      m_Scratch.clear();
+      for(uint64_t id = 0; id < ids; ++id) {
+        uint64_t definitionId;
+        if(!xoins::internal::ReadVarint(read, end, definitionId))
+          return false;
+        m_Scratch.push_back((uint32_t)definitionId);
+      }
+    }
+    else {
+      return false;
+    }
+    received.swap(m_Scratch);
+
+    Inspectable<T, TPolicy>* inspectable = resolve((uint32_t)handle);
+    if(!inspectable)
+      continue;
+    m_Chain.clear();
+    for(uint32_t definitionId : received) {
+      typename Inspectable<T, TPolicy>::TTransform* transformation = resolveTransform((uint32_t)handle, definitionId);
+      if(!transformation)
+        continue;
+      transformation->Enable();
+      m_Chain.push_back(transformation);
+    }
+    inspectable->RestoreTransformations(m_Chain.data(), m_Chain.data() + m_Chain.size());
+    inspectable->ForceUpdate();
+  }
+  return true;
+}
+
+template<typename T, typename TPolicy>
+void InspectableTransformSetReader<T, TPolicy>::Reset() {
+  m_Received.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Fixed point
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename TRaw, unsigned F>
+const unsigned xoins::Fixed<TRaw, F>::Fraction;
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F>::Fixed()
+: m_Raw(0)
+{
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::Fixed<TRaw, F>::FromRaw(TRaw raw) {
+  Fixed fixed;
+  fixed.m_Raw = raw;
+  return fixed;
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::Fixed<TRaw, F>::FromInt(TRaw value) {
+  typedef typename std::make_unsigned<TRaw>::type TUnsigned;
+  return FromRaw((TRaw)((TUnsigned)value << F));
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::Fixed<TRaw, F>::FromDouble(double value) {
+  // scaling by a power of two is exact, so only the final rounding can differ and
+  // llround is the same everywhere.
+  return FromRaw((TRaw)std::llround(std::ldexp(value, (int)F)));
+}
+
+template<typename TRaw, unsigned F>
+TRaw xoins::Fixed<TRaw, F>::GetRaw() const {
+  return m_Raw;
+}
+
+template<typename TRaw, unsigned F>
+TRaw xoins::Fixed<TRaw, F>::ToInt() const {
+  return m_Raw >> F;
+}
+
+template<typename TRaw, unsigned F>
+double xoins::Fixed<TRaw, F>::ToDouble() const {
+  return std::ldexp((double)m_Raw, -(int)F);
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::Fixed<TRaw, F>::operator-() const {
+  return FromRaw(internal::FixedSub<TRaw>(0, m_Raw));
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::Fixed<TRaw, F>::operator+(Fixed other) const {
+  return FromRaw(internal::FixedAdd(m_Raw, other.m_Raw));
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::Fixed<TRaw, F>::operator-(Fixed other) const {
+  return FromRaw(internal::FixedSub(m_Raw, other.m_Raw));
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::Fixed<TRaw, F>::operator*(Fixed other) const {
+  return FromRaw(internal::FixedMul(m_Raw, other.m_Raw, F));
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F>& xoins::Fixed<TRaw, F>::operator+=(Fixed other) {
+  return *this = *this + other;
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F>& xoins::Fixed<TRaw, F>::operator-=(Fixed other) {
+  return *this = *this - other;
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F>& xoins::Fixed<TRaw, F>::operator*=(Fixed other) {
+  return *this = *this * other;
+}
+
+template<typename TRaw, unsigned F>
+bool xoins::Fixed<TRaw, F>::operator==(Fixed other) const {
+  return m_Raw == other.m_Raw;
+}
+
+template<typename TRaw, unsigned F>
+bool xoins::Fixed<TRaw, F>::operator!=(Fixed other) const {
+  return m_Raw != other.m_Raw;
+}
+
+template<typename TRaw, unsigned F>
+bool xoins::Fixed<TRaw, F>::operator<(Fixed other) const {
+  return m_Raw < other.m_Raw;
+}
+
+template<typename TRaw, unsigned F>
+bool xoins::Fixed<TRaw, F>::operator<=(Fixed other) const {
+  return m_Raw <= other.m_Raw;
+}
+
+template<typename TRaw, unsigned F>
+bool xoins::Fixed<TRaw, F>::operator>(Fixed other) const {
+  return m_Raw > other.m_Raw;
+}
+
+template<typename TRaw, unsigned F>
+bool xoins::Fixed<TRaw, F>::operator>=(Fixed other) const {
+  return m_Raw >= other.m_Raw;
+}
+
+template<typename T>
+std::function<void(T&)> xoins::MakeAddTransform(T amount) {
+  return [amount](T& value) { value = value + amount; };
+}
+
+template<typename T>
+std::function<void(T&)> xoins::MakeMulTransform(T factor) {
+  return [factor](T& value) { value = value * factor; };
+}
+
+template<typename T>
+std::function<void(T&)> xoins::MakeClampTransform(T minimum, T maximum) {
+  return [minimum, maximum](T& value) {
+    if(value < minimum)
+      value = minimum;
+    else if(maximum < value)
+      value = maximum;
+  };
+}
+
+template<typename TRaw, unsigned F>
+void xoins::BatchAdd(Fixed<TRaw, F>* values, size_t count, Fixed<TRaw, F> amount) {
+  for(size_t i = 0; i < count; ++i)
+    values[i] = Fixed<TRaw, F>::FromRaw(internal::FixedAdd(values[i].GetRaw(), amount.GetRaw()));
+}
+
+template<typename TRaw, unsigned F>
+void xoins::BatchMul(Fixed<TRaw, F>* values, size_t count, Fixed<TRaw, F> factor) {
+  for(size_t i = 0; i < count; ++i)
+    values[i] = Fixed<TRaw, F>::FromRaw(internal::FixedMul(values[i].GetRaw(), factor.GetRaw(), F));
+}
+
+template<typename TRaw, unsigned F>
+void xoins::BatchClamp(Fixed<TRaw, F>* values, size_t count, Fixed<TRaw, F> minimum, Fixed<TRaw, F> maximum) {
+  TRaw low = minimum.GetRaw(), high = maximum.GetRaw();
+  for(size_t i = 0; i < count; ++i) {
+    TRaw raw = values[i].GetRaw();
+    raw = raw < low ? low : raw;
+    raw = raw > high ? high : raw;
+    values[i] = Fixed<TRaw, F>::FromRaw(raw);
+  }
+}
+
+inline int32_t xoins::internal::FixedMul(int32_t a, int32_t b, unsigned shift) {
+  return (int32_t)(((int64_t)a * b) >> shift);
+}
+
+inline int64_t xoins::internal::FixedMul(int64_t a, int64_t b, unsigned shift) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef __int128 TWide; // __extension__ keeps -pedantic quiet
+  return (int64_t)(((TWide)a * b) >> shift);
+#else
+  // 64x64 -> 128 bit multiply on the magnitudes out of 32 bit halves.
+  bool negative = (a < 0) != (b < 0);
+  uint64_t x = a < 0 ? 0 - (uint64_t)a : (uint64_t)a;
+  uint64_t y = b < 0 ? 0 - (uint64_t)b : (uint64_t)b;
+  uint64_t xLow = x & 0xffffffff, xHigh = x >> 32;
+  uint64_t yLow = y & 0xffffffff, yHigh = y >> 32;
+  uint64_t lowLow = xLow * yLow;
+  uint64_t middle1 = xHigh * yLow + (lowLow >> 32);
+  uint64_t middle2 = xLow * yHigh + (middle1 & 0xffffffff);
+  uint64_t high = xHigh * yHigh + (middle1 >> 32) + (middle2 >> 32);
+  uint64_t low = (middle2 << 32) | (lowLow & 0xffffffff);
+
+  uint64_t shifted = shift ? (low >> shift) | (high << (64 - shift)) : low;
+  if(negative) {
+    // round the magnitude up so the negative result rounds down, like >> on a signed value.
+    bool remainder = shift && (low & ((uint64_t(1) << shift) - 1)) != 0;
+    shifted = 0 - (shifted + (remainder ? 1 : 0));
+  }
+  return (int64_t)shifted;
+#endif // __SIZEOF_INT128__
+}
+
+template<typename TRaw>
+TRaw xoins::internal::FixedAdd(TRaw a, TRaw b) {
+  typedef typename std::make_unsigned<TRaw>::type TUnsigned;
+  return (TRaw)((TUnsigned)a + (TUnsigned)b);
+}
+
+template<typename TRaw>
+TRaw xoins::internal::FixedSub(TRaw a, TRaw b) {
+  typedef typename std::make_unsigned<TRaw>::type TUnsigned;
+  return (TRaw)((TUnsigned)a - (TUnsigned)b);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Modifier programs
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+T xoins::ModifierTraits<T>::FromNumber(double number) {
+  return (T)number;
+}
+
+template<typename T>
+T xoins::ModifierTraits<T>::Divide(const T& a, const T& b) {
+  return b == T() ? T() : a / b;
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::ModifierTraits<xoins::Fixed<TRaw, F> >::FromNumber(double number) {
+  return Fixed<TRaw, F>::FromDouble(number);
+}
+
+template<typename TRaw, unsigned F>
+xoins::Fixed<TRaw, F> xoins::ModifierTraits<xoins::Fixed<TRaw, F> >::Divide(const Fixed<TRaw, F>& a, const Fixed<TRaw, F>& b) {
+  if(b.GetRaw() == 0)
+    return Fixed<TRaw, F>();
+  return Fixed<TRaw, F>::FromRaw(internal::FixedDiv(a.GetRaw(), b.GetRaw(), F));
+}
+
+inline int32_t xoins::internal::FixedDiv(int32_t a, int32_t b, unsigned shift) {
+  return (int32_t)(((int64_t)a * ((int64_t)1 << shift)) / b);
+}
+
+inline int64_t xoins::internal::FixedDiv(int64_t a, int64_t b, unsigned shift) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef __int128 TWide; // __extension__ keeps -pedantic quiet
+  return (int64_t)(((TWide)a * ((TWide)1 << shift)) / b);
+#else
+  // (|a| << shift) / |b| as a 128 by 64 bit long division, truncating like / does.
+  bool negative = (a < 0) != (b < 0);
+  uint64_t x = a < 0 ? 0 - (uint64_t)a : (uint64_t)a;
+  uint64_t y = b < 0 ? 0 - (uint64_t)b : (uint64_t)b;
+  uint64_t high = shift ? x >> (64 - shift) : 0, low = x << shift;
+  uint64_t quotient = 0, remainder = 0;
+  for(int bit = 127; bit >= 0; --bit) {
+    uint64_t next = bit >= 64 ? (high >> (bit - 64)) & 1 : (low >> bit) & 1;
+    bool carry = (remainder >> 63) != 0;
+    remainder = (remainder << 1) | next;
+    if(carry || remainder >= y) {
+      remainder -= y;
+      if(bit < 64)
+        quotient |= uint64_t(1) << bit;
+    }
+  }
+  return (int64_t)(negative ? 0 - quotient : quotient);
+#endif // __SIZEOF_INT128__
+}
+
+template<typename T>
+const unsigned xoins::ModifierProgram<T>::MaxStack;
+template<typename T>
+const unsigned xoins::ModifierProgram<T>::MaxNesting;
+template<typename T>
+const unsigned xoins::ModifierProgram<T>::MaxDepth;
+
+template<typename T>
+xoins::ModifierProgram<T>::ModifierProgram()
+: m_Linear(true)
+{
+  Instruction base = { ModifierPushBase, T(), T() };
+  m_Instructions.push_back(base);
+}
+
+template<typename T>
+bool xoins::ModifierProgram<T>::Compile(const char* text, std::string* outError) {
+  std::vector<Instruction> instructions;
+  std::string error;
+  internal::ModifierCompiler<T> compiler(text ? text : "");
+  if(!compiler.Compile(instructions, error)) {
+    if(outError)
+      *outError = error;
+    return false;
+  }
+  m_Instructions.swap(instructions);
+  m_Linear = IsLinear(m_Instructions.data(), m_Instructions.size());
+  return true;
+}
+
+template<typename T>
+T xoins::ModifierProgram<T>::Evaluate(const T& base) const {
+  return Run(m_Instructions.data(), m_Instructions.size(), m_Linear, base);
+}
+
+template<typename T>
+T xoins::ModifierProgram<T>::Run(const Instruction* instructions, size_t count, bool linear, const T& base) {
+  const Instruction* instruction = instructions;
+  const Instruction* end = instruction + count;
+  if(linear) {
+    T value = base;
+    for(++instruction; instruction != end; ++instruction)
+      Apply(*instruction, value);
+    return value;
+  }
+
+  T stack[MaxStack];
+  T* top = stack - 1;
+  for(; instruction != end; ++instruction) {
+    switch(instruction->op) {
+    case ModifierPushBase:      *++top = base; break;
+    case ModifierPushConstant:  *++top = instruction->constant; break;
+    case ModifierAdd:           top[-1] = top[-1] + top[0]; --top; break;
+    case ModifierSubtract:      top[-1] = top[-1] - top[0]; --top; break;
+    case ModifierMultiply:      top[-1] = top[-1] * top[0]; --top; break;
+    case ModifierDivide:        top[-1] = ModifierTraits<T>::Divide(top[-1], top[0]); --top; break;
+    case ModifierMin:           top[-1] = top[0] < top[-1] ? top[0] : top[-1]; --top; break;
+    case ModifierMax:           top[-1] = top[-1] < top[0] ? top[0] : top[-1]; --top; break;
+    case ModifierClamp:
+      top[-2] = top[-2] < top[-1] ? top[-1] : (top[0] < top[-2] ? top[0] : top[-2]);
+      top -= 2;
+      break;
+    default:                    Apply(*instruction, *top); break;
+    }
+  }
+  return *top;
+}
+
+template<typename T>
+void xoins::ModifierProgram<T>::Apply(const Instruction& instruction, T& top) {
+  const T& constant = instruction.constant;
+  switch(instruction.op) {
+  case ModifierNegate:                top = T() - top; break;
+  case ModifierAddConstant:           top = top + constant; break;
+  case ModifierSubtractFromConstant:  top = constant - top; break;
+  case ModifierMultiplyConstant:      top = top * constant; break;
+  case ModifierDivideConstant:        top = ModifierTraits<T>::Divide(top, constant); break;
+  case ModifierDivideIntoConstant:    top = ModifierTraits<T>::Divide(constant, top); break;
+  case ModifierMinConstant:           top = constant < top ? constant : top; break;
+  case ModifierMaxConstant:           top = top < constant ? constant : top; break;
+  case ModifierClampConstant:
+    if(top < constant)
+      top = constant;
+    else if(instruction.constant2 < top)
+      top = instruction.constant2;
+    break;
+  default: break; // stack ops are handled by Evaluate.
+  }
+}
+
+template<typename T>
+bool xoins::ModifierProgram<T>::IsLinear() const {
+  return m_Linear;
+}
+
+template<typename T>
+bool xoins::ModifierProgram<T>::IsLinear(const Instruction* instructions, size_t count) {
+  bool linear = count > 0 && instructions[0].op == ModifierPushBase;
+  for(size_t i = 1; i < count; ++i)
+    linear = linear && (instructions[i].op == ModifierNegate || instructions[i].op >= ModifierAddConstant);
+  return linear;
+}
+
+template<typename T>
+const std::vector<typename xoins::ModifierProgram<T>::Instruction>& xoins::ModifierProgram<T>::GetInstructions() const {
+  return m_Instructions;
+}
+
+template<typename T>
+std::function<void(T&)> xoins::ModifierProgram<T>::MakeTransform() const {
+  std::function<void(T&)> transform;
+  if(MakeSimpleTransform(m_Instructions.data(), m_Instructions.size(), m_Linear, transform))
+    return transform;
+  std::shared_ptr<const ModifierProgram> program = std::make_shared<ModifierProgram>(*this);
+  return [program](T& value) { value = program->Evaluate(value); };
+}
+
+template<typename T>
+bool xoins::ModifierProgram<T>::MakeSimpleTransform(const Instruction* instructions, size_t count, bool linear,
+                                                    std::function<void(T&)>& out) {
+  if(linear && count == 1) {
+    out = [](T&) {};
+    return true;
+  }
+  if(linear && count == 2) {
+    const Instruction& only = instructions[1];
+    switch(only.op) {
+    case ModifierAddConstant:       out = MakeAddTransform(only.constant); return true;
+    case ModifierMultiplyConstant:  out = MakeMulTransform(only.constant); return true;
+    case ModifierClampConstant:     out = MakeClampTransform(only.constant, only.constant2); return true;
+    default: break;
+    }
+  }
+  return false;
+}
+
+template<typename T>
+xoins::internal::ModifierCompiler<T>::ModifierCompiler(const char* text)
+: m_Text(text),
+m_Read(text),
+m_Out(nullptr),
+m_Nesting(0),
+m_Depth(0),
+m_MaxDepth(0)
+{
+}
+
+template<typename T>
+bool xoins::internal::ModifierCompiler<T>::Compile(std::vector<typename ModifierProgram<T>::Instruction>& out, std::string& error) {
+  int root = ParseClamp();
+  SkipSpace();
+  if(root >= 0 && *m_Read)
+    root = Fail("unexpected text");
+  if(root < 0) {
+    error = m_Error;
+    return false;
+  }
+
+  m_Out = &out;
+  out.clear();
+  Emit(root);
+  if(m_MaxDepth > ModifierProgram<T>::MaxStack) {
+    error = "the expression is nested too deeply";
+    return false;
+  }
+  return true;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::ParseClamp() {
+  int value = ParseAdditive();
+  while(value >= 0 && AcceptWord("clamp")) {
+    int low = ParseAdditive();
+    if(low < 0)
+      return low;
+    if(!Accept(".."))
+      return Fail("expected '..' in clamp");
+    int high = ParseAdditive();
+    if(high < 0)
+      return high;
+    value = AddNode(NodeClamp, ModifierClamp, value, low, high);
+  }
+  return value;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::ParseAdditive() {
+  int value = ParseTerm();
+  while(value >= 0) {
+    ModifierOp op;
+    if(Accept("+"))
+      op = ModifierAdd;
+    else if(Accept("-"))
+      op = ModifierSubtract;
+    else
+      break;
+    int right = ParseTerm();
+    if(right < 0)
+      return right;
+    value = AddNode(NodeBinary, op, value, right);
+  }
+  return value;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::ParseTerm() {
+  int value = ParseUnary();
+  while(value >= 0) {
+    ModifierOp op;
+    if(Accept("*"))
+      op = ModifierMultiply;
+    else if(Accept("/"))
+      op = ModifierDivide;
+    else
+      break;
+    int right = ParseUnary();
+    if(right < 0)
+      return right;
+    value = AddNode(NodeBinary, op, value, right);
+  }
+  return value;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::ParseUnary() {
+  // every nested '(', min, max and unary '-' comes back through here.
+  if(m_Nesting == ModifierProgram<T>::MaxNesting)
+    return Fail("the expression is nested too deeply");
+  ++m_Nesting;
+  int value;
+  if(Accept("-")) {
+    value = ParseUnary();
+    if(value >= 0)
+      value = AddNode(NodeUnary, ModifierNegate, value);
+  }
+  else {
+    value = ParsePrimary();
+  }
+  --m_Nesting;
+  return value;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::ParsePrimary() {
+  SkipSpace();
+  if(Accept("(")) {
+    int value = ParseClamp();
+    if(value >= 0 && !Accept(")"))
+      return Fail("expected ')'");
+    return value;
+  }
+  if(AcceptWord("base"))
+    return AddNode(NodeBase, ModifierPushBase, -1);
+  bool isMin = AcceptWord("min");
+  if(isMin || AcceptWord("max")) {
+    if(!Accept("("))
+      return Fail("expected '(' after min or max");
+    int a = ParseClamp();
+    if(a < 0)
+      return a;
+    if(!Accept(","))
+      return Fail("expected ','");
+    int b = ParseClamp();
+    if(b < 0)
+      return b;
+    if(!Accept(")"))
+      return Fail("expected ')'");
+    return AddNode(NodeBinary, isMin ? ModifierMin : ModifierMax, a, b);
+  }
+  double number;
+  if(ParseNumber(number))
+    return AddConstant(ModifierTraits<T>::FromNumber(number));
+  if(*m_Read == '\0')
+    return Fail("unexpected end of expression");
+  return Fail("expected a number, 'base', min, max or '('");
+}
+
+template<typename T>
+bool xoins::internal::ModifierCompiler<T>::ParseNumber(double& outNumber) {
+  // parsed by hand so the locale can't change what a '.' means.
+  const char* read = m_Read;
+  if(*read < '0' || *read > '9')
+    return false;
+  double number = 0;
+  for(; *read >= '0' && *read <= '9'; ++read)
+    number = number * 10 + (*read - '0');
+  if(read[0] == '.' && read[1] >= '0' && read[1] <= '9') {
+    double scale = 1;
+    for(++read; *read >= '0' && *read <= '9'; ++read) {
+      number = number * 10 + (*read - '0');
+      scale *= 10;
+    }
+    number /= scale;
+  }
+  m_Read = read;
+  outNumber = number;
+  return true;
+}
+
+template<typename T>
+bool xoins::internal::ModifierCompiler<T>::Accept(const char* token) {
+  SkipSpace();
+  size_t length = std::strlen(token);
+  if(std::strncmp(m_Read, token, length) != 0)
+    return false;
+  m_Read += length;
+  return true;
+}
+
+template<typename T>
+bool xoins::internal::ModifierCompiler<T>::AcceptWord(const char* word) {
+  SkipSpace();
+  size_t length = std::strlen(word);
+  if(std::strncmp(m_Read, word, length) != 0)
+    return false;
+  char next = m_Read[length];
+  if((next >= 'a' && next <= 'z') || (next >= 'A' && next <= 'Z') || (next >= '0' && next <= '9') || next == '_')
+    return false; // only the start of a longer name.
+  m_Read += length;
+  return true;
+}
+
+template<typename T>
+void xoins::internal::ModifierCompiler<T>::SkipSpace() {
+  while(*m_Read == ' ' || *m_Read == '\t' || *m_Read == '\r' || *m_Read == '\n')
+    ++m_Read;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::Fail(const char* message) {
+  if(m_Error.empty()) // keep the first, innermost error.
+    m_Error = std::string(message) + " at column " + std::to_string((long long)(m_Read - m_Text) + 1);
+  return -1;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::AddConstant(const T& value) {
+  Node node = { NodeConstant, ModifierPushConstant, value, { -1, -1, -1 }, 1 };
+  m_Nodes.push_back(node);
+  return (int)m_Nodes.size() - 1;
+}
+
+template<typename T>
+int xoins::internal::ModifierCompiler<T>::AddNode(NodeKind kind, ModifierOp op, int a, int b, int c) {
+  // fold anything that doesn't depend on base as it's parsed.
+  if(kind == NodeUnary && IsConstant(a))
+    return AddConstant(Fold(ModifierSubtract, T(), m_Nodes[a].value));
+  if(kind == NodeBinary && IsConstant(a) && IsConstant(b))
+    return AddConstant(Fold(op, m_Nodes[a].value, m_Nodes[b].value));
+  if(kind == NodeClamp && IsConstant(a) && IsConstant(b) && IsConstant(c)) {
+    T value = m_Nodes[a].value;
+    const T& low = m_Nodes[b].value;
+    const T& high = m_Nodes[c].value;
+    return AddConstant(value < low ? low : (high < value ? high : value));
+  }
+  Node node = { kind, op, T(), { a, b, c }, 1 };
+  for(int child : node.children)
+    if(child >= 0 && m_Nodes[child].depth >= node.depth)
+      node.depth = m_Nodes[child].depth + 1;
+  // left to right chains (base + 1 + 1 ...) get deeper without nesting anything.
+  if(node.depth > ModifierProgram<T>::MaxDepth)
+    return Fail("the expression is too long");
+  m_Nodes.push_back(node);
+  return (int)m_Nodes.size() - 1;
+}
+
+template<typename T>
+bool xoins::internal::ModifierCompiler<T>::IsConstant(int node) const {
+  return m_Nodes[node].kind == NodeConstant;
+}
+
+template<typename T>
+T xoins::internal::ModifierCompiler<T>::Fold(ModifierOp op, const T& a, const T& b) const {
+  switch(op) {
+  case ModifierAdd:       return a + b;
+  case ModifierSubtract:  return a - b;
+  case ModifierMultiply:  return a * b;
+  case ModifierDivide:    return ModifierTraits<T>::Divide(a, b);
+  case ModifierMin:       return b < a ? b : a;
+  case ModifierMax:       return a < b ? b : a;
+  default:                return a;
+  }
+}
+
+template<typename T>
+void xoins::internal::ModifierCompiler<T>::Emit(int index) {
+  const Node node = m_Nodes[index];
+  int a = node.children[0], b = node.children[1], c = node.children[2];
+  switch(node.kind) {
+  case NodeBase:
+    EmitOp(ModifierPushBase, 1);
+    break;
+  case NodeConstant:
+    EmitOp(ModifierPushConstant, 1, node.value);
+    break;
+  case NodeUnary:
+    Emit(a);
+    EmitOp(ModifierNegate, 0);
+    break;
+  case NodeBinary:
+    if(IsConstant(b)) {
+      Emit(a);
+      const T& constant = m_Nodes[b].value;
+      switch(node.op) {
+      case ModifierAdd:       EmitOp(ModifierAddConstant, 0, constant); break;
+      case ModifierSubtract:  EmitOp(ModifierAddConstant, 0, Fold(ModifierSubtract, T(), constant)); break;
+      case ModifierMultiply:  EmitOp(ModifierMultiplyConstant, 0, constant); break;
+      case ModifierDivide:    EmitOp(ModifierDivideConstant, 0, constant); break;
+      case ModifierMin:       EmitOp(ModifierMinConstant, 0, constant); break;
+      default:                EmitOp(ModifierMaxConstant, 0, constant); break;
+      }
+    }
+    else if(IsConstant(a)) {
+      Emit(b);
+      const T& constant = m_Nodes[a].value;
+      switch(node.op) {
+      case ModifierAdd:       EmitOp(ModifierAddConstant, 0, constant); break;
+      case ModifierSubtract:  EmitOp(ModifierSubtractFromConstant, 0, constant); break;
+      case ModifierMultiply:  EmitOp(ModifierMultiplyConstant, 0, constant); break;
+      case ModifierDivide:    EmitOp(ModifierDivideIntoConstant, 0, constant); break;
+      case ModifierMin:       EmitOp(ModifierMinConstant, 0, constant); break;
+      default:                EmitOp(ModifierMaxConstant, 0, constant); break;
+      }
+    }
+    else {
+      Emit(a);
+      Emit(b);
+      EmitOp(node.op, -1);
+    }
+    break;
+  case NodeClamp:
+    Emit(a);
+    if(IsConstant(b) && IsConstant(c)) {
+      EmitOp(ModifierClampConstant, 0, m_Nodes[b].value, m_Nodes[c].value);
+    }
+    else {
+      Emit(b);
+      Emit(c);
+      EmitOp(ModifierClamp, -2);
+    }
+    break;
+  }
+}
+
+template<typename T>
+void xoins::internal::ModifierCompiler<T>::EmitOp(ModifierOp op, int stackChange, const T& constant, const T& constant2) {
+  std::vector<typename ModifierProgram<T>::Instruction>& out = *m_Out;
+  // fuse runs of constant adds or multiplies into one.
+  if(!out.empty() && out.back().op == op) {
+    if(op == ModifierAddConstant) {
+      out.back().constant = out.back().constant + constant;
+      return;
+    }
+    if(op == ModifierMultiplyConstant) {
+      out.back().constant = out.back().constant * constant;
+      return;
+    }
+  }
+  typename ModifierProgram<T>::Instruction instruction = { op, constant, constant2 };
+  out.push_back(instruction);
+  m_Depth += stackChange;
+  m_MaxDepth = std::max(m_MaxDepth, m_Depth);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Modifier tables
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+bool xoins::CompileModifierTable(const ModifierTableSource* sources, size_t count, std::vector<unsigned char>& out,
+                                 std::string* outError) {
+  typedef typename ModifierProgram<T>::Instruction Instruction;
+  static_assert(std::is_trivially_copyable<T>::value, "modifier tables can only store trivially copyable values");
+  static_assert(alignof(Instruction) <= 8, "modifier table instructions are 8 byte aligned");
+
+  std::vector<const ModifierTableSource*> sorted(count);
+  for(size_t i = 0; i < count; ++i)
+    sorted[i] = sources + i;
+  std::sort(sorted.begin(), sorted.end(), [](const ModifierTableSource* a, const ModifierTableSource* b) {
+    return a->id < b->id;
+  });
+
+  std::vector<ModifierTableEntry> entries(count);
+  std::vector<Instruction> instructions;
+  ModifierProgram<T> program;
+  std::string error;
+  for(size_t i = 0; i < count; ++i) {
+    const ModifierTableSource& source = *sorted[i];
+    if(i > 0 && sorted[i - 1]->id == source.id)
+      error = "id used more than once";
+    else if(program.Compile(source.text, &error) && program.GetInstructions().size() > UINT16_MAX)
+      error = "program too long";
+    if(!error.empty()) {
+      if(outError)
+        *outError = "modifier " + std::to_string(source.id) + ": " + error;
+      return false;
+    }
+    const std::vector<Instruction>& compiled = program.GetInstructions();
+    ModifierTableEntry& entry = entries[i];
+    entry.id = source.id;
+    entry.priority = source.priority;
+    entry.firstInstruction = (uint32_t)instructions.size();
+    entry.instructionCount = (uint16_t)compiled.size();
+    entry.linear = program.IsLinear() ? 1 : 0;
+    entry.reserved = 0;
+    instructions.insert(instructions.end(), compiled.begin(), compiled.end());
+  }
+
+  using namespace internal;
+  ModifierTableHeader header = { ModifierTableMagic, ModifierTableVersion, (uint16_t)sizeof(Instruction),
+                                 (uint32_t)count, (uint32_t)instructions.size() };
+  size_t start = out.size();
+  size_t entryOffset = AlignSnapshotOffset(sizeof(header));
+  size_t instructionOffset = AlignSnapshotOffset(entryOffset + count * sizeof(ModifierTableEntry));
+  out.resize(start + instructionOffset + instructions.size() * sizeof(Instruction), 0);
+  unsigned char* base = out.data() + start;
+  std::memcpy(base, &header, sizeof(header));
+  if(count)
+    std::memcpy(base + entryOffset, entries.data(), count * sizeof(ModifierTableEntry));
+  // field by field, so padding in the file stays zero and tables build reproducibly.
+  for(size_t i = 0; i < instructions.size(); ++i) {
+    unsigned char* instruction = base + instructionOffset + i * sizeof(Instruction);
+    std::memcpy(instruction + offsetof(Instruction, op), &instructions[i].op, sizeof(ModifierOp));
+    std::memcpy(instruction + offsetof(Instruction, constant), &instructions[i].constant, sizeof(T));
+    std::memcpy(instruction + offsetof(Instruction, constant2), &instructions[i].constant2, sizeof(T));
+  }
+  return true;
+}
+
+template<typename T>
+xoins::ModifierTableView<T>::ModifierTableView()
+: m_Count(0),
+m_Entries(nullptr),
+m_Instructions(nullptr)
+{
+}
+
+template<typename T>
+xoins::ModifierTableView<T>::ModifierTableView(const void* bytes, size_t size)
+: m_Count(0),
+m_Entries(nullptr),
+m_Instructions(nullptr)
+{
+  const internal::ModifierTableHeader* header = static_cast<const internal::ModifierTableHeader*>(bytes);
+  if(!bytes || size < sizeof(internal::ModifierTableHeader) ||
+     header->magic != internal::ModifierTableMagic ||
+     header->version != internal::ModifierTableVersion ||
+     header->instructionSize != sizeof(Instruction))
+    return;
+  const unsigned char* base = static_cast<const unsigned char*>(bytes);
+  size_t entryOffset = internal::AlignSnapshotOffset(sizeof(internal::ModifierTableHeader));
+  size_t instructionOffset = internal::AlignSnapshotOffset(entryOffset + (size_t)header->count * sizeof(ModifierTableEntry));
+  size_t end = instructionOffset + (size_t)header->instructionCount * sizeof(Instruction);
+  if(end > size)
+    return;
+  const ModifierTableEntry* entries = reinterpret_cast<const ModifierTableEntry*>(base + entryOffset);
+  const Instruction* instructions = reinterpret_cast<const Instruction*>(base + instructionOffset);
+  for(uint32_t i = 0; i < header->count; ++i) {
+    const ModifierTableEntry& entry = entries[i];
+    if((i > 0 && entries[i - 1].id >= entry.id) ||
+       entry.firstInstruction > header->instructionCount ||
+       entry.instructionCount > header->instructionCount - entry.firstInstruction ||
+       !internal::ValidateModifierProgram<T>(instructions + entry.firstInstruction, entry.instructionCount) ||
+       (entry.linear != 0) != ModifierProgram<T>::IsLinear(instructions + entry.firstInstruction, entry.instructionCount))
+      return;
+  }
+  m_Count = header->count;
+  m_Entries = entries;
+  m_Instructions = instructions;
+}
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// InspectableTransform
-//////////////////////////////////////////////////////////////////////////////////////////
 template<typename T>
-InspectableTransformation<T>::InspectableTransformation() {
+bool xoins::ModifierTableView<T>::IsValid() const {
+  return m_Entries != nullptr;
 }
 
 template<typename T>
-InspectableTransformation<T>::InspectableTransformation(TTransformFunc func,
-                                                        int priority,
-                                                        bool enabled)
-: m_Function(func),
-m_Priority(priority),
-m_Enabled(enabled)
-{
+uint32_t xoins::ModifierTableView<T>::GetCount() const {
+  return m_Count;
 }
 
 template<typename T>
-void InspectableTransformation<T>::Set(TTransformFunc func, int priority, bool enabled) {
-  m_Function = func;
-  m_Priority = priority;
-  m_Enabled = enabled;
+const xoins::ModifierTableEntry* xoins::ModifierTableView<T>::GetEntries() const {
+  return m_Entries;
 }
 
 template<typename T>
-void InspectableTransformation<T>::Enable() {
-  m_Enabled = true;
+const xoins::ModifierTableEntry* xoins::ModifierTableView<T>::Find(uint32_t id) const {
+  const ModifierTableEntry* end = m_Entries + m_Count;
+  const ModifierTableEntry* found = std::lower_bound(m_Entries, end, id, [](const ModifierTableEntry& entry, uint32_t key) {
+    return entry.id < key;
+  });
+  return found != end && found->id == id ? found : nullptr;
 }
 
 template<typename T>
-void InspectableTransformation<T>::Disable() {
-  m_Enabled = false;
+T xoins::ModifierTableView<T>::Evaluate(const ModifierTableEntry& entry, const T& base) const {
+  return ModifierProgram<T>::Run(m_Instructions + entry.firstInstruction, entry.instructionCount, entry.linear != 0, base);
 }
 
 template<typename T>
-bool InspectableTransformation<T>::IsEnabled() const {
-  return m_Enabled;
+std::function<void(T&)> xoins::ModifierTableView<T>::MakeTransform(const ModifierTableEntry& entry) const {
+  const Instruction* instructions = m_Instructions + entry.firstInstruction;
+  uint32_t count = entry.instructionCount;
+  bool linear = entry.linear != 0;
+  std::function<void(T&)> transform;
+  if(ModifierProgram<T>::MakeSimpleTransform(instructions, count, linear, transform))
+    return transform;
+  return [instructions, count, linear](T& value) {
+    value = ModifierProgram<T>::Run(instructions, count, linear, value);
+  };
 }
 
-template <typename T>
-int InspectableTransformation<T>::GetPriority() const {
-  return m_Priority;
+template<typename T>
+template<typename THook>
+bool xoins::ModifierTableView<T>::Bind(uint32_t id, InspectableTransformation<T, THook>& transformation) const {
+  const ModifierTableEntry* entry = Find(id);
+  if(!entry)
+    return false;
+  transformation.Set(MakeTransform(*entry), entry->priority, transformation.IsEnabled());
+  transformation.SetDefinitionId(id);
+  return true;
 }
 
 template<typename T>
-void InspectableTransformation<T>::operator ()(T& input) {
-  m_Function(input);
+bool xoins::internal::ValidateModifierProgram(const typename ModifierProgram<T>::Instruction* instructions, size_t count) {
+  typedef typename std::underlying_type<ModifierOp>::type TOp;
+  unsigned depth = 0;
+  for(size_t i = 0; i < count; ++i) {
+    TOp op; // read as an integer, since a corrupt table can hold anything.
+    std::memcpy(&op, &instructions[i].op, sizeof(op));
+    unsigned pops = 0, pushes = 0;
+    switch(op) {
+    case ModifierPushBase:
+    case ModifierPushConstant:  pushes = 1; break;
+    case ModifierAdd:
+    case ModifierSubtract:
+    case ModifierMultiply:
+    case ModifierDivide:
+    case ModifierMin:
+    case ModifierMax:           pops = 2; pushes = 1; break;
+    case ModifierClamp:         pops = 3; pushes = 1; break;
+    case ModifierNegate:
+    case ModifierAddConstant:
+    case ModifierSubtractFromConstant:
+    case ModifierMultiplyConstant:
+    case ModifierDivideConstant:
+    case ModifierDivideIntoConstant:
+    case ModifierMinConstant:
+    case ModifierMaxConstant:
+    case ModifierClampConstant: pops = 1; pushes = 1; break;
+    default:                    return false;
+    }
+    if(depth < pops)
+      return false;
+    depth = depth - pops + pushes;
+    if(depth > ModifierProgram<T>::MaxStack)
+      return false;
+  }
+  return depth == 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableWorldHash
+//////////////////////////////////////////////////////////////////////////////////////////
+inline uint64_t xoins::internal::Mix64(uint64_t value) {
+  // the splitmix64 finalizer.
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
 }
 
 template<typename T>
-const std::function<void(T&)>& InspectableTransformation<T>::GetTransformFunc() const {
-  return m_Function;
+uint64_t xoins::internal::HashValueBits(uint64_t key, const T& value) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+  uint64_t hash = Mix64(key);
+  for(size_t offset = 0; offset < sizeof(T); offset += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes + offset, std::min(sizeof(uint64_t), sizeof(T) - offset));
+    hash = Mix64(hash ^ word);
+  }
+  return hash;
+}
+
+template<typename T, typename TPolicy>
+InspectableWorldHash<T, TPolicy>::InspectableWorldHash()
+: m_Hash(0)
+{
+}
+
+template<typename T, typename TPolicy>
+void InspectableWorldHash<T, TPolicy>::Track(TInspectable* inspectable, uint64_t key, unsigned group) {
+  if(!inspectable) // we don't track null inspectables.
+    return;
+  Untrack(inspectable);
+  Entry entry;
+  entry.key = key;
+  entry.contribution = xoins::internal::HashValueBits(key, inspectable->GetCachedValue());
+  entry.group = group;
+  m_Entries[inspectable] = entry;
+  Add(entry.contribution, group);
+}
+
+template<typename T, typename TPolicy>
+void InspectableWorldHash<T, TPolicy>::Untrack(TInspectable* inspectable) {
+  auto found = m_Entries.find(inspectable);
+  if(found == m_Entries.end())
+    return;
+  Subtract(found->second.contribution, found->second.group);
+  m_Entries.erase(found);
+}
+
+template<typename T, typename TPolicy>
+uint64_t InspectableWorldHash<T, TPolicy>::GetHash() const {
+  return m_Hash;
+}
+
+template<typename T, typename TPolicy>
+uint64_t InspectableWorldHash<T, TPolicy>::GetGroupHash(unsigned group) const {
+  return group < m_Groups.size() ? m_Groups[group] : 0;
+}
+
+template<typename T, typename TPolicy>
+unsigned InspectableWorldHash<T, TPolicy>::GetGroupCount() const {
+  return (unsigned)m_Groups.size();
+}
+
+template<typename T, typename TPolicy>
+void InspectableWorldHash<T, TPolicy>::OnChanged(TInspectable* inspectable) {
+  auto found = m_Entries.find(inspectable);
+  if(found == m_Entries.end())
+    return;
+  Entry& entry = found->second;
+  // identity and transformation changes land here too, they just hash the same.
+  uint64_t contribution = xoins::internal::HashValueBits(entry.key, inspectable->GetCachedValue());
+  if(contribution == entry.contribution)
+    return;
+  Subtract(entry.contribution, entry.group);
+  Add(contribution, entry.group);
+  entry.contribution = contribution;
+}
+
+template<typename T, typename TPolicy>
+void InspectableWorldHash<T, TPolicy>::OnDestroyed(TInspectable* inspectable) {
+  Untrack(inspectable);
+}
+
+template<typename T, typename TPolicy>
+void InspectableWorldHash<T, TPolicy>::Add(uint64_t contribution, unsigned group) {
+  if(group >= m_Groups.size())
+    m_Groups.resize(group + 1, 0);
+  m_Groups[group] += contribution;
+  m_Hash += contribution;
+}
+
+template<typename T, typename TPolicy>
+void InspectableWorldHash<T, TPolicy>::Subtract(uint64_t contribution, unsigned group) {
+  m_Groups[group] -= contribution;
+  m_Hash -= contribution;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Inspectable
+// InspectableFrameArena
 //////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
-Inspectable<T>::Inspectable() {}
+template<typename T, typename TPolicy>
+InspectableFrameArena<T, TPolicy>::InspectableFrameArena() {
+}
 
-template<typename T>
-Inspectable<T>::Inspectable(T identity) : m_Identity(identity), m_LastValue(identity) {
+template<typename T, typename TPolicy>
+InspectableFrameArena<T, TPolicy>::~InspectableFrameArena() {
+  EndFrame();
 }
 
-template<typename T>
-Inspectable<T>& Inspectable<T>::AddTransformation(TTransform& outTransformation,
-                                                  TTransformFunc func,
-                                                  int priority,
-                                                  bool enabled,
-                                                  bool andUpdate) {
-  outTransformation.Set(func, priority, enabled);
-  return AddTransformation(&outTransformation, andUpdate);
+template<typename T, typename TPolicy>
+typename InspectableFrameArena<T, TPolicy>::TTransform*
+InspectableFrameArena<T, TPolicy>::Add(TInspectable& inspectable, TTransformFunc func, int priority, bool andUpdate) {
+  TTransform* transformation = Allocate();
+  transformation->Set(func, priority);
+  return Attach(inspectable, transformation, andUpdate);
 }
 
-template<typename T>
-Inspectable<T>& Inspectable<T>::AddTransformation(TTransform* transformation,
-                                                  bool andUpdate) {
-  if(transformation == nullptr) // we don't store null transformations.
-    return *this;
-  m_Transformations.xoins_list_add(transformation);
-  SortTransformations();
-  if(andUpdate)
-    ForceUpdate();
-  return *this;
+template<typename T, typename TPolicy>
+typename InspectableFrameArena<T, TPolicy>::TTransform*
+InspectableFrameArena<T, TPolicy>::Add(TInspectable& inspectable,
+                                       InspectableTransformDefinition<T>& definition,
+                                       int priority,
+                                       bool andUpdate) {
+  TTransform* transformation = Allocate();
+  transformation->Set(definition, priority);
+  return Attach(inspectable, transformation, andUpdate);
 }
 
-template<typename T>
-Inspectable<T>& Inspectable<T>::AddTransformationUnique(TTransform* transformation,
-                                                        bool andUpdate) {
-  if(transformation == nullptr) // we don't store null transformations.
-    return *this;
-  auto found = std::find(m_Transformations.begin(), m_Transformations.end(), transformation);
-  if(found == m_Transformations.end()) {
-    m_Transformations.xoins_list_add(transformation);
-    SortTransformations();
-    if(andUpdate) // only update when a transformation was actually added.
-      ForceUpdate();
-  }
-  return *this;
+template<typename T, typename TPolicy>
+typename InspectableFrameArena<T, TPolicy>::TTransform*
+InspectableFrameArena<T, TPolicy>::Add(TInspectable& inspectable, const xoins::TransformOp<T>& op, int priority, bool andUpdate) {
+  TTransform* transformation = Allocate();
+  transformation->Set(op, priority);
+  return Attach(inspectable, transformation, andUpdate);
 }
 
-template<typename T>
-void Inspectable<T>::RemoveTransformation(TTransform* transformation,
-                                          bool andUpdate) {
-  if(transformation == nullptr) // we don't store null transformations.
+template<typename T, typename TPolicy>
+void InspectableFrameArena<T, TPolicy>::EndFrame() {
+  if(m_Records.empty())
     return;
-  auto found = std::find(m_Transformations.begin(), m_Transformations.end(), transformation);
-  if(found != m_Transformations.end()) {
-    m_Transformations.xoins_list_erase(found);
-    if(andUpdate) // only update when a transformation was actually removed.
-      ForceUpdate();
+  // group the transformations by Inspectable, so each one changes once.
+  std::sort(m_Records.begin(), m_Records.end(), RecordPredicate);
+  for(size_t i = 0; i < m_Records.size(); ) {
+    TInspectable* inspectable = m_Records[i].inspectable;
+    m_Removing.clear();
+    // a destroyed Inspectable unregistered from its transformations, and one since built
+    // at the same address never registered with these.
+    for(; i < m_Records.size() && m_Records[i].inspectable == inspectable; ++i)
+      if(m_Records[i].transformation->m_Owners.Contains(inspectable))
+        m_Removing.push_back(m_Records[i].transformation);
+    if(m_Removing.empty())
+      continue;
+    inspectable->RemoveTransformations(m_Removing.data(), m_Removing.data() + m_Removing.size());
+    inspectable->MarkDirty();
   }
+  // every slot is free again. They're reset as they're handed out.
+  m_Records.clear();
 }
 
-template<typename T>
-bool Inspectable<T>::ContainsTransformation(TTransform* transformation) const {
-  if(!transformation) // we don't store null transformations.
-    return false;
-  auto found = std::find(m_Transformations.begin(), m_Transformations.end(), transformation);
-  return found != m_Transformations.end();
+template<typename T, typename TPolicy>
+size_t InspectableFrameArena<T, TPolicy>::GetCount() const {
+  return m_Records.size();
 }
 
-template<typename T>
-Inspectable<T>& Inspectable<T>::AddOnIdentityChanged(TValueChangedFunc* f) {
-  if(f && *f) // we don't store null or targetless functions
-    m_IdentityChanged.xoins_list_add(f);
-  return *this;
+template<typename T, typename TPolicy>
+typename InspectableFrameArena<T, TPolicy>::TTransform* InspectableFrameArena<T, TPolicy>::Allocate() {
+  size_t index = m_Records.size();
+  if(index / ChunkSize == m_Chunks.size())
+    m_Chunks.push_back(std::unique_ptr<TTransform[]>(new TTransform[ChunkSize]));
+  TTransform* transformation = &m_Chunks[index / ChunkSize][index % ChunkSize];
+  // Set doesn't reset what the last frame's user may have changed.
+  transformation->SetDefinitionId(0);
+  transformation->SetToggle(nullptr);
+  transformation->SetContextMask(xoins::AllContexts);
+  transformation->SetAbsorbing(false);
+  return transformation;
 }
 
-template<typename T>
-Inspectable<T>& Inspectable<T>::AddOnIdentityChangedUnique(TValueChangedFunc* f) {
-  if(f && *f) { // we don't store null or targetless functions
-    auto found = std::find(m_IdentityChanged.begin(), m_IdentityChanged.end(), f);
-    if(found == m_IdentityChanged.end())
-      m_IdentityChanged.xoins_list_add(f);
-  }
-  return *this;
+template<typename T, typename TPolicy>
+typename InspectableFrameArena<T, TPolicy>::TTransform*
+InspectableFrameArena<T, TPolicy>::Attach(TInspectable& inspectable, TTransform* transformation, bool andUpdate) {
+  Record record;
+  record.inspectable = &inspectable;
+  record.transformation = transformation;
+  m_Records.push_back(record);
+  inspectable.AddTransformation(transformation, andUpdate);
+  if(!andUpdate && !inspectable.IsShadowed(transformation))
+    inspectable.MarkDirty();
+  return transformation;
 }
 
-template<typename T>
-void Inspectable<T>::RemoveOnIdentityChanged(TValueChangedFunc* f) {
-  if(f && *f) { // we don't store null or targetless functions
-    auto found = std::find(m_IdentityChanged.begin(), m_IdentityChanged.end(), f);
-    if(found != m_IdentityChanged.end())
-      m_IdentityChanged.xoins_list_erase(found);
-  }
+template<typename T, typename TPolicy>
+bool InspectableFrameArena<T, TPolicy>::RecordPredicate(const Record& a, const Record& b) {
+  return std::less<TInspectable*>()(a.inspectable, b.inspectable);
 }
 
-template<typename T>
-bool Inspectable<T>::ContainsOnIdentityChanged(TValueChangedFunc* f) const {
-  if(f && *f) { // we don't store null or targetless functions
-    auto found = std::find(m_IdentityChanged.begin(), m_IdentityChanged.end(), f);
-    return found != m_IdentityChanged.end();
-  }
-  return false;
+//////////////////////////////////////////////////////////////////////////////////////////
+// InspectableSourceIndex
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename TPolicy>
+InspectableSourceIndex<T, TPolicy>::InspectableSourceIndex()
+: m_FreeHead(None)
+, m_Count(0)
+{
 }
 
-template<typename T>
-Inspectable<T>& Inspectable<T>::AddOnValueChanged(TValueChangedFunc* f) {
-  if(f && *f) // we don't store null or targetless functions
-    m_ValueChanged.xoins_list_add(f);
-  return *this;
+template<typename T, typename TPolicy>
+InspectableSourceIndex<T, TPolicy>::~InspectableSourceIndex() {
+  Clear();
 }
 
-template<typename T>
-Inspectable<T>& Inspectable<T>::AddOnValueChangedUnique(TValueChangedFunc* f) {
-  if(f && *f) { // we don't store null or targetless functions
-    auto found = std::find(m_ValueChanged.begin(), m_ValueChanged.end(), f);
-    if(found == m_ValueChanged.end())
-      m_ValueChanged.xoins_list_add(f);
+template<typename T, typename TPolicy>
+typename InspectableSourceIndex<T, TPolicy>::TTransform*
+InspectableSourceIndex<T, TPolicy>::Add(uint64_t sourceId,
+                                        TInspectable& inspectable,
+                                        TTransformFunc func,
+                                        int priority,
+                                        bool andUpdate) {
+  uint32_t index = Allocate();
+  GetTransform(index).Set(func, priority);
+  return Attach(sourceId, inspectable, index, andUpdate);
+}
+
+template<typename T, typename TPolicy>
+typename InspectableSourceIndex<T, TPolicy>::TTransform*
+InspectableSourceIndex<T, TPolicy>::Add(uint64_t sourceId,
+                                        TInspectable& inspectable,
+                                        InspectableTransformDefinition<T>& definition,
+                                        int priority,
+                                        bool andUpdate) {
+  uint32_t index = Allocate();
+  GetTransform(index).Set(definition, priority);
+  return Attach(sourceId, inspectable, index, andUpdate);
+}
+
+template<typename T, typename TPolicy>
+typename InspectableSourceIndex<T, TPolicy>::TTransform*
+InspectableSourceIndex<T, TPolicy>::Add(uint64_t sourceId,
+                                        TInspectable& inspectable,
+                                        const xoins::TransformOp<T>& op,
+                                        int priority,
+                                        bool andUpdate) {
+  uint32_t index = Allocate();
+  GetTransform(index).Set(op, priority);
+  return Attach(sourceId, inspectable, index, andUpdate);
+}
+
+template<typename T, typename TPolicy>
+size_t InspectableSourceIndex<T, TPolicy>::RemoveAllFromSource(uint64_t sourceId) {
+  auto found = m_SourceHeads.find(sourceId);
+  if(found == m_SourceHeads.end())
+    return 0;
+  m_Gathered.clear();
+  for(uint32_t index = found->second; index != None; index = m_Slots[index].bySource.next) {
+    Gathered gathered = { m_Slots[index].inspectable, index };
+    m_Gathered.push_back(gathered);
   }
-  return *this;
+  return RemoveGathered();
 }
 
-template<typename T>
-void Inspectable<T>::RemoveOnValueChanged(TValueChangedFunc* f) {
-  if(f && *f) { // we don't store null or targetless functions
-    auto found = std::find(m_ValueChanged.begin(), m_ValueChanged.end(), f);
-    if(found != m_ValueChanged.end())
-      m_ValueChanged.xoins_list_erase(found);
+template<typename T, typename TPolicy>
+size_t InspectableSourceIndex<T, TPolicy>::Remove(uint64_t sourceId, TInspectable& inspectable) {
+  auto found = m_InspectableHeads.find(&inspectable);
+  if(found == m_InspectableHeads.end())
+    return 0;
+  m_Gathered.clear();
+  for(uint32_t index = found->second; index != None; index = m_Slots[index].byInspectable.next) {
+    if(m_Slots[index].source == sourceId) {
+      Gathered gathered = { &inspectable, index };
+      m_Gathered.push_back(gathered);
+    }
   }
+  return m_Gathered.empty() ? 0 : RemoveGathered();
 }
 
-template<typename T>
-bool Inspectable<T>::ContainsOnValueChanged(TValueChangedFunc* f) const {
-  if(f && *f) { // we don't store null or targetless functions
-    auto found = std::find(m_ValueChanged.begin(), m_ValueChanged.end(), f);
-    return found != m_ValueChanged.end();
+template<typename T, typename TPolicy>
+void InspectableSourceIndex<T, TPolicy>::Clear() {
+  m_Gathered.clear();
+  for(const auto& head : m_InspectableHeads) {
+    for(uint32_t index = head.second; index != None; index = m_Slots[index].byInspectable.next) {
+      Gathered gathered = { head.first, index };
+      m_Gathered.push_back(gathered);
+    }
   }
-  return false;
+  if(!m_Gathered.empty())
+    RemoveGathered();
 }
 
-template<typename T>
-void Inspectable<T>::ForceUpdate()
-{
-  T value = m_Identity;
-  // do a copy here so our m_LastValue can be correct for the duration of all callbacks.
-  T lastValue = m_LastValue;
+template<typename T, typename TPolicy>
+bool InspectableSourceIndex<T, TPolicy>::ContainsSource(uint64_t sourceId) const {
+  return m_SourceHeads.find(sourceId) != m_SourceHeads.end();
+}
 
-  for(auto transform : m_Transformations)
-    // note: having no target is supported, since it can be set after adding
-    // the transform to the inspectable.
-    if(transform->IsEnabled() && (*transform).GetTransformFunc())
-      (*transform)(value);
+template<typename T, typename TPolicy>
+size_t InspectableSourceIndex<T, TPolicy>::GetCount() const {
+  return m_Count;
+}
 
-  m_LastValue = value;
-  if(lastValue != value) {
-    // having no target here is not supported since it could not be updated later.
-    // because of that, no check for unset target is required here (it's done when adding)
-    for(auto func : m_ValueChanged)
-      (*func)(this, lastValue, value);
+template<typename T, typename TPolicy>
+typename InspectableSourceIndex<T, TPolicy>::TTransform& InspectableSourceIndex<T, TPolicy>::GetTransform(uint32_t index) {
+  return m_Chunks[index / ChunkSize][index % ChunkSize];
+}
+
+template<typename T, typename TPolicy>
+uint32_t InspectableSourceIndex<T, TPolicy>::Allocate() {
+  ++m_Count;
+  uint32_t index = m_FreeHead;
+  if(index != None) {
+    m_FreeHead = m_Slots[index].bySource.next;
+  } else {
+    index = (uint32_t)m_Slots.size();
+    m_Slots.push_back(Slot());
+    if(index / ChunkSize == m_Chunks.size())
+      m_Chunks.push_back(std::unique_ptr<TTransform[]>(new TTransform[ChunkSize]));
   }
+  // Set doesn't reset what the slot's last user may have changed.
+  GetTransform(index).SetDefinitionId(0);
+  GetTransform(index).SetToggle(nullptr);
+  GetTransform(index).SetContextMask(xoins::AllContexts);
+  GetTransform(index).SetAbsorbing(false);
+  return index;
 }
 
-template<typename T>
-void Inspectable<T>::SetIdentity(const T& value, bool andUpdate) {
-  if(m_Identity != value) {
-    T last = m_Identity;
-    m_Identity = value;
-    if(andUpdate)
-      ForceUpdate();
-    for(auto onIdentityChanged : m_IdentityChanged)
-      (*onIdentityChanged)(this, last, m_Identity);
+template<typename T, typename TPolicy>
+typename InspectableSourceIndex<T, TPolicy>::TTransform*
+InspectableSourceIndex<T, TPolicy>::Attach(uint64_t sourceId, TInspectable& inspectable, uint32_t index, bool andUpdate) {
+  Slot& slot = m_Slots[index];
+  slot.inspectable = &inspectable;
+  slot.source = sourceId;
+  slot.bySource.prev = None;
+  slot.bySource.next = None;
+  slot.byInspectable.prev = None;
+  slot.byInspectable.next = None;
+  // link at the front of both lists.
+  auto source = m_SourceHeads.insert(std::make_pair(sourceId, index));
+  if(!source.second) {
+    slot.bySource.next = source.first->second;
+    m_Slots[source.first->second].bySource.prev = index;
+    source.first->second = index;
+  }
+  auto owner = m_InspectableHeads.insert(std::make_pair(&inspectable, index));
+  if(!owner.second && !GetTransform(owner.first->second).m_Owners.Contains(&inspectable)) {
+    // what's listed here belonged to a destroyed Inspectable at the same address.
+    ForgetDestroyed(&inspectable);
+    owner = m_InspectableHeads.insert(std::make_pair(&inspectable, index));
   }
+  if(!owner.second) {
+    slot.byInspectable.next = owner.first->second;
+    m_Slots[owner.first->second].byInspectable.prev = index;
+    owner.first->second = index;
+  }
+  TTransform* transformation = &GetTransform(index);
+  inspectable.AddTransformation(transformation, andUpdate);
+  if(!andUpdate && !inspectable.IsShadowed(transformation))
+    inspectable.MarkDirty();
+  return transformation;
 }
 
-template<typename T>
-const T& Inspectable<T>::GetValue(bool andForceUpdate) {
-  if(andForceUpdate)
-    ForceUpdate();
-  return m_LastValue;
+template<typename T, typename TPolicy>
+void InspectableSourceIndex<T, TPolicy>::UnlinkFromSource(uint32_t index) {
+  Slot& slot = m_Slots[index];
+  if(slot.bySource.prev != None)
+    m_Slots[slot.bySource.prev].bySource.next = slot.bySource.next;
+  else if(slot.bySource.next != None)
+    m_SourceHeads[slot.source] = slot.bySource.next;
+  else
+    m_SourceHeads.erase(slot.source);
+  if(slot.bySource.next != None)
+    m_Slots[slot.bySource.next].bySource.prev = slot.bySource.prev;
 }
 
-namespace xoins {
-  namespace internal {
-    template<typename T>
-    bool TransformationPredicate(InspectableTransformation<T>* a, InspectableTransformation<T>*b) {
-      return a->GetPriority() > b->GetPriority();
+template<typename T, typename TPolicy>
+void InspectableSourceIndex<T, TPolicy>::UnlinkFromInspectable(uint32_t index) {
+  Slot& slot = m_Slots[index];
+  if(slot.byInspectable.prev != None)
+    m_Slots[slot.byInspectable.prev].byInspectable.next = slot.byInspectable.next;
+  else if(slot.byInspectable.next != None)
+    m_InspectableHeads[slot.inspectable] = slot.byInspectable.next;
+  else
+    m_InspectableHeads.erase(slot.inspectable);
+  if(slot.byInspectable.next != None)
+    m_Slots[slot.byInspectable.next].byInspectable.prev = slot.byInspectable.prev;
+}
+
+template<typename T, typename TPolicy>
+void InspectableSourceIndex<T, TPolicy>::Free(uint32_t index) {
+  Slot& slot = m_Slots[index];
+  slot.inspectable = nullptr;
+  slot.bySource.next = m_FreeHead;
+  m_FreeHead = index;
+  --m_Count;
+}
+
+template<typename T, typename TPolicy>
+void InspectableSourceIndex<T, TPolicy>::ForgetDestroyed(TInspectable* inspectable) {
+  auto found = m_InspectableHeads.find(inspectable);
+  uint32_t index = found == m_InspectableHeads.end() ? None : found->second;
+  while(index != None) {
+    uint32_t next = m_Slots[index].byInspectable.next;
+    if(!GetTransform(index).m_Owners.Contains(inspectable)) {
+      UnlinkFromSource(index);
+      UnlinkFromInspectable(index);
+      Free(index);
     }
+    index = next;
   }
 }
 
-template<typename T>
-void Inspectable<T>::SortTransformations() {
-  std::sort(m_Transformations.begin(), m_Transformations.end(), xoins::internal::TransformationPredicate<T>);
+template<typename T, typename TPolicy>
+size_t InspectableSourceIndex<T, TPolicy>::RemoveGathered() {
+  // listeners run by the updates may use the index again, so every slot is unlinked
+  // before the first Inspectable changes, and only freed once all of them have.
+  std::vector<Gathered> gathered;
+  std::vector<TTransform*> detaching;
+  gathered.swap(m_Gathered);
+  detaching.swap(m_Detaching);
+  for(const Gathered& entry : gathered) {
+    UnlinkFromSource(entry.index);
+    UnlinkFromInspectable(entry.index);
+  }
+  std::sort(gathered.begin(), gathered.end(), GatheredPredicate);
+  size_t detached = 0;
+  for(size_t i = 0; i < gathered.size(); ) {
+    TInspectable* inspectable = gathered[i].inspectable;
+    detaching.clear();
+    // a destroyed Inspectable let go of its transformations, and one since built at the
+    // same address never held these.
+    for(; i < gathered.size() && gathered[i].inspectable == inspectable; ++i)
+      if(GetTransform(gathered[i].index).m_Owners.Contains(inspectable))
+        detaching.push_back(&GetTransform(gathered[i].index));
+    if(detaching.empty())
+      continue;
+    detached += detaching.size();
+    inspectable->RemoveTransformations(detaching.data(), detaching.data() + detaching.size(), true);
+  }
+  for(const Gathered& entry : gathered)
+    Free(entry.index);
+  gathered.clear();
+  detaching.clear();
+  m_Gathered.swap(gathered); // keep the capacity for next time
+  m_Detaching.swap(detaching);
+  return detached;
+}
+
+template<typename T, typename TPolicy>
+bool InspectableSourceIndex<T, TPolicy>::GatheredPredicate(const Gathered& a, const Gathered& b) {
+  return std::less<TInspectable*>()(a.inspectable, b.inspectable);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// InspectableScopedTransformation
+// Journal
 //////////////////////////////////////////////////////////////////////////////////////////
+static_assert(sizeof(xoins::JournalRecord) == 40, "journal records are meant to stay fixed size");
+static_assert(sizeof(xoins::internal::JournalHeader) <= xoins::internal::JournalRecordsOffset,
+              "the journal header has to fit in front of the records");
+
 template<typename T>
-InspectableScopedTransformation<T>::InspectableScopedTransformation(Inspectable<T>* inspectable, bool updateOnDestroy)
-: m_Inspectable(inspectable),
-m_UpdateOnDestroy(updateOnDestroy)
-{
+uint64_t xoins::internal::JournalBits(const T& value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(T));
+  return bits;
 }
 
 template<typename T>
-InspectableScopedTransformation<T>::InspectableScopedTransformation(Inspectable<T>* inspectable,
-                                                                    TTransformFunc func,
-                                                                    int priority,
-                                                                    bool enabled,
-                                                                    bool andUpdate,
-                                                                    bool updateOnDestroy)
-: m_Inspectable(inspectable),
-m_Transformation(func, priority, enabled),
-m_UpdateOnDestroy(updateOnDestroy)
-{
-  if(m_Inspectable) {
-    m_Inspectable->AddTransformation(&m_Transformation);
-    if(andUpdate)
-      m_Inspectable->ForceUpdate();
-  }
+T xoins::internal::JournalValue(uint64_t bits) {
+  T value;
+  std::memcpy(&value, &bits, sizeof(T));
+  return value;
 }
 
-template<typename T>
-InspectableScopedTransformation<T>::~InspectableScopedTransformation() {
-  if(m_Inspectable) {
-    m_Inspectable->RemoveTransformation(&m_Transformation);
-    if(m_UpdateOnDestroy)
-      m_Inspectable->ForceUpdate();
+inline bool xoins::ReadJournal(const void* bytes, size_t size, std::vector<JournalRecord>& out) {
+  using namespace internal;
+  if(size < JournalRecordsOffset)
+    return false;
+  JournalHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if(header.magic != JournalMagic
+     || header.version != JournalVersion
+     || header.recordSize != sizeof(JournalRecord)
+     || header.capacity > (size - JournalRecordsOffset) / sizeof(JournalRecord))
+    return false;
+
+  const unsigned char* records = static_cast<const unsigned char*>(bytes) + JournalRecordsOffset;
+  size_t first = out.size();
+  for(uint64_t i = 0; i < header.capacity; ++i) {
+    JournalRecord record;
+    std::memcpy(&record, records + i * sizeof(JournalRecord), sizeof(record));
+    if(record.kind != JournalEmpty)
+      out.push_back(record);
   }
+  std::sort(out.begin() + first, out.end(), [](const JournalRecord& a, const JournalRecord& b) {
+    return a.sequence < b.sequence;
+  });
+  return true;
 }
 
-template<typename T>
-void InspectableScopedTransformation<T>::Set(TTransformFunc func,
-                                             int priority,
-                                             bool enabled,
-                                             bool andUpdate) {
-  m_Transformation.Set(func, priority, enabled);
-  if(m_Inspectable && andUpdate)
-    m_Inspectable->ForceUpdate();
+template<typename T, typename TPolicy, typename TResolve>
+void xoins::ReplayJournal(const JournalRecord* records,
+                          size_t count,
+                          uint16_t stream,
+                          std::unordered_map<uint64_t, Inspectable<T, TPolicy> >& inspectables,
+                          TResolve resolve) {
+  typedef typename Inspectable<T, TPolicy>::TTransform TTransform;
+  typedef std::unordered_map<uint64_t, TTransform*> TResolved;
+  // what each recorded transformation was resolved to, per Inspectable, by address.
+  std::unordered_map<uint64_t, TResolved> resolved;
+  for(size_t i = 0; i < count; ++i) {
+    const JournalRecord& record = records[i];
+    if(record.stream != stream)
+      continue;
+    if(record.kind == JournalDestroyed) {
+      inspectables.erase(record.inspectable);
+      resolved.erase(record.inspectable);
+      continue;
+    }
+
+    Inspectable<T, TPolicy>& inspectable = inspectables[record.inspectable];
+    TResolved& attached = resolved[record.inspectable];
+    typename TResolved::iterator found = attached.find(record.transformation);
+    TTransform* existing = found != attached.end() ? found->second : nullptr;
+
+    switch(record.kind) {
+    case JournalIdentity:
+      inspectable.SetIdentity(internal::JournalValue<T>(record.data));
+      break;
+    case JournalValue:
+      inspectable.RestoreState(inspectable.GetIdentity(), internal::JournalValue<T>(record.data));
+      break;
+    case JournalTransformationAdded:
+      if(TTransform* transformation = resolve(record)) {
+        transformation->SetPriority(record.priority);
+        if(record.enabled)
+          transformation->Enable();
+        else
+          transformation->Disable();
+        transformation->SetDefinitionId((unsigned)record.data);
+        inspectable.AddTransformation(transformation);
+        attached[record.transformation] = transformation;
+      }
+      break;
+    case JournalTransformationRemoved:
+      // null when its add was skipped, or recorded before the ring wrapped.
+      if(existing) {
+        inspectable.RemoveTransformation(existing);
+        attached.erase(found);
+      }
+      break;
+    case JournalTransformationEnabled:
+      if(existing)
+        existing->Enable();
+      break;
+    case JournalTransformationDisabled:
+      if(existing)
+        existing->Disable();
+      break;
+    }
+  }
 }
 
-template<typename T>
-void InspectableScopedTransformation<T>::SetUpdateOnDestroy(bool updateOnDestroy) {
-  m_UpdateOnDestroy = updateOnDestroy;
+#ifdef xoins_journal
+inline xoins::Journal::ThreadBuffer::ThreadBuffer()
+: journal(nullptr),
+count(0)
+{
 }
 
-template<typename T>
-void InspectableScopedTransformation<T>::Enable(bool andUpdate) {
-  m_Transformation.Enable();
-  if(m_Inspectable && andUpdate) {
-    m_Inspectable->ForceUpdate();
-  }
+inline xoins::Journal::ThreadBuffer::~ThreadBuffer() {
+  if(journal)
+    journal->Unbind(*this);
 }
 
-template<typename T>
-void InspectableScopedTransformation<T>::Disable(bool andUpdate) {
-  m_Transformation.Disable();
-  if(m_Inspectable && andUpdate) {
-    m_Inspectable->ForceUpdate();
-  }
+inline xoins::Journal::Journal()
+: m_Records(nullptr),
+m_Capacity(0),
+m_Mapping(nullptr),
+m_MappingSize(0),
+m_Cursor(0),
+m_Sequence(0)
+{
 }
 
-template<typename T>
-bool InspectableScopedTransformation<T>::IsEnabled() const {
-  return m_Transformation.IsEnabled();
+inline xoins::Journal::~Journal() {
+  Close();
 }
 
-template<typename T>
-int InspectableScopedTransformation<T>::GetPriority() const {
-  return m_Transformation.GetPriority();
+inline bool xoins::Journal::Open(const char* path, uint64_t capacity) {
+  Close();
+  if(capacity == 0)
+    return false;
+  size_t size = internal::JournalRecordsOffset + (size_t)capacity * sizeof(JournalRecord);
+  int file = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(file < 0)
+    return false;
+  void* mapping = MAP_FAILED;
+  if(::ftruncate(file, (off_t)size) == 0)
+    mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  ::close(file); // the mapping keeps the file open.
+  if(mapping == MAP_FAILED)
+    return false;
+
+  internal::JournalHeader header;
+  header.magic = internal::JournalMagic;
+  header.version = internal::JournalVersion;
+  header.recordSize = sizeof(JournalRecord);
+  header.capacity = capacity;
+  std::memcpy(mapping, &header, sizeof(header));
+
+  m_Mapping = mapping;
+  m_MappingSize = size;
+  m_Records = reinterpret_cast<JournalRecord*>(static_cast<unsigned char*>(mapping) + internal::JournalRecordsOffset);
+  m_Capacity = capacity;
+  m_Cursor = 0;
+  m_Sequence = 0;
+  return true;
 }
 
-template<typename T>
-const std::function<void(T&)>& InspectableScopedTransformation<T>::GetTransformFunc() const {
-  return m_Transformation.GetTransformFunc();
+inline void xoins::Journal::Close() {
+  {
+    std::lock_guard<std::mutex> lock(m_BuffersMutex);
+    for(ThreadBuffer* buffer : m_Buffers) {
+      Flush(*buffer);
+      buffer->journal = nullptr;
+    }
+    m_Buffers.clear();
+  }
+  if(m_Mapping)
+    ::munmap(m_Mapping, m_MappingSize);
+  m_Mapping = nullptr;
+  m_MappingSize = 0;
+  m_Records = nullptr;
+  m_Capacity = 0;
 }
 
-template<typename T>
-void InspectableScopedTransformation<T>::operator()(T& input) {
-  m_Transformation(input);
+inline bool xoins::Journal::IsOpen() const {
+  return m_Records != nullptr;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// InspectableScopedValueChangedFunc
-//////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
-InspectableScopedValueChangedFunc<T>::InspectableScopedValueChangedFunc()
-: m_Inspectable(nullptr),
-m_OnValueChanged()
-{
+inline void xoins::Journal::Append(JournalRecord record) {
+  if(!m_Records)
+    return;
+  ThreadBuffer& buffer = GetThreadBuffer();
+  if(buffer.journal != this)
+    Bind(buffer);
+  record.sequence = m_Sequence.fetch_add(1, std::memory_order_relaxed);
+  buffer.records[buffer.count++] = record;
+  if(buffer.count == ThreadBufferSize)
+    Flush(buffer);
 }
 
-template<typename T>
-InspectableScopedValueChangedFunc<T>::InspectableScopedValueChangedFunc(Inspectable<T>* inspectable, TValueChangedFunc func)
-: m_Inspectable(inspectable),
-m_OnValueChanged(func)
-{
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnValueChanged(&m_OnValueChanged);
+inline void xoins::Journal::FlushThread() {
+  ThreadBuffer& buffer = GetThreadBuffer();
+  if(buffer.journal == this)
+    Flush(buffer);
 }
 
-template<typename T>
-InspectableScopedValueChangedFunc<T>::~InspectableScopedValueChangedFunc() {
-  if(m_Inspectable && m_OnValueChanged) // todo: ensure all other func assignments check for null.
-    m_Inspectable->RemoveOnValueChanged(&m_OnValueChanged);
+inline xoins::Journal::ThreadBuffer& xoins::Journal::GetThreadBuffer() {
+  static thread_local ThreadBuffer buffer;
+  return buffer;
 }
 
-template<typename T>
-void InspectableScopedValueChangedFunc<T>::Set(Inspectable<T>* inspectable,
-                                               TValueChangedFunc func) {
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->RemoveOnValueChanged(m_OnValueChanged);
-  m_Inspectable = inspectable;
-  m_OnValueChanged = func;
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnValueChanged(func);
+inline void xoins::Journal::Bind(ThreadBuffer& buffer) {
+  if(buffer.journal)
+    buffer.journal->Unbind(buffer);
+  std::lock_guard<std::mutex> lock(m_BuffersMutex);
+  m_Buffers.push_back(&buffer);
+  buffer.journal = this;
 }
 
-template<typename T>
-void InspectableScopedValueChangedFunc<T>::SetInspectable(Inspectable<T>* inspectable) {
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->RemoveOnValueChanged(m_OnValueChanged);
-  m_Inspectable = inspectable;
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnValueChanged(m_OnValueChanged);
+inline void xoins::Journal::Unbind(ThreadBuffer& buffer) {
+  Flush(buffer);
+  std::lock_guard<std::mutex> lock(m_BuffersMutex);
+  m_Buffers.erase(std::find(m_Buffers.begin(), m_Buffers.end(), &buffer));
+  buffer.journal = nullptr;
 }
 
-template<typename T>
-void InspectableScopedValueChangedFunc<T>::SetFunc(TValueChangedFunc func) {
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->RemoveOnValueChanged(m_OnValueChanged);
-  m_OnValueChanged = func;
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnValueChanged(m_OnValueChanged);
+inline void xoins::Journal::Flush(ThreadBuffer& buffer) {
+  if(buffer.count == 0 || !m_Records) {
+    buffer.count = 0;
+    return;
+  }
+  uint64_t first = m_Cursor.fetch_add(buffer.count, std::memory_order_relaxed);
+  for(unsigned i = 0; i < buffer.count; ++i)
+    m_Records[(first + i) % m_Capacity] = buffer.records[i];
+  buffer.count = 0;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// InspectableScopedIdentityChangedFunc
-//////////////////////////////////////////////////////////////////////////////////////////
-template<typename T>
-InspectableScopedIdentityChangedFunc<T>::InspectableScopedIdentityChangedFunc()
-: m_Inspectable(nullptr),
-m_OnValueChanged()
+template<typename T, typename TPolicy>
+InspectableJournal<T, TPolicy>::InspectableJournal(xoins::Journal& journal, uint16_t stream)
+: m_Journal(journal),
+m_Stream(stream)
 {
 }
 
-template<typename T>
-InspectableScopedIdentityChangedFunc<T>::InspectableScopedIdentityChangedFunc(Inspectable<T>* inspectable,
-                                                                              TValueChangedFunc func)
-: m_Inspectable(inspectable),
-m_OnValueChanged(func)
-{
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnIdentityChanged(&m_OnValueChanged);
+template<typename T, typename TPolicy>
+void InspectableJournal<T, TPolicy>::OnBeforeChange(TInspectable* inspectable) {
+  Before& before = GetBefore();
+  before.identity = inspectable->GetIdentity();
+  before.value = inspectable->GetCachedValue();
+  before.transformations.clear();
+  for(auto transformation : inspectable->GetTransformations()) {
+    TransformationState state = { transformation,
+                                  transformation->GetDefinitionId(),
+                                  transformation->GetPriority(),
+                                  transformation->IsEnabled() };
+    before.transformations.push_back(state);
+  }
 }
 
-template<typename T>
-InspectableScopedIdentityChangedFunc<T>::~InspectableScopedIdentityChangedFunc() {
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->RemoveOnIdentityChanged(&m_OnValueChanged);
+template<typename T, typename TPolicy>
+void InspectableJournal<T, TPolicy>::OnChanged(TInspectable* inspectable) {
+  using xoins::internal::JournalBits;
+  const Before& before = GetBefore();
+  if(JournalBits(before.identity) != JournalBits(inspectable->GetIdentity()))
+    Append(inspectable, xoins::JournalIdentity, JournalBits(inspectable->GetIdentity()));
+  if(JournalBits(before.value) != JournalBits(inspectable->GetCachedValue()))
+    Append(inspectable, xoins::JournalValue, JournalBits(inspectable->GetCachedValue()));
+
+  const auto& transformations = inspectable->GetTransformations();
+  for(const TransformationState& state : before.transformations) {
+    bool kept = false;
+    for(auto transformation : transformations)
+      kept = kept || transformation == state.transformation;
+    if(!kept)
+      Append(inspectable, xoins::JournalTransformationRemoved, state.definitionId, state.transformation, state.priority, state.enabled);
+  }
+  for(auto transformation : transformations) {
+    const TransformationState* previous = nullptr;
+    for(const TransformationState& state : before.transformations)
+      if(state.transformation == transformation)
+        previous = &state;
+    bool enabled = transformation->IsEnabled();
+    if(!previous)
+      Append(inspectable, xoins::JournalTransformationAdded, transformation->GetDefinitionId(), transformation, transformation->GetPriority(), enabled);
+    else if(previous->enabled != enabled)
+      Append(inspectable,
+             enabled ? xoins::JournalTransformationEnabled : xoins::JournalTransformationDisabled,
+             transformation->GetDefinitionId(), transformation, transformation->GetPriority(), enabled);
+  }
 }
 
-template<typename T>
-void InspectableScopedIdentityChangedFunc<T>::Set(Inspectable<T>* inspectable,
-                                                  TValueChangedFunc func) {
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->RemoveOnIdentityChanged(m_OnValueChanged);
-  m_Inspectable = inspectable;
-  m_OnValueChanged = func;
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnIdentityChanged(func);
+template<typename T, typename TPolicy>
+void InspectableJournal<T, TPolicy>::OnDestroyed(TInspectable* inspectable) {
+  Append(inspectable, xoins::JournalDestroyed, 0);
 }
 
-template<typename T>
-void InspectableScopedIdentityChangedFunc<T>::SetInspectable(Inspectable<T>* inspectable) {
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->RemoveOnIdentityChanged(m_OnValueChanged);
-  m_Inspectable = inspectable;
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnIdentityChanged(m_OnValueChanged);
+template<typename T, typename TPolicy>
+typename InspectableJournal<T, TPolicy>::Before& InspectableJournal<T, TPolicy>::GetBefore() {
+  // every InspectableJournal of this type would capture the same state, so they share.
+  static thread_local Before before;
+  return before;
 }
 
-template<typename T>
-void InspectableScopedIdentityChangedFunc<T>::SetFunc(TValueChangedFunc func) {
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->RemoveOnIdentityChanged(m_OnValueChanged);
-  m_OnValueChanged = func;
-  if(m_Inspectable && m_OnValueChanged)
-    m_Inspectable->AddOnIdentityChanged(m_OnValueChanged);
+template<typename T, typename TPolicy>
+void InspectableJournal<T, TPolicy>::Append(const TInspectable* inspectable,
+                                            xoins::JournalRecordKind kind,
+                                            uint64_t data,
+                                            const typename TInspectable::TTransform* transformation,
+                                            int32_t priority,
+                                            bool enabled) {
+  xoins::JournalRecord record;
+  record.sequence = 0; // assigned by the journal
+  record.inspectable = (uint64_t)(uintptr_t)inspectable;
+  record.transformation = (uint64_t)(uintptr_t)transformation;
+  record.data = data;
+  record.priority = priority;
+  record.kind = (uint8_t)kind;
+  record.enabled = enabled ? 1 : 0;
+  record.stream = m_Stream;
+  m_Journal.Append(record);
 }
+#endif // xoins_journal
 
 #define FormInspectableTypedef(xoinsType) \
   typedef xoinsType<bool>                 xoinsType##B;\
@@ -755,20 +8162,27 @@ void InspectableScopedIdentityChangedFunc<T>::SetFunc(TValueChangedFunc func) {
 
 FormInspectableTypedef(Inspectable);
 FormInspectableTypedef(InspectableTransformation);
+FormInspectableTypedef(InspectableTransformDefinition);
 FormInspectableTypedef(InspectableScopedTransformation);
+FormInspectableTypedef(InspectableScopedConnection);
 FormInspectableTypedef(InspectableScopedValueChangedFunc);
 FormInspectableTypedef(InspectableScopedIdentityChangedFunc);
+FormInspectableTypedef(InspectableObserver);
+FormInspectableTypedef(InspectableRollback);
+FormInspectableTypedef(InspectableDeltaTracker);
+FormInspectableTypedef(InspectableDeltaWriter);
+FormInspectableTypedef(InspectableDeltaReader);
+FormInspectableTypedef(InspectableTransformSetWriter);
+FormInspectableTypedef(InspectableTransformSetReader);
+FormInspectableTypedef(InspectableWorldHash);
+FormInspectableTypedef(InspectableFrameArena);
+FormInspectableTypedef(InspectableSourceIndex);
+#ifdef xoins_journal
+FormInspectableTypedef(InspectableJournal);
+#endif // xoins_journal
 
 #undef FormInspectableTypedef
 
-#ifdef xoins_list_internal
-#undef xoins_list
-#endif
-
-#ifdef xoins_list_add_internal
-#undef xoins_list_add
-#endif
-
-#ifdef xoins_list_erase_internal
-#undef xoins_list_erase
+#ifdef xoins_inline_transformations_internal
+#undef xoins_inline_transformations
 #endif
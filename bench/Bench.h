@@ -0,0 +1,35 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Bench.h
+//
+//  The few helpers the benchmarks share. Build them in release (the default for this
+//  project) or the numbers mean nothing.
+//////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+namespace xoins_bench {
+  // the best of a few runs of body(), in nanoseconds per operation. body does
+  // 'operations' operations per call.
+  template<typename TBody>
+  double Measure(unsigned operations, TBody body) {
+    double best = 0.0;
+    for(int run = 0; run < 5; ++run) {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      body();
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      double perOperation = elapsed.count() / operations;
+      if(run == 0 || perOperation < best)
+        best = perOperation;
+    }
+    return best;
+  }
+
+  // keeps the compiler from dropping a result nobody reads.
+  template<typename T>
+  void Consume(const T& value) {
+    volatile T sink = value; // a volatile store can't be dropped
+    (void)sink;
+  }
+}
@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Ops.cpp
+//
+//  ForceUpdate over chains of built-in ops (see xoins::TransformOp) against the same
+//  chains written as std::function lambdas, through the default list and through
+//  HotColdPolicy, which runs packed copies of the ops.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Bench.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+  const unsigned InspectableCount = 4096;
+  const unsigned ChainLengths[] = { 1, 2, 4, 8, 16, 32 };
+
+  // the same arithmetic both ways, cycling through a few kinds so the switch has to
+  // branch.
+  void UseOp(InspectableTransformation<float>& transformation, unsigned i) {
+    int priority = (int)(i * 7 % 5);
+    switch(i % 4) {
+    case 0: transformation.Set(xoins::MulOp(1.01f), priority); break;
+    case 1: transformation.Set(xoins::AddOp(1.f), priority); break;
+    case 2: transformation.Set(xoins::MaxOp(-5.f), priority); break;
+    default: transformation.Set(xoins::ClampOp(-1000.f, 1000.f), priority); break;
+    }
+  }
+
+  void UseFunction(InspectableTransformation<float>& transformation, unsigned i) {
+    int priority = (int)(i * 7 % 5);
+    switch(i % 4) {
+    case 0: transformation.Set([](float& value) { value = value * 1.01f; }, priority); break;
+    case 1: transformation.Set([](float& value) { value = value + 1.f; }, priority); break;
+    case 2: transformation.Set([](float& value) { value = value < -5.f ? -5.f : value; }, priority); break;
+    default:
+      transformation.Set([](float& value) { value = value < -1000.f ? -1000.f : (1000.f < value ? 1000.f : value); }, priority);
+      break;
+    }
+  }
+
+  template<typename TPolicy, typename TSet>
+  double Measure(unsigned length, TSet set) {
+    typedef Inspectable<float, TPolicy> TInspectable;
+    typedef InspectableTransformation<float> TTransform;
+
+    std::unique_ptr<TInspectable[]> stats(new TInspectable[InspectableCount]);
+    std::vector<TTransform> transformations(InspectableCount * length);
+    for(unsigned i = 0; i < transformations.size(); ++i)
+      set(transformations[i], i);
+    for(unsigned i = 0; i < InspectableCount; ++i)
+      for(unsigned j = 0; j < length; ++j)
+        stats[i].AddTransformation(&transformations[i * length + j]);
+
+    double update = xoins_bench::Measure(InspectableCount, [&]() {
+      for(int pass = 0; pass < 4; ++pass) {
+        for(unsigned i = 0; i < InspectableCount; ++i)
+          stats[i].ForceUpdate();
+      }
+    }) / 4;
+    xoins_bench::Consume(stats[InspectableCount - 1].GetValue());
+    for(unsigned i = 0; i < InspectableCount; ++i)
+      for(unsigned j = 0; j < length; ++j)
+        stats[i].RemoveTransformation(&transformations[i * length + j]);
+    return update;
+  }
+
+  template<typename TPolicy>
+  void Run(const char* name) {
+    for(unsigned length : ChainLengths) {
+      double functions = Measure<TPolicy>(length, &UseFunction);
+      double ops = Measure<TPolicy>(length, &UseOp);
+      std::printf("%-22s %3u  %14.1f  %10.1f\n", name, length, functions, ops);
+    }
+  }
+}
+
+int main() {
+  std::printf("%-22s %3s  %14s  %10s\n", "policy", "n", "function ns", "op ns");
+  Run<xoins::DefaultListPolicy>("DefaultListPolicy");
+  Run<xoins::HotColdPolicy>("HotColdPolicy");
+  return 0;
+}
@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Policies.cpp
+//
+//  ForceUpdate, and adding then removing a whole chain, for every shipped container
+//  policy at the chain lengths games usually have. Each of the Inspectables has its own
+//  transformations (IntrusiveListPolicy can't share them), added in mixed priorities.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Bench.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+  const unsigned InspectableCount = 4096;
+  const unsigned ChainLengths[] = { 1, 2, 4, 8, 16, 32 };
+
+  template<typename TPolicy>
+  void Run(const char* name) {
+    typedef Inspectable<float, TPolicy> TInspectable;
+    typedef typename TInspectable::TTransform TTransform;
+
+    for(unsigned length : ChainLengths) {
+      std::unique_ptr<TInspectable[]> stats(new TInspectable[InspectableCount]);
+      std::vector<TTransform> transformations(InspectableCount * length);
+      for(unsigned i = 0; i < transformations.size(); ++i)
+        transformations[i].Set([](float& value) { value = value * 1.01f + 1.f; }, (int)(i * 7 % 5));
+
+      unsigned operations = InspectableCount * length;
+      double add = xoins_bench::Measure(operations, [&]() {
+        for(unsigned i = 0; i < InspectableCount; ++i) {
+          TTransform* chain = &transformations[i * length];
+          for(unsigned j = 0; j < length; ++j)
+            stats[i].AddTransformation(chain + j);
+        }
+        for(unsigned i = 0; i < InspectableCount; ++i) {
+          TTransform* chain = &transformations[i * length];
+          for(unsigned j = 0; j < length; ++j)
+            stats[i].RemoveTransformation(chain + j);
+        }
+      });
+
+      for(unsigned i = 0; i < InspectableCount; ++i)
+        for(unsigned j = 0; j < length; ++j)
+          stats[i].AddTransformation(&transformations[i * length + j]);
+      double update = xoins_bench::Measure(InspectableCount, [&]() {
+        for(int pass = 0; pass < 4; ++pass) {
+          for(unsigned i = 0; i < InspectableCount; ++i)
+            stats[i].ForceUpdate();
+        }
+      }) / 4;
+      xoins_bench::Consume(stats[InspectableCount - 1].GetValue());
+      for(unsigned i = 0; i < InspectableCount; ++i)
+        for(unsigned j = 0; j < length; ++j)
+          stats[i].RemoveTransformation(&transformations[i * length + j]);
+
+      std::printf("%-22s %3u  %10.1f  %14.1f\n", name, length, update, add);
+    }
+  }
+}
+
+int main() {
+  std::printf("%-22s %3s  %10s  %14s\n", "policy", "n", "update ns", "add+remove ns");
+  Run<xoins::DefaultListPolicy>("DefaultListPolicy");
+  Run<xoins::VectorPolicy<> >("VectorPolicy");
+  Run<xoins::SmallVectorPolicy<4> >("SmallVectorPolicy<4>");
+  Run<xoins::IntrusiveListPolicy>("IntrusiveListPolicy");
+  Run<xoins::SortedFlatPolicy<> >("SortedFlatPolicy");
+  Run<xoins::HotColdPolicy>("HotColdPolicy");
+  Run<xoins::PriorityBucketPolicy>("PriorityBucketPolicy");
+  return 0;
+}
@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Absorbing.cpp
+//
+//  Changes to transformations shadowed by an active absorbing one don't dirty, update or
+//  drop context values, while changes that can reach the value still do.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+namespace {
+  typedef Inspectable<float, xoins::HotColdPolicy> THotCold;
+
+  const xoins::ContextMask VsPlayers = 1 << 0;
+  const xoins::ContextMask VsMonsters = 1 << 1;
+
+  // 'counted' runs before the stun, so it counts every update.
+  template<typename TInspectable>
+  struct Fixture {
+    Fixture()
+    : stat(10.f),
+    counted([this](float&) { ++updates; }, 100),
+    stun(xoins::SetOp(0.f), 50),
+    buff(xoins::MulOp(2.f)),
+    updates(0)
+    {
+      stun.SetAbsorbing(true);
+      stat.AddTransformation(&counted).AddTransformation(&stun, true).AddTransformation(&buff, true);
+      updates = 0;
+    }
+    ~Fixture() {
+      stat.RemoveTransformation(&counted);
+      stat.RemoveTransformation(&stun);
+      stat.RemoveTransformation(&buff);
+    }
+
+    TInspectable                stat;
+    InspectableTransformationF  counted;
+    InspectableTransformationF  stun;
+    InspectableTransformationF  buff;
+    int                         updates;
+  };
+
+  template<typename TInspectable>
+  void TestShadowedChanges() {
+    Fixture<TInspectable> f;
+    CHECK(f.stat.GetValue() == 0.f);
+    CHECK(f.stat.IsShadowed(&f.buff));
+    CHECK(!f.stat.IsShadowed(&f.stun) && !f.stat.IsShadowed(&f.counted));
+
+    InspectableToggle rules;
+    f.buff.SetToggle(&rules);
+    f.buff.Disable();
+    rules.Disable();
+    f.buff.SetAbsorbing(true);
+    f.buff.SetAbsorbing(false);
+    f.buff.Enable();
+    CHECK(!f.stat.IsDirty());
+
+    InspectableTransformationF late(xoins::AddOp(1.f), -5);
+    f.stat.AddTransformation(&late, true);
+    f.stat.RemoveTransformation(&late, true);
+    InspectableTransformationF* both[] = { &late, &f.buff };
+    f.stat.RemoveTransformations(both, both + 2, true);
+    f.stat.AddTransformations(both, both + 2, true);
+    CHECK(f.updates == 0);
+    CHECK(!f.stat.IsDirty());
+    rules.Enable();
+    CHECK(!f.stat.IsDirty());
+
+    // lifting the stun reaches everything after it again.
+    f.stun.Disable();
+    CHECK(!f.stat.IsShadowed(&f.buff));
+    CHECK(f.stat.GetValue(true) == 21.f);
+    CHECK(f.updates == 1);
+    f.stat.RemoveTransformation(&late, true);
+    CHECK(f.updates == 2 && f.stat.GetValue() == 20.f);
+    rules.Disable();
+    CHECK(f.stat.IsDirty());
+  }
+
+  void TestUnshadowedAddStillUpdates() {
+    Fixture<InspectableF> f;
+    InspectableTransformationF first(xoins::AddOp(1.f), 200);
+    f.stat.AddTransformation(&first, true);
+    CHECK(f.updates == 1);
+    CHECK(f.stat.GetValue() == 0.f);
+    InspectableTransformationF* mixed[] = { &first };
+    f.stat.RemoveTransformations(mixed, mixed + 1, true);
+    CHECK(f.updates == 2);
+  }
+
+  void TestContextShadow() {
+    // the stun only applies against players, so the monster context still sees the buff.
+    InspectableF stat(10.f);
+    InspectableTransformationF stun(xoins::SetOp(0.f), 50), buff(xoins::MulOp(2.f));
+    stun.SetAbsorbing(true);
+    stun.SetContextMask(VsPlayers);
+    stat.AddTransformation(&stun).AddTransformation(&buff, true);
+    CHECK(stat.GetContextValue(VsPlayers) == 0.f);
+    CHECK(stat.GetContextValue(VsMonsters) == 20.f);
+    buff.Set(xoins::MulOp(3.f));
+    CHECK(stat.GetContextValue(VsPlayers) == 0.f);
+    CHECK(stat.GetContextValue(VsMonsters) == 30.f);
+    stat.RemoveTransformation(&stun);
+    stat.RemoveTransformation(&buff);
+  }
+}
+
+int main() {
+  TestShadowedChanges<InspectableF>();
+  TestShadowedChanges<THotCold>();
+  TestUnshadowedAddStillUpdates();
+  TestContextShadow();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Batch.cpp
+//
+//  InspectableBatch deferring updates until the outermost batch ends, and range
+//  removal taking one occurrence per entry, like RemoveTransformation.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+namespace {
+  void TestListenersFireOnceAfterBatch() {
+    InspectableF first(1.f), second(1.f), untouched(1.f);
+    int firstCalls = 0, secondCalls = 0, untouchedCalls = 0;
+    first.ConnectOnValueChanged([&](InspectableF*, const float&, const float&) { ++firstCalls; });
+    second.ConnectOnValueChanged([&](InspectableF*, const float&, const float&) { ++secondCalls; });
+    untouched.ConnectOnValueChanged([&](InspectableF*, const float&, const float&) { ++untouchedCalls; });
+    InspectableTransformationF add(xoins::AddOp(1.f)), mul(xoins::MulOp(3.f)), more(xoins::AddOp(2.f));
+    InspectableTransformationF* both[] = { &add, &mul };
+    {
+      InspectableBatch batch;
+      first.AddTransformations(both, both + 2, true);
+      first.AddTransformation(&more, true);
+      first.SetIdentity(2.f, true);
+      {
+        InspectableBatch nested;
+        second.SetIdentity(5.f, true);
+        second.ForceUpdate();
+      }
+      // only the outermost batch updates, so values read here are still the old ones.
+      CHECK(first.GetValue() == 1.f && second.GetValue() == 1.f);
+      CHECK(firstCalls == 0 && secondCalls == 0);
+      CHECK(first.IsDirty() && second.IsDirty());
+    }
+    CHECK(firstCalls == 1 && secondCalls == 1 && untouchedCalls == 0);
+    CHECK(first.GetValue() == 11.f && second.GetValue() == 5.f);
+    CHECK(!first.IsDirty() && !second.IsDirty());
+    first.RemoveTransformations(both, both + 2);
+    first.RemoveTransformation(&more);
+  }
+
+  void TestRemoveOneOccurrencePerEntry() {
+    InspectableF stat(0.f);
+    InspectableTransformationF one(xoins::AddOp(1.f)), ten(xoins::AddOp(10.f));
+    InspectableTransformationF* chain[] = { &one, &one, &one, &ten };
+    stat.AddTransformations(chain, chain + 4, true);
+    CHECK(stat.GetValue() == 13.f);
+
+    InspectableTransformationF* single[] = { &one };
+    stat.RemoveTransformations(single, single + 1, true);
+    CHECK(stat.GetValue() == 12.f);
+    InspectableTransformationF* twice[] = { &one, &ten, &one };
+    stat.RemoveTransformations(twice, twice + 3, true);
+    CHECK(stat.GetValue() == 0.f && stat.GetTransformations().IsEmpty());
+
+    // more entries than occurrences just removes them all.
+    stat.AddTransformations(chain, chain + 2, true);
+    stat.RemoveTransformations(chain, chain + 3, true);
+    CHECK(stat.GetValue() == 0.f && stat.GetTransformations().IsEmpty());
+  }
+}
+
+int main() {
+  TestListenersFireOnceAfterBatch();
+  TestRemoveOneOccurrencePerEntry();
+  return xoins_test::CheckResult();
+}
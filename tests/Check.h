@@ -0,0 +1,33 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Check.h
+//
+//  The few helpers the tests share. A test is a plain executable: CHECK reports every
+//  failed condition and the test returns CheckResult() from main, so ctest sees a non
+//  zero exit code when anything failed. Unlike assert, CHECK stays on in release builds.
+//////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdio>
+
+namespace xoins_test {
+  inline int& FailureCount() {
+    static int count = 0;
+    return count;
+  }
+
+  inline bool Check(bool condition, const char* expression, const char* file, int line) {
+    if(!condition) {
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+      ++FailureCount();
+    }
+    return condition;
+  }
+
+  inline int CheckResult() {
+    if(FailureCount())
+      std::fprintf(stderr, "%d check(s) failed\n", FailureCount());
+    return FailureCount() ? 1 : 0;
+  }
+}
+
+#define CHECK(condition) xoins_test::Check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,100 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// ContextValues.cpp
+//
+//  Cached context values are only dropped for the masks a change can affect.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+namespace {
+  const xoins::ContextMask VsPlayers = 1 << 0;
+  const xoins::ContextMask VsMonsters = 1 << 1;
+
+  // counts how often the monster context is computed.
+  struct Fixture {
+    Fixture()
+    : stat(10.f),
+    pvp(xoins::MulOp(0.5f)),
+    counted([this](float& value) { ++monsterRuns; value += 1.f; }),
+    monsterRuns(0)
+    {
+      pvp.SetContextMask(VsPlayers);
+      counted.SetContextMask(VsMonsters);
+      stat.AddTransformation(&pvp).AddTransformation(&counted, true);
+    }
+    ~Fixture() {
+      stat.RemoveTransformation(&pvp);
+      stat.RemoveTransformation(&counted);
+    }
+
+    InspectableF                stat;
+    InspectableTransformationF  pvp;
+    InspectableTransformationF  counted;
+    int                         monsterRuns;
+  };
+
+  void TestEnableDropsOnlyItsMasks() {
+    Fixture f;
+    CHECK(f.stat.GetContextValue(VsPlayers) == 5.f);
+    CHECK(f.stat.GetContextValue(VsMonsters) == 11.f);
+    f.monsterRuns = 0;
+
+    f.pvp.Disable();
+    CHECK(f.stat.GetContextValue(VsPlayers) == 10.f); // no ForceUpdate needed
+    CHECK(f.stat.GetContextValue(VsMonsters) == 11.f);
+    CHECK(f.monsterRuns == 0);
+
+    f.stat.ForceUpdate(); // runs the monster transformation for GetValue, and that's all
+    CHECK(f.monsterRuns == 1);
+    CHECK(f.stat.GetContextValue(VsMonsters) == 11.f);
+    CHECK(f.monsterRuns == 1);
+
+    f.pvp.SetAbsorbing(true);
+    f.pvp.Enable();
+    CHECK(f.stat.GetContextValue(VsPlayers) == 5.f);
+    CHECK(f.stat.GetContextValue(VsMonsters) == 11.f);
+    CHECK(f.monsterRuns == 1);
+
+    f.counted.Disable();
+    CHECK(f.stat.GetContextValue(VsMonsters) == 10.f);
+    f.stat.InvalidateContextValues(VsMonsters);
+    f.counted.Enable();
+    CHECK(f.stat.GetContextValue(VsMonsters) == 11.f);
+    CHECK(f.monsterRuns == 2);
+  }
+
+  void TestSharedChangesDropOnlyTheirMasks() {
+    Fixture f;
+    InspectableToggle rules;
+    InspectableTransformDefinition<float> formula(xoins::MakeAddTransform(2.f));
+    InspectableTransformationF toggled(xoins::AddOp(100.f)), defined(formula);
+    toggled.SetToggle(&rules);
+    toggled.SetContextMask(VsPlayers);
+    defined.SetContextMask(VsPlayers);
+    f.stat.AddTransformation(&toggled).AddTransformation(&defined, true);
+    CHECK(f.stat.GetContextValue(VsPlayers) == 107.f);
+    CHECK(f.stat.GetContextValue(VsMonsters) == 11.f);
+    f.monsterRuns = 0;
+
+    rules.Disable();
+    CHECK(f.stat.GetContextValue(VsPlayers) == 7.f);
+    formula.Set(xoins::MakeAddTransform(4.f));
+    CHECK(f.stat.GetContextValue(VsPlayers) == 9.f);
+    CHECK(f.stat.GetContextValue(VsMonsters) == 11.f);
+    CHECK(f.monsterRuns == 0);
+
+    // moving a transformation to another context drops both.
+    defined.SetContextMask(VsMonsters);
+    CHECK(f.stat.GetContextValue(VsPlayers) == 5.f);
+    CHECK(f.stat.GetContextValue(VsMonsters) == 15.f);
+    CHECK(f.monsterRuns == 1);
+    f.stat.RemoveTransformation(&toggled);
+    f.stat.RemoveTransformation(&defined);
+  }
+}
+
+int main() {
+  TestEnableDropsOnlyItsMasks();
+  TestSharedChangesDropOnlyTheirMasks();
+  return xoins_test::CheckResult();
+}
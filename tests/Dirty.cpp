@@ -0,0 +1,60 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Dirty.cpp
+//
+//  Inspectables marked dirty by a shared definition are updated together, and
+//  destroying one drops just its own entry, whether or not it was updated since.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+  void TestDefinitionMarksUsers() {
+    InspectableTransformDefinitionF bonus([](float& value) { value += 1.f; });
+    InspectableTransformationF a(bonus), b(bonus);
+    InspectableF first(1.f), second(2.f), unrelated(3.f);
+    first.AddTransformation(&a, true);
+    second.AddTransformation(&b, true);
+    bonus.Set([](float& value) { value += 10.f; });
+    CHECK(first.IsDirty() && second.IsDirty() && !unrelated.IsDirty());
+    CHECK(xoins::GetDirtyInspectableCount() == 2);
+    xoins::UpdateDirtyInspectables();
+    CHECK(first.GetValue() == 11.f && second.GetValue() == 12.f);
+    CHECK(xoins::GetDirtyInspectableCount() == 0);
+    first.RemoveTransformation(&a);
+    second.RemoveTransformation(&b);
+  }
+
+  void TestDestroyDirty() {
+    const unsigned Count = 1000;
+    std::vector<std::unique_ptr<InspectableF> > stats;
+    for(unsigned i = 0; i < Count; ++i) {
+      stats.push_back(std::unique_ptr<InspectableF>(new InspectableF((float)i)));
+      stats.back()->MarkDirty();
+    }
+    // updated by hand, so no longer dirty but still listed.
+    stats[1]->ForceUpdate();
+    CHECK(!stats[1]->IsDirty());
+    stats[1]->MarkDirty();
+    stats[1]->ForceUpdate();
+    // every other one goes away before the list is updated.
+    for(unsigned i = 0; i < Count; i += 2)
+      stats[i].reset();
+    stats[1].reset();
+    CHECK(xoins::GetDirtyInspectableCount() == Count / 2 - 1);
+    xoins::UpdateDirtyInspectables();
+    CHECK(xoins::GetDirtyInspectableCount() == 0);
+    stats[3]->MarkDirty();
+    CHECK(stats[3]->IsDirty() && xoins::GetDirtyInspectableCount() == 1);
+    xoins::UpdateDirtyInspectables();
+    CHECK(!stats[3]->IsDirty());
+  }
+}
+
+int main() {
+  TestDefinitionMarksUsers();
+  TestDestroyDirty();
+  return xoins_test::CheckResult();
+}
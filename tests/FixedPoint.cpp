@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// FixedPoint.cpp
+//
+//  Rounding of fixed point multiplication and division, negative values in particular,
+//  wrapping, and the batch functions matching the scalar ones. The build also runs it
+//  without __int128, so the portable 64 bit paths are checked against the same results.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <climits>
+#include <vector>
+
+namespace {
+  typedef xoins::Fixed16_16 TFixed;
+
+  // the 32 bit versions widen to int64_t, so they're exact. Any value that fits in 32 bits
+  // has to come out of the 64 bit versions the same.
+  void TestMatchesNarrow() {
+    uint32_t state = 12345;
+    auto next = [&state]() { state = state * 1664525u + 1013904223u; return state; };
+    for(int i = 0; i < 20000; ++i) {
+      int32_t a = (int32_t)next() >> (next() % 24);
+      int32_t b = (int32_t)next() >> (next() % 24);
+      // only compare results that fit in 32 bits, since the narrow versions wrap.
+      unsigned shift = next() % 32;
+      int64_t product = ((int64_t)a * b) >> shift;
+      if(product >= INT32_MIN && product <= INT32_MAX)
+        CHECK(xoins::internal::FixedMul((int64_t)a, (int64_t)b, shift) == xoins::internal::FixedMul(a, b, shift));
+      unsigned divShift = next() % 16;
+      int64_t quotient = b != 0 ? (int64_t)a * ((int64_t)1 << divShift) / b : 0;
+      if(b != 0 && quotient >= INT32_MIN && quotient <= INT32_MAX)
+        CHECK(xoins::internal::FixedDiv((int64_t)a, (int64_t)b, divShift) == xoins::internal::FixedDiv(a, b, divShift));
+    }
+  }
+
+  void TestRounding() {
+    using xoins::internal::FixedMul;
+    using xoins::internal::FixedDiv;
+    // multiplication rounds towards negative infinity, like >> on the exact product.
+    CHECK(FixedMul((int64_t)-3, (int64_t)1, 1) == -2);
+    CHECK(FixedMul((int64_t)3, (int64_t)-1, 1) == -2);
+    CHECK(FixedMul((int64_t)-3, (int64_t)-1, 1) == 1);
+    CHECK(FixedMul((int64_t)-1, (int64_t)1, 32) == -1);
+    CHECK(FixedMul((int64_t)-5, (int64_t)7, 0) == -35);
+    // products that need more than 64 bits.
+    CHECK(FixedMul((int64_t)(1LL << 62) + 1, (int64_t)-3, 2) == -3458764513820540929LL);
+    CHECK(FixedMul(-(int64_t)(1LL << 40), (int64_t)(1LL << 40) + 1, 32) == -((1LL << 48) + (1LL << 8)));
+
+    // division truncates towards zero, like / on the exact quotient.
+    CHECK(FixedDiv((int64_t)-7, (int64_t)2, 0) == -3);
+    CHECK(FixedDiv((int64_t)7, (int64_t)-2, 0) == -3);
+    CHECK(FixedDiv((int64_t)-7, (int64_t)-2, 0) == 3);
+    CHECK(FixedDiv(-(int64_t)(1LL << 50) - 1, (int64_t)3 << 20, 32) == -1537228672809130666LL);
+    CHECK(FixedDiv(-(int64_t)(7LL << 40), (int64_t)(1LL << 33), 32) == -(7LL << 39));
+  }
+
+  void TestFixed() {
+    TFixed half = TFixed::FromDouble(0.5), three = TFixed::FromInt(3);
+    CHECK(half.GetRaw() == 1 << 15);
+    CHECK((half * three).GetRaw() == TFixed::FromDouble(1.5).GetRaw());
+    CHECK((-half).ToInt() == -1 && half.ToInt() == 0);
+    // the smallest negative product rounds away from zero.
+    CHECK((TFixed::FromRaw(-1) * TFixed::FromRaw(1)).GetRaw() == -1);
+    CHECK((TFixed::FromRaw(1) * TFixed::FromRaw(1)).GetRaw() == 0);
+    // arithmetic wraps.
+    CHECK(TFixed::FromRaw(INT32_MAX) + TFixed::FromRaw(1) == TFixed::FromRaw(INT32_MIN));
+    CHECK(TFixed::FromRaw(INT32_MIN) - TFixed::FromRaw(1) == TFixed::FromRaw(INT32_MAX));
+
+    // division only happens in modifier programs, which treat dividing by zero as 0.
+    typedef xoins::ModifierTraits<TFixed> TTraits;
+    CHECK(TTraits::Divide(three, TFixed()) == TFixed());
+    CHECK(TTraits::Divide(three, half) == TFixed::FromInt(6));
+    CHECK(TTraits::Divide(-three, TFixed::FromInt(2)) == -TFixed::FromDouble(1.5));
+  }
+
+  void TestBatchMatchesScalar() {
+    std::vector<TFixed> values, expected;
+    for(int i = -50; i < 50; ++i)
+      values.push_back(TFixed::FromRaw(i * 40503));
+    TFixed factor = TFixed::FromDouble(-1.375), amount = TFixed::FromDouble(0.25);
+    TFixed low = TFixed::FromInt(-10), high = TFixed::FromInt(10);
+    for(TFixed value : values) {
+      TFixed result = value * factor + amount;
+      expected.push_back(result < low ? low : result > high ? high : result);
+    }
+    xoins::BatchMul(values.data(), values.size(), factor);
+    xoins::BatchAdd(values.data(), values.size(), amount);
+    xoins::BatchClamp(values.data(), values.size(), low, high);
+    CHECK(values == expected);
+  }
+
+  void TestInspectable() {
+    Inspectable<TFixed> speed(TFixed::FromInt(5));
+    InspectableTransformation<TFixed> mud(xoins::MakeAddTransform(TFixed::FromInt(-1)), 1);
+    InspectableTransformation<TFixed> slow(xoins::MakeMulTransform(TFixed::FromDouble(0.75)));
+    InspectableTransformation<TFixed> cap(xoins::MakeClampTransform(TFixed(), TFixed::FromInt(2)), -1);
+    speed.AddTransformation(&mud).AddTransformation(&slow, true);
+    CHECK(speed.GetValue() == TFixed::FromInt(3));
+    speed.AddTransformation(&cap, true);
+    CHECK(speed.GetValue() == TFixed::FromInt(2));
+    speed.RemoveTransformation(&mud);
+    speed.RemoveTransformation(&slow);
+    speed.RemoveTransformation(&cap);
+  }
+}
+
+int main() {
+  TestMatchesNarrow();
+  TestRounding();
+  TestFixed();
+  TestBatchMatchesScalar();
+  TestInspectable();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// FrameArena.cpp
+//
+//  Transient transformations last until EndFrame, which only dirties the Inspectables
+//  that held some, and forgets those destroyed during the frame.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <new>
+#include <type_traits>
+
+namespace {
+  void TestEndFrame() {
+    InspectableF slowed(10.f), hit(5.f), untouched(1.f);
+    InspectableFrameArenaF transient;
+    InspectableTransformationF* first = transient.Add(slowed, xoins::MulOp(0.5f), 100);
+    transient.Add(slowed, [](float& value) { value -= 1.f; });
+    transient.Add(hit, xoins::AddOp(-2.f), 0, true);
+    CHECK(transient.GetCount() == 3);
+    CHECK(slowed.IsDirty() && !hit.IsDirty() && hit.GetValue() == 3.f);
+    xoins::UpdateDirtyInspectables();
+    CHECK(slowed.GetValue() == 4.f);
+
+    transient.EndFrame();
+    CHECK(transient.GetCount() == 0);
+    CHECK(slowed.GetTransformations().IsEmpty() && hit.GetTransformations().IsEmpty());
+    CHECK(slowed.IsDirty() && hit.IsDirty() && !untouched.IsDirty());
+    xoins::UpdateDirtyInspectables();
+    CHECK(slowed.GetValue() == 10.f && hit.GetValue() == 5.f);
+
+    // the next frame reuses the same slots, reset.
+    CHECK(transient.Add(hit, xoins::AddOp(1.f)) == first);
+    CHECK(!first->IsAbsorbing() && first->GetContextMask() == xoins::AllContexts);
+    transient.EndFrame();
+    xoins::UpdateDirtyInspectables();
+    CHECK(hit.GetValue() == 5.f);
+  }
+
+  void TestDestroyedDuringFrame() {
+    InspectableFrameArenaF transient;
+    InspectableF kept(2.f);
+    transient.Add(kept, xoins::MulOp(3.f), 0, true);
+    // an Inspectable built where a destroyed one was isn't mistaken for it.
+    std::aligned_storage<sizeof(InspectableF), alignof(InspectableF)>::type storage;
+    InspectableF* doomed = new (&storage) InspectableF(1.f);
+    transient.Add(*doomed, xoins::AddOp(1.f), 0, true);
+    transient.Add(*doomed, xoins::AddOp(2.f), 0, true);
+    doomed->~InspectableF();
+    InspectableF* reborn = new (&storage) InspectableF(7.f);
+    InspectableTransformationF own(xoins::MulOp(2.f));
+    reborn->AddTransformation(&own, true);
+    InspectableTransformationF* added = transient.Add(*reborn, xoins::AddOp(1.f), -1, true);
+    CHECK(reborn->GetValue() == 15.f);
+
+    transient.EndFrame();
+    CHECK(kept.GetTransformations().IsEmpty());
+    CHECK(reborn->ContainsTransformation(&own));
+    CHECK(!reborn->ContainsTransformation(added));
+    xoins::UpdateDirtyInspectables();
+    CHECK(kept.GetValue() == 2.f && reborn->GetValue() == 14.f);
+    reborn->RemoveTransformation(&own);
+    reborn->~InspectableF();
+  }
+}
+
+int main() {
+  TestEndFrame();
+  TestDestroyedDuringFrame();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,116 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Handles.cpp
+//
+//  Moving scoped handles, and keeping them in a xoins::HandlePool.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace {
+  typedef InspectableScopedTransformation<float> TScopedTransformation;
+  typedef InspectableScopedConnection<float> TScopedConnection;
+
+  static_assert(std::is_nothrow_move_constructible<TScopedTransformation>::value, "");
+  static_assert(std::is_nothrow_move_constructible<TScopedConnection>::value, "");
+  static_assert(std::is_nothrow_move_constructible<InspectableScopedValueChangedFunc<float> >::value, "");
+  static_assert(std::is_nothrow_move_constructible<InspectableScopedIdentityChangedFunc<float> >::value, "");
+
+  template<typename TPolicy>
+  void TestMoveIsSilent() {
+    typedef Inspectable<float, TPolicy> TInspectable;
+    typedef InspectableScopedTransformation<float, TPolicy> TScoped;
+    TInspectable stat(2.f);
+    std::shared_ptr<float> factor(new float(2.f));
+    TScoped doubled(&stat, [factor](float& value) { value *= *factor; }, 0, true, true);
+    CHECK(stat.GetValue() == 4.f);
+    CHECK(factor.use_count() == 2);
+
+    struct Counter : InspectableObserver<float, TPolicy> {
+      Counter() : before(0), after(0) {}
+      void OnBeforeChange(TInspectable*) { ++before; }
+      void OnChanged(TInspectable*) { ++after; }
+      int before, after;
+    } counter;
+    // only the address changed, so nobody hears about it, and the function isn't copied.
+    TScoped moved(std::move(doubled));
+    CHECK(counter.before == 0 && counter.after == 0);
+    CHECK(factor.use_count() == 2);
+    CHECK(!stat.IsDirty() && stat.GetValue(true) == 4.f);
+    *factor = 3.f;
+    CHECK(stat.GetValue(true) == 6.f);
+
+    counter.before = counter.after = 0;
+    TScoped target;
+    target = std::move(moved);
+    CHECK(counter.before == 0 && counter.after == 0);
+    CHECK(factor.use_count() == 2);
+
+    // the moved transformation is still registered, so enabling it still reaches 'stat'.
+    target.Disable(true);
+    CHECK(stat.GetValue() == 2.f);
+    target.Enable(true);
+    CHECK(stat.GetValue() == 6.f);
+    CHECK(counter.before == 2 && counter.after == 2);
+
+    // assigning over an attached one removes it the usual way.
+    TScoped other(&stat, [](float& value) { value += 1.f; }, -1, true, true);
+    CHECK(stat.GetValue() == 7.f);
+    other = std::move(target);
+    CHECK(factor.use_count() == 2);
+    CHECK(stat.GetValue(true) == 6.f);
+  }
+
+  void TestPoolWithRollback() {
+    // a reserved pool never moves what it holds, so frames can re-attach its transformations.
+    InspectableF stat(1.f);
+    InspectableRollback<float> rollback(4);
+    xoins::HandlePool<TScopedTransformation> pool;
+    pool.Reserve(4);
+    xoins::HandlePoolId first = pool.Acquire(TScopedTransformation(&stat, [](float& value) { value += 1.f; }, 0, true, true));
+    rollback.Capture();
+    pool.Acquire(TScopedTransformation(&stat, [](float& value) { value *= 3.f; }, -1, true, true));
+    pool.Acquire(TScopedTransformation(&stat, [](float& value) { value -= 2.f; }, -2, true, true));
+    CHECK(stat.GetValue() == 4.f);
+    CHECK(rollback.Rewind(0));
+    CHECK(stat.GetValue() == 2.f);
+    CHECK(stat.GetValue(true) == 2.f);
+    CHECK(pool.Get(first) != nullptr);
+    pool.Clear();
+    CHECK(stat.GetValue(true) == 1.f);
+  }
+
+  void TestPool() {
+    InspectableF stat(1.f);
+    xoins::HandlePool<TScopedTransformation> pool;
+    xoins::HandlePoolId ids[20];
+    for(int i = 0; i < 20; ++i) // grows the pool a few times, moving what it holds
+      ids[i] = pool.Acquire(TScopedTransformation(&stat, [](float& value) { value += 1.f; }, 0));
+    CHECK(pool.GetCount() == 20);
+    CHECK(stat.GetValue(true) == 21.f);
+    CHECK(pool.Release(ids[3]) && !pool.Release(ids[3]));
+    CHECK(pool.Get(ids[3]) == nullptr);
+    xoins::HandlePoolId reused = pool.Acquire(TScopedTransformation(&stat, [](float& value) { value *= 10.f; }, -1));
+    CHECK(reused.index == ids[3].index && reused.generation != ids[3].generation);
+    CHECK(stat.GetValue(true) == 200.f);
+    pool.Clear();
+    CHECK(pool.GetCount() == 0);
+    CHECK(stat.GetValue(true) == 1.f);
+
+    // handles that can only be moved work too.
+    xoins::HandlePool<std::unique_ptr<int> > owners;
+    xoins::HandlePoolId owner = owners.Acquire(std::unique_ptr<int>(new int(5)));
+    CHECK(**owners.Get(owner) == 5);
+  }
+}
+
+int main() {
+  TestMoveIsSilent<xoins::DefaultListPolicy>();
+  TestMoveIsSilent<xoins::HotColdPolicy>();
+  TestPool();
+  TestPoolWithRollback();
+  return xoins_test::CheckResult();
+}
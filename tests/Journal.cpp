@@ -0,0 +1,134 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Journal.cpp
+//
+//  Records changes into a journal file, then reads the file back and replays it the way
+//  an offline tool would.
+//////////////////////////////////////////////////////////////////////////////////////////
+#define xoins_journal
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+  const uint16_t Stream = 7;
+
+  std::vector<char> ReadFile(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  // hands out a new transformation for every added record, in the order they come.
+  struct Resolver {
+    std::deque<InspectableTransformationF>* made;
+
+    InspectableTransformationF* operator()(const xoins::JournalRecord& record) {
+      made->push_back(InspectableTransformationF());
+      InspectableTransformationF& transformation = made->back();
+      if(record.data == 10)
+        transformation.Set([](float& value) { value *= 2.f; });
+      else
+        transformation.Set([](float& value) { value += 1.f; });
+      return &transformation;
+    }
+  };
+
+  void TestRoundTrip() {
+    const char* path = "Journal_test.journal";
+    InspectableTransformationF twice([](float& value) { value *= 2.f; }, 5);
+    twice.SetDefinitionId(10);
+    // neither has a definition id, so only their addresses tell them apart.
+    InspectableTransformationF first([](float& value) { value += 1.f; }, 1);
+    InspectableTransformationF second([](float& value) { value += 1.f; }, 0);
+    uint64_t address = 0;
+    float identity = 0.f, value = 0.f;
+    {
+      xoins::Journal journal;
+      CHECK(journal.Open(path, 1000));
+      InspectableJournalF recorder(journal, Stream);
+      InspectableF stat(1.f);
+      address = (uint64_t)(uintptr_t)&stat;
+      stat.AddTransformation(&twice, true);
+      stat.AddTransformation(&first, true);
+      stat.AddTransformation(&second, true);
+      stat.SetIdentity(3.f, true);
+      stat.RemoveTransformation(&first, true);
+      identity = stat.GetIdentity();
+      value = stat.GetValue();
+      CHECK(value == 7.f);
+      journal.FlushThread();
+
+      std::vector<char> bytes = ReadFile(path);
+      std::vector<xoins::JournalRecord> records;
+      CHECK(xoins::ReadJournal(bytes.data(), bytes.size(), records));
+      CHECK(!xoins::ReadJournal(bytes.data(), 16, records));
+
+      std::deque<InspectableTransformationF> made;
+      std::unordered_map<uint64_t, InspectableF> replayed;
+      Resolver resolver = { &made };
+      xoins::ReplayJournal(records.data(), records.size(), Stream, replayed, resolver);
+      CHECK(replayed.size() == 1);
+      InspectableF& copy = replayed[address];
+      CHECK(copy.GetIdentity() == identity);
+      CHECK(copy.GetCachedValue() == value);
+      CHECK(made.size() == 3);
+      // the removed transformation is the one that was recorded, not the last one with
+      // the same definition id.
+      CHECK(copy.ContainsTransformation(&made[0]));
+      CHECK(!copy.ContainsTransformation(&made[1]));
+      CHECK(copy.ContainsTransformation(&made[2]));
+      CHECK(made[0].GetPriority() == 5 && made[0].GetDefinitionId() == 10);
+      CHECK(made[2].GetPriority() == 0 && made[2].GetDefinitionId() == 0);
+      CHECK(copy.GetValue(true) == value);
+      stat.RemoveTransformation(&twice);
+      stat.RemoveTransformation(&second);
+    }
+    std::remove(path);
+  }
+
+  xoins::JournalRecord Record(xoins::JournalRecordKind kind, uint64_t transformation, uint64_t data = 0) {
+    xoins::JournalRecord record = {};
+    record.inspectable = 1;
+    record.transformation = transformation;
+    record.data = data;
+    record.kind = (uint8_t)kind;
+    record.enabled = 1;
+    record.stream = Stream;
+    return record;
+  }
+
+  void TestReplayByAddress() {
+    std::vector<xoins::JournalRecord> records;
+    records.push_back(Record(xoins::JournalTransformationAdded, 100));
+    records.push_back(Record(xoins::JournalTransformationAdded, 200));
+    records.push_back(Record(xoins::JournalTransformationDisabled, 100));
+    // a removal whose add isn't in the records (the ring wrapped) is skipped.
+    records.push_back(Record(xoins::JournalTransformationRemoved, 300));
+    records.push_back(Record(xoins::JournalTransformationRemoved, 200));
+    records.push_back(Record(xoins::JournalTransformationEnabled, 200));
+
+    std::deque<InspectableTransformationF> made;
+    std::unordered_map<uint64_t, InspectableF> replayed;
+    Resolver resolver = { &made };
+    xoins::ReplayJournal(records.data(), records.size(), Stream, replayed, resolver);
+    InspectableF& stat = replayed[1];
+    CHECK(made.size() == 2);
+    CHECK(stat.ContainsTransformation(&made[0]) && !made[0].IsEnabled());
+    CHECK(!stat.ContainsTransformation(&made[1]) && made[1].IsEnabled());
+
+    records.push_back(Record(xoins::JournalDestroyed, 0));
+    replayed.clear();
+    made.clear();
+    xoins::ReplayJournal(records.data(), records.size(), Stream, replayed, resolver);
+    CHECK(replayed.empty());
+  }
+}
+
+int main() {
+  TestRoundTrip();
+  TestReplayByAddress();
+  return xoins_test::CheckResult();
+}
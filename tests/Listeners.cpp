@@ -0,0 +1,49 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Listeners.cpp
+//
+//  Copying an Inspectable copies its live listeners and their connections, but not the
+//  state of a dispatch running on the original.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <memory>
+
+namespace {
+  void TestCopyDuringDispatch() {
+    std::shared_ptr<int> calls = std::make_shared<int>(0);
+    std::unique_ptr<InspectableF> copy;
+    InspectableF stat(1.f);
+    InspectableConnection counted = stat.ConnectOnValueChanged([calls](InspectableF*, const float&, const float&) { ++*calls; });
+    InspectableConnection dropped = stat.ConnectOnValueChanged([](InspectableF*, const float&, const float&) {});
+    InspectableConnection copier;
+    copier = stat.ConnectOnValueChanged([&](InspectableF* self, const float&, const float&) {
+      self->Disconnect(dropped); // pending on the original until its dispatch ends
+      if(!copy)
+        copy.reset(new InspectableF(*self));
+    });
+    stat.SetIdentity(2.f, true);
+    CHECK(copy && *calls == 1);
+    CHECK(copy->IsConnected(counted) && copy->IsConnected(copier));
+    CHECK(!copy->IsConnected(dropped));
+    CHECK(calls.use_count() == 3); // here, in stat and in the copy
+
+    // the copy isn't dispatching, so disconnecting frees the function right away.
+    CHECK(copy->Disconnect(counted));
+    CHECK(calls.use_count() == 2);
+    copy->SetIdentity(5.f, true);
+    CHECK(*calls == 1);
+    stat.SetIdentity(3.f, true);
+    CHECK(*calls == 2);
+
+    InspectableF assigned;
+    assigned = stat;
+    CHECK(assigned.Disconnect(counted));
+    CHECK(calls.use_count() == 2);
+  }
+}
+
+int main() {
+  TestCopyDuringDispatch();
+  return xoins_test::CheckResult();
+}
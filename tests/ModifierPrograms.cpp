@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// ModifierPrograms.cpp
+//
+//  What compiling an expression folds and fuses, evaluating programs that need a stack
+//  and ones that don't, and dividing by zero.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+  template<typename T>
+  std::vector<xoins::ModifierOp> Ops(const xoins::ModifierProgram<T>& program) {
+    std::vector<xoins::ModifierOp> ops;
+    for(const typename xoins::ModifierProgram<T>::Instruction& instruction : program.GetInstructions())
+      ops.push_back(instruction.op);
+    return ops;
+  }
+
+  typedef std::vector<xoins::ModifierOp> TOps;
+
+  void TestFolding() {
+    xoins::ModifierProgram<float> program;
+    // everything that doesn't depend on base becomes one constant.
+    CHECK(program.Compile("base + (2 * 3 - 1) / 2"));
+    CHECK(Ops(program) == TOps({ xoins::ModifierPushBase, xoins::ModifierAddConstant }));
+    CHECK(program.GetInstructions()[1].constant == 2.5f);
+    CHECK(program.IsLinear() && program.Evaluate(1.f) == 3.5f);
+
+    CHECK(program.Compile("2 * 3 + 4"));
+    CHECK(Ops(program) == TOps({ xoins::ModifierPushConstant }));
+    CHECK(program.Evaluate(-7.f) == 10.f);
+
+    // runs of constant adds or multiplies fuse into one.
+    CHECK(program.Compile("base + 1 + 2 - 4"));
+    CHECK(Ops(program) == TOps({ xoins::ModifierPushBase, xoins::ModifierAddConstant }));
+    CHECK(program.Evaluate(10.f) == 9.f);
+    CHECK(program.Compile("base * 2 * 4"));
+    CHECK(Ops(program) == TOps({ xoins::ModifierPushBase, xoins::ModifierMultiplyConstant }));
+    CHECK(program.GetInstructions()[1].constant == 8.f);
+
+    CHECK(program.Compile("(base + 5) * 2 clamp 0..100"));
+    CHECK(Ops(program) == TOps({ xoins::ModifierPushBase, xoins::ModifierAddConstant,
+                                 xoins::ModifierMultiplyConstant, xoins::ModifierClampConstant }));
+    CHECK(program.IsLinear());
+    CHECK(program.Evaluate(10.f) == 30.f && program.Evaluate(-20.f) == 0.f && program.Evaluate(60.f) == 100.f);
+
+    // a constant on the left is fused too.
+    CHECK(program.Compile("10 - base"));
+    CHECK(Ops(program) == TOps({ xoins::ModifierPushBase, xoins::ModifierSubtractFromConstant }));
+    CHECK(program.Evaluate(3.f) == 7.f);
+  }
+
+  void TestStack() {
+    xoins::ModifierProgram<float> program;
+    CHECK(program.Compile("1 + base * 2"));
+    CHECK(program.Evaluate(3.f) == 7.f);
+    CHECK(program.Compile("base * base - base"));
+    CHECK(!program.IsLinear());
+    CHECK(program.Evaluate(4.f) == 12.f);
+    CHECK(program.Compile("min(base, 10) + max(base, 2) * -base"));
+    CHECK(program.Evaluate(3.f) == 3.f - 9.f);
+    CHECK(program.Evaluate(12.f) == 10.f - 144.f);
+
+    // the transformation keeps its own copy of the program.
+    std::function<void(float&)> transform = program.MakeTransform();
+    std::string error;
+    CHECK(!program.Compile("base +", &error) && !error.empty());
+    CHECK(program.Evaluate(3.f) == -6.f);
+    CHECK(program.Compile("base"));
+    float value = 3.f;
+    transform(value);
+    CHECK(value == -6.f);
+    CHECK(program.Evaluate(3.f) == 3.f);
+  }
+
+  template<typename T>
+  void TestDivideByZero() {
+    typedef xoins::ModifierTraits<T> TTraits;
+    const T zero = T(), five = TTraits::FromNumber(5), two = TTraits::FromNumber(2);
+    xoins::ModifierProgram<T> program;
+    CHECK(program.Compile("base / 0"));
+    CHECK(program.Evaluate(five) == zero);
+    CHECK(program.Compile("base / (1 - 1) + 1"));
+    CHECK(program.Evaluate(five) == TTraits::FromNumber(1));
+    CHECK(program.Compile("2 / (3 - 3)"));
+    CHECK(Ops(program) == TOps({ xoins::ModifierPushConstant }));
+    CHECK(program.Evaluate(five) == zero);
+    CHECK(program.Compile("10 / base"));
+    CHECK(program.Evaluate(zero) == zero && program.Evaluate(five) == two);
+    CHECK(program.Compile("base / base"));
+    CHECK(program.Evaluate(zero) == zero && program.Evaluate(five) == TTraits::FromNumber(1));
+  }
+}
+
+int main() {
+  TestFolding();
+  TestStack();
+  TestDivideByZero<float>();
+  TestDivideByZero<xoins::Fixed16_16>();
+  TestDivideByZero<xoins::Fixed32_32>();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// ModifierTable.cpp
+//
+//  Compiles a modifier table, reloads it from its bytes and evaluates it through
+//  Inspectables. Also checks that the expression compiler refuses input nested deeply
+//  enough to exhaust the stack.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+  const xoins::ModifierTableSource Sources[] = {
+    { 30, 5, "(base + 5) * 1.2 clamp 0..100" },
+    { 10, 1, "base * 2" },
+    { 20, -3, "min(base, 10) + max(base, 2) / 2" },
+    { 40, 0, "base" },
+  };
+  const size_t SourceCount = sizeof(Sources) / sizeof(Sources[0]);
+
+  template<typename T>
+  T Number(double number) {
+    return xoins::ModifierTraits<T>::FromNumber(number);
+  }
+
+  template<typename T>
+  void TestRoundTrip() {
+    std::vector<unsigned char> bytes;
+    std::string error;
+    CHECK(xoins::CompileModifierTable<T>(Sources, SourceCount, bytes, &error));
+    CHECK(error.empty());
+    std::vector<unsigned char> again;
+    CHECK(xoins::CompileModifierTable<T>(Sources, SourceCount, again));
+    CHECK(again == bytes); // deterministic, so tables can be cached and diffed
+
+    // reload from a copy, as if it came from a file.
+    std::vector<unsigned char> loaded(bytes);
+    xoins::ModifierTableView<T> view(loaded.data(), loaded.size());
+    CHECK(view.IsValid());
+    CHECK(view.GetCount() == SourceCount);
+    CHECK(view.GetEntries()[0].id == 10);
+    CHECK(view.Find(11) == nullptr);
+    CHECK(view.Find(20) && view.Find(20)->priority == -3);
+
+    for(size_t i = 0; i < SourceCount; ++i) {
+      xoins::ModifierProgram<T> program;
+      CHECK(program.Compile(Sources[i].text));
+      const xoins::ModifierTableEntry* entry = view.Find(Sources[i].id);
+      for(int base = -10; base < 200; base += 7)
+        CHECK(view.Evaluate(*entry, Number<T>(base)) == program.Evaluate(Number<T>(base)));
+    }
+
+    InspectableTransformation<T> clamped, doubled, mixed;
+    CHECK(view.Bind(30, clamped) && view.Bind(10, doubled) && view.Bind(20, mixed));
+    CHECK(!view.Bind(99, mixed));
+    CHECK(clamped.GetPriority() == 5 && clamped.GetDefinitionId() == 30);
+    Inspectable<T> stat(Number<T>(20));
+    stat.AddTransformation(&mixed).AddTransformation(&doubled).AddTransformation(&clamped, true);
+    T expected = Number<T>(20);
+    clamped(expected);
+    doubled(expected);
+    mixed(expected);
+    CHECK(stat.GetValue() == expected);
+    stat.RemoveTransformation(&mixed);
+    stat.RemoveTransformation(&doubled);
+    stat.RemoveTransformation(&clamped);
+
+    CHECK(!xoins::ModifierTableView<T>(loaded.data(), loaded.size() - 1).IsValid());
+    // flipping any byte either invalidates the table or leaves it safe to evaluate.
+    for(size_t i = 0; i < bytes.size(); ++i) {
+      std::vector<unsigned char> corrupt(bytes);
+      corrupt[i] ^= 0xff;
+      xoins::ModifierTableView<T> corruptView(corrupt.data(), corrupt.size());
+      for(uint32_t k = 0; corruptView.IsValid() && k < corruptView.GetCount(); ++k)
+        corruptView.Evaluate(corruptView.GetEntries()[k], Number<T>(3));
+    }
+  }
+
+  void TestErrors() {
+    std::vector<unsigned char> bytes;
+    std::string error;
+    xoins::ModifierTableSource duplicate[] = { { 1, 0, "base" }, { 1, 0, "base * 2" } };
+    CHECK(!xoins::CompileModifierTable<float>(duplicate, 2, bytes, &error));
+    CHECK(bytes.empty() && !error.empty());
+    xoins::ModifierTableSource broken[] = { { 7, 0, "base +" } };
+    CHECK(!xoins::CompileModifierTable<float>(broken, 1, bytes, &error));
+    CHECK(!xoins::ModifierTableView<double>(bytes.data(), bytes.size()).IsValid());
+  }
+
+  std::string Repeat(const char* text, unsigned count) {
+    std::string repeated;
+    for(unsigned i = 0; i < count; ++i)
+      repeated += text;
+    return repeated;
+  }
+
+  void TestNestingLimits() {
+    typedef xoins::ModifierProgram<float> TProgram;
+    TProgram program;
+    std::string error;
+
+    // right at the limit still compiles.
+    unsigned fits = TProgram::MaxNesting - 1;
+    CHECK(program.Compile((Repeat("(", fits) + "base" + Repeat(")", fits)).c_str(), &error));
+    CHECK(program.Compile((Repeat("-", fits) + "base").c_str(), &error));
+
+    // far past it fails cleanly instead of overflowing the stack.
+    std::string parentheses = Repeat("(", 100000) + "base" + Repeat(")", 100000);
+    CHECK(!program.Compile(parentheses.c_str(), &error));
+    CHECK(error.find("nested too deeply") != std::string::npos);
+    CHECK(!program.Compile((Repeat("-", 100000) + "base").c_str(), &error));
+    CHECK(!program.Compile((Repeat("min(", 100000) + "base").c_str(), &error));
+
+    // long chains don't nest, but they'd make compiling recurse just as deep.
+    CHECK(program.Compile(("base" + Repeat(" + base", 100)).c_str(), &error));
+    CHECK(program.Evaluate(2.f) == 202.f);
+    CHECK(!program.Compile(("base" + Repeat(" + base", 100000)).c_str(), &error));
+    CHECK(error.find("too long") != std::string::npos);
+    CHECK(program.Evaluate(2.f) == 202.f); // left unchanged by the failures
+  }
+}
+
+int main() {
+  TestRoundTrip<float>();
+  TestRoundTrip<double>();
+  TestRoundTrip<xoins::Fixed16_16>();
+  TestErrors();
+  TestNestingLimits();
+  return xoins_test::CheckResult();
+}
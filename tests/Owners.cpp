@@ -0,0 +1,154 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Owners.cpp
+//
+//  Transformations telling the Inspectables they're attached to about changes: only the
+//  owning HotColdList goes stale, and destroying an attached transformation detaches it.
+//  Copies take the function, op or definition but none of the owners.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <memory>
+
+namespace {
+  typedef Inspectable<float, xoins::HotColdPolicy> THotCold;
+
+  bool IsStale(const THotCold& inspectable) {
+    return inspectable.GetTransformations().IsStale();
+  }
+
+  void TestOnlyOwnerGoesStale() {
+    THotCold first(1.f), second(1.f);
+    InspectableTransformationF haste(xoins::MulOp(2.f)), slow(xoins::MulOp(0.5f));
+    first.AddTransformation(&haste, true);
+    second.AddTransformation(&slow, true);
+    CHECK(!IsStale(first) && !IsStale(second));
+
+    haste.Disable();
+    CHECK(IsStale(first) && !IsStale(second));
+    CHECK(first.GetValue(true) == 1.f);
+    CHECK(!IsStale(first));
+
+    slow.Disable();
+    slow.Disable(); // no change, so nothing to refresh
+    CHECK(IsStale(second) && !IsStale(first));
+    CHECK(second.GetValue(true) == 1.f);
+    haste.SetAbsorbing(true);
+    CHECK(IsStale(first) && !IsStale(second));
+
+    first.RemoveTransformation(&haste, true);
+    second.RemoveTransformation(&slow, true);
+    haste.Enable(); // detached, so no one hears about it
+    CHECK(!IsStale(first) && !IsStale(second));
+  }
+
+  void TestToggleMarksItsUsers() {
+    InspectableToggle pvp(false);
+    THotCold user(2.f), other(2.f);
+    InspectableTransformationF damage(xoins::MulOp(3.f)), plain(xoins::AddOp(1.f));
+    damage.SetToggle(&pvp);
+    user.AddTransformation(&damage, true);
+    other.AddTransformation(&plain, true);
+    CHECK(user.GetValue() == 2.f && other.GetValue() == 3.f);
+
+    pvp.Enable();
+    CHECK(IsStale(user) && !IsStale(other));
+    CHECK(user.IsDirty() && !other.IsDirty());
+    xoins::UpdateDirtyInspectables();
+    CHECK(user.GetValue() == 6.f);
+    user.RemoveTransformation(&damage);
+    other.RemoveTransformation(&plain);
+  }
+
+  void TestSharedTransformation() {
+    // one transformation in several lists keeps every owner.
+    std::unique_ptr<InspectableTransformationF> shared(new InspectableTransformationF(xoins::AddOp(1.f)));
+    THotCold a(0.f), b(0.f), c(0.f);
+    a.AddTransformation(shared.get(), true);
+    b.AddTransformation(shared.get(), true);
+    c.AddTransformation(shared.get(), true);
+    THotCold copy(b); // a copy is an owner too
+    b.RemoveTransformation(shared.get(), true);
+    CHECK(copy.GetValue(true) == 1.f);
+
+    shared->Disable();
+    CHECK(IsStale(a) && !IsStale(b) && IsStale(c) && IsStale(copy));
+    CHECK(a.GetValue(true) == 0.f && c.GetValue(true) == 0.f);
+
+    shared.reset();
+    CHECK(a.GetTransformations().IsEmpty());
+    CHECK(c.GetTransformations().IsEmpty());
+    CHECK(copy.GetTransformations().IsEmpty());
+  }
+
+  struct RemovalCounter : InspectableObserver<float> {
+    RemovalCounter() : changes(0) {}
+    void OnChanged(InspectableF*) { ++changes; }
+    int changes;
+  };
+
+  void TestDestroyedWhileAttached() {
+    InspectableToggle rules;
+    InspectableF stat(1.f);
+    std::unique_ptr<InspectableTransformationF> bonus(new InspectableTransformationF(xoins::AddOp(5.f)));
+    bonus->SetToggle(&rules);
+    stat.AddTransformation(bonus.get(), true);
+    CHECK(stat.GetValue() == 6.f);
+    CHECK(rules.GetDependentCount() == 1);
+    RemovalCounter counter;
+    bonus.reset(); // detached here, as RemoveTransformation would, without updating.
+    CHECK(counter.changes == 1);
+    CHECK(stat.GetTransformations().IsEmpty());
+    CHECK(rules.GetDependentCount() == 0);
+    CHECK(stat.GetValue() == 6.f);
+    CHECK(stat.GetValue(true) == 1.f);
+
+    // and the other way around: the Inspectable goes first.
+    InspectableTransformationF outliving(xoins::AddOp(1.f));
+    {
+      InspectableF shortLived(0.f);
+      shortLived.AddTransformation(&outliving);
+    }
+    outliving.Disable(); // no owner left to tell
+  }
+
+  void TestCopies() {
+    InspectableTransformDefinitionF doubled([](float& value) { value *= 2.f; });
+    InspectableTransformationF op(xoins::AddOp(1.f), 3), function([](float& value) { value -= 1.f; });
+    InspectableTransformationF shared(doubled);
+    InspectableF stat(1.f);
+    stat.AddTransformation(&op, true);
+    InspectableTransformationF opCopy(op), functionCopy(function), sharedCopy(shared);
+    CHECK(opCopy.GetPriority() == 3 && opCopy.GetOp().kind == xoins::TransformOpAdd);
+    CHECK(functionCopy.GetTransformFunc() && functionCopy.GetOp().kind == xoins::TransformOpNone);
+    CHECK(sharedCopy.GetDefinition() == &doubled && !opCopy.GetDefinition());
+    float value = 5.f;
+    opCopy(value);
+    functionCopy(value);
+    sharedCopy(value);
+    CHECK(value == 10.f);
+
+    opCopy.Disable(); // only the original is attached
+    CHECK(stat.GetValue(true) == 2.f);
+    functionCopy = shared;
+    sharedCopy = op;
+    opCopy = function;
+    value = 5.f;
+    opCopy(value);
+    functionCopy(value);
+    sharedCopy(value);
+    CHECK(value == 9.f);
+    sharedCopy.Set(doubled);
+    CHECK(sharedCopy.HasTransform() && sharedCopy.GetOp().kind == xoins::TransformOpNone);
+    stat.RemoveTransformation(&op);
+  }
+}
+
+int main() {
+  TestOnlyOwnerGoesStale();
+  TestToggleMarksItsUsers();
+  TestSharedTransformation();
+  TestDestroyedWhileAttached();
+  TestCopies();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,63 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// ParallelDispatch.cpp
+//
+//  AnyThread listeners changing another Inspectable through xoins::DeferFromListener,
+//  which runs the change on the dispatching thread before the MainThreadOnly listeners.
+//  The build also runs it under ThreadSanitizer when the compiler has it.
+//////////////////////////////////////////////////////////////////////////////////////////
+#define xoins_thread_pool
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+  void TestDeferredChanges(xoins::ThreadPoolDispatcher& pool) {
+    xoins::SetParallelDispatcher(&pool, 64, 16);
+    InspectableF stat(0.f), total(0.f);
+    InspectableTransformationF doubled(xoins::MulOp(2.f));
+    total.AddTransformation(&doubled, true);
+    stat.SetParallelDispatch(true);
+    std::atomic<int> inside(0);
+    const std::thread::id dispatching = std::this_thread::get_id();
+    for(int i = 0; i < 256; ++i) {
+      stat.ConnectOnValueChanged([&](InspectableF*, const float&, const float& value) {
+        if(xoins::IsInAnyThreadListener())
+          ++inside;
+        // reading is fine, changing 'total' has to wait for the dispatching thread.
+        xoins::DeferFromListener([&, value] {
+          CHECK(!xoins::IsInAnyThreadListener());
+          CHECK(std::this_thread::get_id() == dispatching);
+          total.SetIdentity(total.GetIdentity() + value, true);
+        });
+      }, xoins::AnyThread);
+    }
+    float seen = 0.f;
+    // every deferred change has landed by the time the MainThreadOnly listeners run.
+    stat.ConnectOnValueChanged([&](InspectableF*, const float&, const float&) { seen = total.GetValue(); });
+
+    stat.SetIdentity(1.f, true);
+    CHECK(inside == 256);
+    CHECK(total.GetIdentity() == 256.f && total.GetValue() == 512.f);
+    CHECK(seen == 512.f);
+    stat.SetIdentity(2.f, true);
+    CHECK(total.GetIdentity() == 256.f * 3.f);
+    total.RemoveTransformation(&doubled);
+    xoins::SetParallelDispatcher(nullptr);
+  }
+
+  void TestDeferOutsideListener() {
+    bool ran = false;
+    CHECK(!xoins::IsInAnyThreadListener());
+    xoins::DeferFromListener([&] { ran = true; });
+    CHECK(ran);
+  }
+}
+
+int main() {
+  xoins::ThreadPoolDispatcher pool(3);
+  TestDeferredChanges(pool);
+  TestDeferOutsideListener();
+  return xoins_test::CheckResult();
+}
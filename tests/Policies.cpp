@@ -0,0 +1,188 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Policies.cpp
+//
+//  Drives every shipped container policy through Inspectable: adding, removing, the
+//  evaluation order and enabling, and which transformations carry the intrusive hook.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <type_traits>
+#include <vector>
+
+namespace {
+  // what Inspectable<T, TPolicy> takes, which has a hook for IntrusiveListPolicy.
+  template<typename T, typename TPolicy>
+  using TransformationOf = typename Inspectable<T, TPolicy>::TTransform;
+
+  // a transformation that records it ran, and adds its tag so the value shows it too.
+  template<typename TPolicy>
+  struct Tagged {
+    TransformationOf<int, TPolicy> transformation;
+
+    Tagged(std::vector<int>* trace, int tag, int priority)
+    : transformation([trace, tag](int& value) { trace->push_back(tag); value += tag; }, priority)
+    {
+    }
+  };
+
+  template<typename TPolicy>
+  std::vector<int> Order(const Inspectable<int, TPolicy>& inspectable) {
+    std::vector<int> priorities;
+    for(TransformationOf<int, TPolicy>* transformation : inspectable.GetTransformations())
+      priorities.push_back(transformation->GetPriority());
+    return priorities;
+  }
+
+  template<typename TPolicy>
+  void TestAddAndOrder(bool stable) {
+    std::vector<int> trace;
+    Tagged<TPolicy> low(&trace, 1, -5), mid(&trace, 10, 0), high(&trace, 100, 5), midToo(&trace, 1000, 0);
+    Inspectable<int, TPolicy> stat(0);
+    CHECK(stat.GetTransformations().IsEmpty());
+
+    stat.AddTransformation(&mid.transformation);
+    stat.AddTransformation(&low.transformation);
+    stat.AddTransformation(&high.transformation, true);
+    CHECK(stat.GetValue() == 111);
+    CHECK(trace == std::vector<int>({ 100, 10, 1 }));
+    CHECK(Order(stat) == std::vector<int>({ 5, 0, -5 }));
+
+    stat.AddTransformation(&midToo.transformation);
+    trace.clear();
+    CHECK(stat.GetValue(true) == 1111);
+    if(stable) // VectorList sorts, so it doesn't promise an order for equal priorities
+      CHECK(trace == std::vector<int>({ 100, 10, 1000, 1 }));
+    CHECK(Order(stat) == std::vector<int>({ 5, 0, 0, -5 }));
+
+    CHECK(stat.ContainsTransformation(&midToo.transformation));
+    stat.AddTransformationUnique(&midToo.transformation, true);
+    CHECK(stat.GetValue() == 1111);
+    stat.AddTransformation(nullptr, true);
+    CHECK(stat.GetValue() == 1111);
+  }
+
+  template<typename TPolicy>
+  void TestRemove() {
+    std::vector<int> trace;
+    Tagged<TPolicy> a(&trace, 1, 3), b(&trace, 10, 2), c(&trace, 100, 1), d(&trace, 1000, 0), unused(&trace, 5, 0);
+    Inspectable<int, TPolicy> stat(0);
+    TransformationOf<int, TPolicy>* all[] = { &a.transformation, &b.transformation, &c.transformation, &d.transformation };
+    stat.AddTransformations(all, all + 4, true);
+    CHECK(stat.GetValue() == 1111);
+
+    stat.RemoveTransformation(&b.transformation, true);
+    CHECK(stat.GetValue() == 1101);
+    CHECK(!stat.ContainsTransformation(&b.transformation));
+    CHECK(Order(stat) == std::vector<int>({ 3, 1, 0 }));
+
+    stat.RemoveTransformation(&unused.transformation, true);
+    stat.RemoveTransformation(&b.transformation, true);
+    CHECK(stat.GetValue() == 1101);
+
+    // a range removes in one pass and keeps the order of what stays.
+    TransformationOf<int, TPolicy>* some[] = { &d.transformation, nullptr, &unused.transformation, &a.transformation };
+    stat.RemoveTransformations(some, some + 4, true);
+    CHECK(stat.GetValue() == 100);
+    CHECK(Order(stat) == std::vector<int>({ 1 }));
+    TransformationOf<int, TPolicy>* back[] = { &d.transformation, &a.transformation };
+    stat.AddTransformations(back, back + 2, true);
+    CHECK(stat.GetValue() == 1101);
+    CHECK(Order(stat) == std::vector<int>({ 3, 1, 0 }));
+
+    stat.RemoveTransformations(all, all + 4, true);
+    CHECK(stat.GetValue() == 0);
+    CHECK(stat.GetTransformations().IsEmpty());
+
+    // the list is still usable once emptied.
+    stat.AddTransformation(&c.transformation, true);
+    CHECK(stat.GetValue() == 100);
+  }
+
+  template<typename TPolicy>
+  void TestEnable() {
+    std::vector<int> trace;
+    Tagged<TPolicy> a(&trace, 1, 1), b(&trace, 10, 0);
+    Inspectable<int, TPolicy> stat(0);
+    stat.AddTransformation(&a.transformation);
+    stat.AddTransformation(&b.transformation, true);
+    CHECK(stat.GetValue() == 11);
+
+    a.transformation.Disable();
+    stat.ForceUpdate();
+    CHECK(stat.GetValue() == 10);
+    b.transformation.Disable();
+    trace.clear();
+    CHECK(stat.GetValue(true) == 0);
+    CHECK(trace.empty());
+
+    a.transformation.Enable();
+    b.transformation.Enable();
+    CHECK(stat.GetValue(true) == 11);
+
+    // a transformation added disabled doesn't run until it's enabled.
+    TransformationOf<int, TPolicy> late([](int& value) { value *= 2; }, -1, false);
+    stat.AddTransformation(&late, true);
+    CHECK(stat.GetValue() == 11);
+    late.Enable();
+    CHECK(stat.GetValue(true) == 22);
+    stat.RemoveTransformation(&late);
+  }
+
+  template<typename TPolicy>
+  void TestOpsAndReplace() {
+    Inspectable<float, TPolicy> stat(10.f);
+    TransformationOf<float, TPolicy> add(xoins::AddOp(5.f), 1);
+    TransformationOf<float, TPolicy> mul(xoins::MulOp(2.f), 0);
+    TransformationOf<float, TPolicy> func([](float& value) { value -= 1.f; }, 0);
+    stat.AddTransformation(&mul);
+    stat.AddTransformation(&add, true);
+    CHECK(stat.GetValue() == 30.f);
+
+    CHECK(stat.ReplaceTransformation(&mul, &func));
+    CHECK(!stat.ReplaceTransformation(&mul, &func));
+    CHECK(stat.GetValue(true) == 14.f);
+
+    TransformationOf<float, TPolicy>* restored[] = { &func, &add };
+    stat.RestoreTransformations(restored, restored + 2);
+    CHECK(stat.GetValue(true) == 14.f);
+    // back to an op where the function was, which HotColdList has to copy again.
+    CHECK(stat.ReplaceTransformation(&func, &mul));
+    float expected = 10.f;
+    for(auto transformation : stat.GetTransformations())
+      (*transformation)(expected);
+    CHECK(expected != 14.f && stat.GetValue(true) == expected);
+    stat.RemoveTransformation(&mul);
+    stat.RemoveTransformation(&add);
+  }
+
+  // only the policy that links through the hook pays for it.
+  void TestHook() {
+    typedef TransformationOf<float, xoins::IntrusiveListPolicy> TLinked;
+    CHECK((std::is_same<TransformationOf<float, xoins::HotColdPolicy>, InspectableTransformationF>::value));
+    CHECK((std::is_base_of<xoins::IntrusiveListHook, TLinked>::value));
+    CHECK(!(std::is_base_of<xoins::IntrusiveListHook, InspectableTransformationF>::value));
+    CHECK(sizeof(TLinked) == sizeof(InspectableTransformationF) + sizeof(xoins::IntrusiveListHook));
+  }
+
+  template<typename TPolicy>
+  void TestPolicy(bool stable) {
+    TestAddAndOrder<TPolicy>(stable);
+    TestRemove<TPolicy>();
+    TestEnable<TPolicy>();
+    TestOpsAndReplace<TPolicy>();
+  }
+}
+
+int main() {
+  TestPolicy<xoins::DefaultListPolicy>(true);
+  TestPolicy<xoins::VectorPolicy<> >(false);
+  TestPolicy<xoins::SmallVectorPolicy<1> >(true);
+  TestPolicy<xoins::SmallVectorPolicy<8> >(true);
+  TestPolicy<xoins::IntrusiveListPolicy>(true);
+  TestPolicy<xoins::SortedFlatPolicy<> >(true);
+  TestPolicy<xoins::HotColdPolicy>(true);
+  TestPolicy<xoins::PriorityBucketPolicy>(true);
+  TestHook();
+  return xoins_test::CheckResult();
+}
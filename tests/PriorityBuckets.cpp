@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// PriorityBuckets.cpp
+//
+//  PriorityBucketList keeps the order a stable sort by priority would, through Add,
+//  Insert, Remove and Replace, and drops buckets once they're empty.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+  typedef xoins::PriorityBucketList<InspectableTransformationI*> TList;
+
+  bool Predicate(InspectableTransformationI* a, InspectableTransformationI* b) {
+    return a->GetPriority() > b->GetPriority();
+  }
+
+  std::vector<InspectableTransformationI*> Contents(const TList& list) {
+    std::vector<InspectableTransformationI*> contents;
+    for(InspectableTransformationI* transformation : list)
+      contents.push_back(transformation);
+    return contents;
+  }
+
+  // what the list should hold: everything added, stable sorted by priority.
+  std::vector<InspectableTransformationI*> Expected(std::vector<InspectableTransformationI*> added) {
+    std::stable_sort(added.begin(), added.end(), Predicate);
+    return added;
+  }
+
+  void TestStableOrder() {
+    const int Priorities[] = { 0, 5, 0, -3, 5, 5, 0, -3, 10, 0 };
+    std::vector<InspectableTransformationI> transformations(40);
+    std::vector<InspectableTransformationI*> added;
+    TList list;
+    CHECK(list.IsEmpty() && list.begin() == list.end());
+    for(size_t i = 0; i < transformations.size(); ++i) {
+      InspectableTransformationI* transformation = &transformations[i];
+      transformation->SetPriority(Priorities[i % 10]);
+      // both ways in keep insertion order within a priority.
+      if(i % 3 == 0)
+        list.Insert(transformation, Predicate);
+      else
+        list.Add(transformation);
+      added.push_back(transformation);
+      CHECK(Contents(list) == Expected(added));
+    }
+
+    // removing from the middle of a bucket keeps the rest in order.
+    for(size_t i = 1; i < transformations.size(); i += 4) {
+      CHECK(list.Remove(&transformations[i]));
+      added.erase(std::find(added.begin(), added.end(), &transformations[i]));
+      CHECK(Contents(list) == Expected(added));
+    }
+    CHECK(!list.Remove(&transformations[1]));
+
+    // replacing keeps the position, whatever the replacement's priority.
+    InspectableTransformationI outsider([](int&) {}, 99);
+    InspectableTransformationI* replaced = Expected(added)[3];
+    std::vector<InspectableTransformationI*> before = Contents(list);
+    CHECK(list.Replace(replaced, &outsider));
+    std::replace(before.begin(), before.end(), replaced, &outsider);
+    CHECK(Contents(list) == before);
+    CHECK(list.Contains(&outsider) && !list.Contains(replaced));
+    CHECK(!list.Replace(replaced, &outsider));
+    CHECK(list.Remove(&outsider));
+    CHECK(!list.Contains(&outsider));
+    list.Clear();
+    CHECK(list.IsEmpty());
+  }
+
+  void TestEmptyBuckets() {
+    InspectableTransformationI high([](int&) {}, 10), low([](int&) {}, 1), lowToo([](int&) {}, 1);
+    TList list;
+    list.Add(&low);
+    list.Add(&high);
+    list.Add(&lowToo);
+    CHECK(Contents(list) == std::vector<InspectableTransformationI*>({ &high, &low, &lowToo }));
+
+    // the last element of a bucket takes the bucket with it.
+    CHECK(list.Remove(&high));
+    CHECK(Contents(list) == std::vector<InspectableTransformationI*>({ &low, &lowToo }));
+    CHECK(list.Remove(&low) && list.Remove(&lowToo));
+    CHECK(list.IsEmpty() && list.begin() == list.end());
+
+    // and coming back to an emptied priority starts after what's there.
+    list.Add(&lowToo);
+    list.Add(&high);
+    list.Add(&low);
+    CHECK(Contents(list) == std::vector<InspectableTransformationI*>({ &high, &lowToo, &low }));
+
+    // found even after its priority changed, which Inspectable never does while attached.
+    high.SetPriority(-100);
+    CHECK(list.Remove(&high));
+    CHECK(Contents(list) == std::vector<InspectableTransformationI*>({ &lowToo, &low }));
+  }
+
+  void TestEvaluationOrder() {
+    // runs in the same order as the stable default policy.
+    std::vector<int> trace;
+    std::vector<InspectableTransformationI> transformations;
+    transformations.reserve(12);
+    for(int i = 0; i < 12; ++i)
+      transformations.emplace_back([&trace, i](int& value) { trace.push_back(i); value = value * 3 + i; }, i % 3);
+    Inspectable<int, xoins::PriorityBucketPolicy> buckets(1);
+    InspectableI reference(1);
+    for(InspectableTransformationI& transformation : transformations) {
+      buckets.AddTransformation(&transformation);
+      reference.AddTransformation(&transformation);
+    }
+    CHECK(buckets.GetValue(true) == reference.GetValue(true));
+    if(!CHECK(trace.size() == 24))
+      return;
+    std::vector<int> first(trace.begin(), trace.begin() + 12), second(trace.begin() + 12, trace.end());
+    CHECK(first == second);
+    CHECK(first == std::vector<int>({ 2, 5, 8, 11, 1, 4, 7, 10, 0, 3, 6, 9 }));
+  }
+}
+
+int main() {
+  TestStableOrder();
+  TestEmptyBuckets();
+  TestEvaluationOrder();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,106 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Replication.cpp
+//
+//  Delta replication of identities and cached values.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+  const unsigned Count = 16;
+
+  void TestMirroredTransformations() {
+    // both sides run the same transformations, as a client predicting a server would.
+    std::unique_ptr<InspectableF[]> server(new InspectableF[Count]);
+    std::unique_ptr<InspectableF[]> client(new InspectableF[Count]);
+    InspectableTransformationF serverHaste(xoins::MulOp(3.f)), clientHaste(xoins::MulOp(3.f));
+    server[5].AddTransformation(&serverHaste);
+    client[5].AddTransformation(&clientHaste);
+
+    InspectableDeltaTrackerF tracker;
+    for(unsigned i = 0; i < Count; ++i)
+      tracker.Track(&server[i], i);
+    InspectableDeltaWriterF writer(tracker);
+    InspectableDeltaReaderF reader;
+    auto resolve = [&](uint32_t handle) { return handle < Count ? &client[handle] : nullptr; };
+
+    int valueCalls = 0, identityCalls = 0;
+    float lastSeen = 0.f;
+    client[5].ConnectOnValueChanged([&](InspectableF*, const float&, const float& value) { ++valueCalls; lastSeen = value; });
+    client[5].ConnectOnIdentityChanged([&](InspectableF*, const float&, const float&) { ++identityCalls; });
+
+    std::vector<unsigned char> packet;
+    CHECK(writer.Write(packet) == Count);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve));
+
+    tracker.AdvanceTick();
+    server[5].SetIdentity(2.f, true);
+    CHECK(server[5].GetValue() == 6.f);
+    packet.clear();
+    CHECK(writer.Write(packet) == 1);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve));
+    // the value arrives already transformed, so the client doesn't multiply it again.
+    CHECK(client[5].GetIdentity() == 2.f);
+    CHECK(client[5].GetValue() == 6.f);
+    CHECK(client[5].GetValue(true) == 6.f);
+    CHECK(valueCalls == 1 && lastSeen == 6.f);
+    CHECK(identityCalls == 1);
+
+    // a change to the transformations alone still replicates the value.
+    tracker.AdvanceTick();
+    serverHaste.Disable();
+    server[5].ForceUpdate();
+    packet.clear();
+    CHECK(writer.Write(packet) == 1);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve));
+    CHECK(client[5].GetValue() == 2.f);
+    CHECK(valueCalls == 2 && identityCalls == 1);
+
+    tracker.AdvanceTick();
+    packet.clear();
+    CHECK(writer.Write(packet) == 0);
+    CHECK(!reader.Apply(packet.data(), 0, resolve));
+
+    server[3].SetIdentity(4.f, true);
+    packet.clear();
+    CHECK(writer.Write(packet) == 1);
+    CHECK(!reader.Apply(packet.data(), packet.size() - 1, resolve));
+    client[5].RemoveTransformation(&clientHaste);
+    server[5].RemoveTransformation(&serverHaste);
+  }
+
+  void TestQuantized() {
+    typedef xoins::QuantizedDeltaCodec<float> TCodec;
+    InspectableF server(1.f), client;
+    InspectableDeltaTrackerF tracker;
+    tracker.Track(&server, 0);
+    InspectableDeltaWriter<float, xoins::DefaultListPolicy, TCodec> writer(tracker, TCodec(0.01f));
+    InspectableDeltaReader<float, xoins::DefaultListPolicy, TCodec> reader(TCodec(0.01f));
+    auto resolve = [&](uint32_t) { return &client; };
+
+    std::vector<unsigned char> packet;
+    CHECK(writer.Write(packet) == 1);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve));
+    CHECK(std::fabs(client.GetValue() - 1.f) < 1e-5f);
+
+    server.SetIdentity(1.004f, true); // within a step of what was sent
+    packet.clear();
+    CHECK(writer.Write(packet) == 0);
+    server.SetIdentity(-2.5f, true);
+    packet.clear();
+    CHECK(writer.Write(packet) == 1);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve));
+    CHECK(std::fabs(client.GetIdentity() + 2.5f) < 1e-5f);
+    CHECK(std::fabs(client.GetValue() + 2.5f) < 1e-5f);
+  }
+}
+
+int main() {
+  TestMirroredTransformations();
+  TestQuantized();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,120 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Rollback.cpp
+//
+//  Capturing and rewinding frames, the ring of frames wrapping around, and Inspectables
+//  destroyed while frames still hold records of them.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace {
+  void TestCaptureAndRewind() {
+    InspectableF stat(1.f);
+    InspectableTransformationF doubled(xoins::MulOp(2.f));
+    InspectableRollback<float> rollback(4);
+    CHECK(rollback.GetFrameCount() == 0);
+
+    stat.SetIdentity(2.f, true);
+    rollback.Capture(); // frame 1: identity 2
+    stat.AddTransformation(&doubled, true);
+    stat.SetIdentity(3.f, true);
+    rollback.Capture(); // frame 2: identity 3, doubled
+    stat.SetIdentity(4.f, true);
+    CHECK(stat.GetValue() == 8.f);
+    CHECK(rollback.GetFrameCount() == 2);
+
+    // drops what changed since the last Capture.
+    CHECK(rollback.Rewind(0));
+    CHECK(stat.GetIdentity() == 3.f && stat.GetCachedValue() == 6.f);
+    CHECK(rollback.GetFrameCount() == 2);
+
+    CHECK(!rollback.Rewind(3));
+    CHECK(stat.GetIdentity() == 3.f);
+    CHECK(rollback.Rewind(1));
+    CHECK(stat.GetIdentity() == 2.f && stat.GetCachedValue() == 2.f);
+    CHECK(!stat.ContainsTransformation(&doubled));
+    CHECK(rollback.GetFrameCount() == 1);
+
+    // the rewound frames record again from here.
+    stat.SetIdentity(5.f, true);
+    rollback.Capture();
+    stat.SetIdentity(6.f, true);
+    CHECK(rollback.Rewind(2));
+    CHECK(stat.GetIdentity() == 1.f && stat.GetCachedValue() == 1.f);
+    CHECK(rollback.GetFrameCount() == 0);
+  }
+
+  void TestRingWrapsAround() {
+    InspectableF stat(0.f);
+    InspectableRollback<float> rollback(2);
+    for(int frame = 1; frame <= 5; ++frame) {
+      stat.SetIdentity((float)frame, true);
+      stat.SetIdentity((float)frame * 10.f, true); // only the first change records
+      rollback.Capture();
+    }
+    CHECK(rollback.GetFrameCount() == 2);
+    CHECK(!rollback.Rewind(3));
+    stat.SetIdentity(60.f, true);
+    // the oldest frame kept starts where frame 3 ended.
+    CHECK(rollback.Rewind(2));
+    CHECK(stat.GetIdentity() == 30.f);
+    CHECK(rollback.GetFrameCount() == 0 && !rollback.Rewind(1));
+  }
+
+  void TestDestroyedMidFrame() {
+    InspectableF kept(1.f);
+    InspectableRollback<float> rollback(4);
+    std::aligned_storage<sizeof(InspectableF), alignof(InspectableF)>::type storage;
+    InspectableF* doomed = new (&storage) InspectableF(1.f);
+    doomed->SetIdentity(2.f, true);
+    kept.SetIdentity(2.f, true);
+    rollback.Capture();
+    doomed->SetIdentity(3.f, true);
+    kept.SetIdentity(3.f, true);
+    doomed->SetIdentity(4.f, true);
+    doomed->~InspectableF();
+
+    // one built at the same address isn't the one the records were about.
+    InspectableF* reborn = new (&storage) InspectableF(7.f);
+    CHECK(rollback.Rewind(1));
+    CHECK(kept.GetIdentity() == 1.f);
+    CHECK(reborn->GetIdentity() == 7.f);
+
+    // and it's recorded from scratch.
+    reborn->SetIdentity(8.f, true);
+    rollback.Capture();
+    reborn->SetIdentity(9.f, true);
+    CHECK(rollback.Rewind(1));
+    CHECK(reborn->GetIdentity() == 7.f);
+    reborn->~InspectableF();
+  }
+
+  void TestManyDestroyed() {
+    // destroying only walks the records of the Inspectable going away.
+    InspectableRollback<float> rollback(8);
+    InspectableF kept(0.f);
+    for(int frame = 0; frame < 8; ++frame) {
+      std::unique_ptr<InspectableF> stats[64];
+      for(auto& stat : stats) {
+        stat.reset(new InspectableF(0.f));
+        stat->SetIdentity((float)frame, true);
+      }
+      kept.SetIdentity((float)frame + 1.f, true);
+      rollback.Capture();
+    }
+    CHECK(rollback.Rewind(8));
+    CHECK(kept.GetIdentity() == 0.f);
+  }
+}
+
+int main() {
+  TestCaptureAndRewind();
+  TestRingWrapsAround();
+  TestDestroyedMidFrame();
+  TestManyDestroyed();
+  return xoins_test::CheckResult();
+}
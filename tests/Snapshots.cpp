@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Snapshots.cpp
+//
+//  Writing, validating and restoring snapshots.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <vector>
+
+namespace {
+  const unsigned Double = 7;
+  const unsigned PlusOne = 9;
+
+  void MakeModifier(InspectableTransformation<float>& transformation, unsigned definitionId) {
+    if(definitionId == Double)
+      transformation.Set([](float& value) { value *= 2.f; });
+    else
+      transformation.Set([](float& value) { value += 1.f; });
+    transformation.SetDefinitionId(definitionId);
+  }
+
+  // where the per Inspectable descriptor offsets of a snapshot of float start.
+  uint32_t* TransformOffsets(std::vector<unsigned char>& bytes, uint32_t count) {
+    size_t identities = xoins::internal::AlignSnapshotOffset(sizeof(xoins::internal::SnapshotHeader));
+    size_t values = xoins::internal::AlignSnapshotOffset(identities + count * sizeof(float));
+    size_t offsets = xoins::internal::AlignSnapshotOffset(values + count * sizeof(float));
+    return reinterpret_cast<uint32_t*>(&bytes[offsets]);
+  }
+
+  void TestRoundTrip() {
+    InspectableF stats[3] = { InspectableF(1.f), InspectableF(2.f), InspectableF(3.f) };
+    InspectableTransformationF twice, plusOne, unsaved([](float& value) { value += 100.f; });
+    MakeModifier(twice, Double);
+    twice.SetPriority(5);
+    MakeModifier(plusOne, PlusOne);
+    plusOne.Disable();
+    stats[1].AddTransformation(&twice).AddTransformation(&plusOne).AddTransformation(&unsaved, true);
+    CHECK(stats[1].GetValue() == 104.f);
+
+    std::vector<unsigned char> bytes;
+    xoins::WriteSnapshot(stats, 3, bytes);
+    xoins::SnapshotView<float> view(bytes.data(), bytes.size());
+    CHECK(view.IsValid());
+    CHECK(view.GetCount() == 3);
+    CHECK(view.GetTransformsEnd(1) - view.GetTransformsBegin(1) == 2);
+    CHECK(!xoins::SnapshotView<double>(bytes.data(), bytes.size()).IsValid());
+    CHECK(!xoins::SnapshotView<float>(bytes.data(), bytes.size() - 8).IsValid());
+
+    // restoring replaces what the Inspectables had, rather than adding to it.
+    InspectableF loaded[3];
+    InspectableTransformationF stale([](float& value) { value = -1.f; });
+    loaded[1].AddTransformation(&stale);
+    std::vector<InspectableTransformationF> made(10);
+    bool restored = xoins::RestoreSnapshot(view, loaded, 3, [&](size_t, const xoins::SnapshotTransformDescriptor& d) {
+      MakeModifier(made[d.definitionId], d.definitionId);
+      return &made[d.definitionId];
+    });
+    CHECK(restored);
+    CHECK(!loaded[1].ContainsTransformation(&stale));
+    CHECK(loaded[1].GetIdentity() == 2.f);
+    CHECK(loaded[1].GetValue() == 104.f); // the cached value, as saved
+    CHECK(loaded[1].GetValue(true) == 4.f); // the function without a definition id isn't saved
+    CHECK(made[Double].GetPriority() == 5);
+    CHECK(!made[PlusOne].IsEnabled());
+
+    // restoring again gives the same set, not a doubled one.
+    CHECK(xoins::RestoreSnapshot(view, loaded, 3, [&](size_t, const xoins::SnapshotTransformDescriptor& d) {
+      return &made[d.definitionId];
+    }));
+    CHECK(loaded[1].GetValue(true) == 4.f);
+
+    InspectableF wrongCount[2];
+    CHECK(!xoins::RestoreSnapshot(view, wrongCount, 2));
+  }
+
+  void TestCorruptOffsets() {
+    InspectableF stats[3] = { InspectableF(1.f), InspectableF(2.f), InspectableF(3.f) };
+    InspectableTransformationF a, b, c;
+    MakeModifier(a, Double);
+    MakeModifier(b, PlusOne);
+    MakeModifier(c, PlusOne);
+    stats[0].AddTransformation(&a);
+    stats[1].AddTransformation(&b);
+    stats[2].AddTransformation(&c);
+    std::vector<unsigned char> bytes;
+    xoins::WriteSnapshot(stats, 3, bytes);
+    CHECK(xoins::SnapshotView<float>(bytes.data(), bytes.size()).IsValid());
+
+    uint32_t* offsets = TransformOffsets(bytes, 3);
+    CHECK(offsets[0] == 0 && offsets[1] == 1 && offsets[2] == 2 && offsets[3] == 3);
+
+    // past the descriptors, though the last offset is still right.
+    offsets[1] = 1000;
+    CHECK(!xoins::SnapshotView<float>(bytes.data(), bytes.size()).IsValid());
+    // decreasing, so an Inspectable's range would run backwards.
+    offsets[1] = 2;
+    offsets[2] = 1;
+    CHECK(!xoins::SnapshotView<float>(bytes.data(), bytes.size()).IsValid());
+    offsets[2] = 2;
+    CHECK(xoins::SnapshotView<float>(bytes.data(), bytes.size()).IsValid());
+  }
+}
+
+int main() {
+  TestRoundTrip();
+  TestCorruptOffsets();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,163 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// SourceIndex.cpp
+//
+//  Removing transformations by source: each Inspectable changes once, and observers and
+//  listeners see the recomputed value.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <map>
+#include <new>
+#include <type_traits>
+
+namespace {
+  const uint64_t Aura = 1;
+  const uint64_t Gear = 2;
+
+  // records how often each Inspectable changes, and its cached value when it does.
+  struct ChangeRecorder : InspectableObserver<float> {
+    void OnBeforeChange(InspectableF* inspectable) { ++before[inspectable]; }
+    void OnChanged(InspectableF* inspectable) {
+      ++after[inspectable];
+      seen[inspectable] = inspectable->GetCachedValue();
+    }
+    std::map<InspectableF*, int>    before, after;
+    std::map<InspectableF*, float>  seen;
+  };
+
+  void TestRemoveAllFromSource() {
+    InspectableF first(1.f), second(2.f);
+    InspectableSourceIndex<float> sources;
+    // interleaved, so a source's transformations on one Inspectable aren't adjacent.
+    for(int i = 0; i < 3; ++i) {
+      sources.Add(Aura, first, xoins::AddOp(10.f));
+      sources.Add(Gear, first, xoins::MulOp(2.f), -1);
+      sources.Add(Aura, second, xoins::AddOp(100.f));
+    }
+    xoins::UpdateDirtyInspectables();
+    CHECK(first.GetValue() == 248.f);
+    CHECK(second.GetValue() == 302.f);
+
+    int listened = 0;
+    float heard = 0.f;
+    first.ConnectOnValueChanged([&](InspectableF*, const float&, const float& value) { ++listened; heard = value; });
+    ChangeRecorder recorder;
+    CHECK(sources.RemoveAllFromSource(Aura) == 6);
+    CHECK(recorder.before[&first] == 1 && recorder.after[&first] == 1);
+    CHECK(recorder.before[&second] == 1 && recorder.after[&second] == 1);
+    // already updated when observers hear about it, with nothing left to do.
+    CHECK(recorder.seen[&first] == 8.f);
+    CHECK(recorder.seen[&second] == 2.f);
+    CHECK(listened == 1 && heard == 8.f);
+    CHECK(!first.IsDirty() && !second.IsDirty());
+    CHECK(sources.GetCount() == 3 && !sources.ContainsSource(Aura));
+
+    CHECK(sources.Remove(Gear, first) == 3);
+    CHECK(first.GetValue() == 1.f);
+    CHECK(sources.GetCount() == 0);
+  }
+
+  void TestRemoveInsideBatch() {
+    InspectableF stat(1.f);
+    InspectableSourceIndex<float> sources;
+    sources.Add(Aura, stat, xoins::AddOp(1.f), 0, true);
+    sources.Add(Aura, stat, xoins::AddOp(1.f), 0, true);
+    {
+      InspectableBatch batch;
+      sources.RemoveAllFromSource(Aura);
+      CHECK(stat.GetValue() == 3.f && stat.IsDirty());
+    }
+    CHECK(stat.GetValue() == 1.f);
+  }
+
+  void TestReentrantListener() {
+    // a listener removing another source while the first is being removed.
+    InspectableF stat(0.f);
+    InspectableSourceIndex<float> sources;
+    sources.Add(Aura, stat, xoins::AddOp(1.f), 0, true);
+    sources.Add(Gear, stat, xoins::AddOp(2.f), 0, true);
+    bool once = false;
+    stat.ConnectOnValueChanged([&](InspectableF*, const float&, const float&) {
+      if(!once) {
+        once = true;
+        sources.RemoveAllFromSource(Gear);
+      }
+    });
+    CHECK(sources.RemoveAllFromSource(Aura) == 1);
+    CHECK(stat.GetValue() == 0.f);
+    CHECK(sources.GetCount() == 0);
+    sources.Add(Aura, stat, xoins::AddOp(4.f), 0, true); // reuses a freed slot
+    CHECK(stat.GetValue() == 4.f);
+  }
+
+  void TestListenerReusesSlots() {
+    // while one source's Inspectables are being recomputed, a listener on the first
+    // removes the same source and adds to it again, taking freed slots. Those mustn't be
+    // the ones still waiting to be detached.
+    InspectableF stats[4] = { InspectableF(0.f), InspectableF(0.f), InspectableF(0.f), InspectableF(0.f) };
+    InspectableSourceIndex<float> sources;
+    for(InspectableF& stat : stats) {
+      sources.Add(Aura, stat, xoins::AddOp(1.f), 0, true);
+      sources.Add(Gear, stat, xoins::AddOp(10.f), 0, true);
+    }
+    int calls = 0;
+    auto reenter = [&](InspectableF* stat, const float&, const float&) {
+      if(calls++ == 0) {
+        for(InspectableF& other : stats)
+          CHECK(sources.Remove(Aura, other) == 0); // already on their way out
+        sources.Add(Aura, *stat, xoins::AddOp(100.f), 0, true);
+        sources.Add(Aura, stats[3], xoins::AddOp(100.f), 0, true);
+      }
+    };
+    for(InspectableF& stat : stats)
+      stat.ConnectOnValueChanged(reenter);
+    CHECK(sources.RemoveAllFromSource(Aura) == 4);
+    CHECK(sources.ContainsSource(Aura) && sources.GetCount() == 6);
+    float total = 0.f;
+    for(InspectableF& stat : stats)
+      total += stat.GetValue(true);
+    CHECK(total == 240.f);
+    sources.Clear();
+    CHECK(sources.GetCount() == 0);
+    for(InspectableF& stat : stats)
+      CHECK(stat.GetValue(true) == 0.f);
+  }
+
+  void TestDestroyedInspectable() {
+    InspectableSourceIndex<float> sources;
+    InspectableF kept(1.f);
+    sources.Add(Aura, kept, xoins::AddOp(1.f), 0, true);
+    std::aligned_storage<sizeof(InspectableF), alignof(InspectableF)>::type storage;
+    InspectableF* doomed = new (&storage) InspectableF(1.f);
+    sources.Add(Aura, *doomed, xoins::AddOp(1.f));
+    sources.Add(Gear, *doomed, xoins::AddOp(1.f));
+    doomed->~InspectableF();
+    // it let go of its transformations, which the index only notices once it gets to them.
+    CHECK(sources.GetCount() == 3);
+    CHECK(sources.RemoveAllFromSource(Aura) == 1);
+    CHECK(kept.GetValue() == 1.f && sources.GetCount() == 1);
+
+    // one built at the same address doesn't inherit what's still listed for the old one.
+    InspectableF* reborn = new (&storage) InspectableF(5.f);
+    CHECK(sources.Remove(Gear, *reborn) == 0);
+    CHECK(sources.GetCount() == 0);
+    sources.Add(Gear, *reborn, xoins::AddOp(2.f), 0, true);
+    CHECK(reborn->GetValue() == 7.f);
+    reborn->~InspectableF();
+    reborn = new (&storage) InspectableF(3.f);
+    sources.Add(Aura, *reborn, xoins::AddOp(1.f), 0, true);
+    CHECK(sources.GetCount() == 1 && !sources.ContainsSource(Gear));
+    CHECK(sources.Remove(Aura, *reborn) == 1 && reborn->GetValue() == 3.f);
+    reborn->~InspectableF();
+  }
+}
+
+int main() {
+  TestRemoveAllFromSource();
+  TestRemoveInsideBatch();
+  TestReentrantListener();
+  TestListenerReusesSlots();
+  TestDestroyedInspectable();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// ThreadPool.cpp
+//
+//  Parallel listener dispatch through xoins::ThreadPoolDispatcher, including a job that
+//  starts its own dispatch and two threads dispatching at once. The build also runs it
+//  under ThreadSanitizer when the compiler has it.
+//////////////////////////////////////////////////////////////////////////////////////////
+#define xoins_thread_pool
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+  void TestParallelListeners(xoins::ThreadPoolDispatcher& pool) {
+    xoins::SetParallelDispatcher(&pool, 64, 16);
+    InspectableF stat(1.f);
+    stat.SetParallelDispatch(true);
+    std::atomic<int> anyThread(0);
+    int mainThread = 0;
+    std::vector<int> order;
+    for(int i = 0; i < 1000; ++i)
+      stat.ConnectOnValueChanged([&](InspectableF*, const float&, const float&) { ++anyThread; }, xoins::AnyThread);
+    for(int i = 0; i < 10; ++i)
+      stat.ConnectOnValueChanged([&, i](InspectableF*, const float&, const float&) { ++mainThread; order.push_back(i); });
+
+    for(int change = 0; change < 20; ++change)
+      stat.SetIdentity((float)change + 2.f, true);
+    CHECK(anyThread == 20000);
+    CHECK(mainThread == 200);
+    for(int i = 0; i < 10; ++i)
+      CHECK(order[i] == i);
+    xoins::SetParallelDispatcher(nullptr);
+  }
+
+  struct Counts {
+    xoins::ThreadPoolDispatcher*  pool;
+    std::atomic<int>              outer;
+    std::atomic<int>              inner;
+  };
+
+  void InnerJob(void* context, unsigned) {
+    ++static_cast<Counts*>(context)->inner;
+  }
+
+  void NestingJob(void* context, unsigned) {
+    Counts* counts = static_cast<Counts*>(context);
+    ++counts->outer;
+    // this thread is running one of the pool's jobs, so this runs here and returns.
+    counts->pool->Run(8, &InnerJob, context);
+  }
+
+  void TestNestedRun(xoins::ThreadPoolDispatcher& pool) {
+    Counts counts;
+    counts.pool = &pool;
+    counts.outer = 0;
+    counts.inner = 0;
+    pool.Run(32, &NestingJob, &counts);
+    CHECK(counts.outer == 32);
+    CHECK(counts.inner == 32 * 8);
+  }
+
+  void TestConcurrentRuns(xoins::ThreadPoolDispatcher& pool) {
+    // neither thread is inside a job, so the second Run waits for the first instead of
+    // being mistaken for a nested one.
+    Counts first, second;
+    first.pool = second.pool = &pool;
+    first.outer = first.inner = second.outer = second.inner = 0;
+    std::thread other([&] {
+      for(int i = 0; i < 50; ++i)
+        pool.Run(16, &NestingJob, &second);
+    });
+    for(int i = 0; i < 50; ++i)
+      pool.Run(16, &NestingJob, &first);
+    other.join();
+    CHECK(first.outer == 50 * 16 && first.inner == 50 * 16 * 8);
+    CHECK(second.outer == 50 * 16 && second.inner == 50 * 16 * 8);
+  }
+}
+
+int main() {
+  xoins::ThreadPoolDispatcher pool(3);
+  TestParallelListeners(pool);
+  TestNestedRun(pool);
+  TestConcurrentRuns(pool);
+  return xoins_test::CheckResult();
+}
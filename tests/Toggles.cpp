@@ -0,0 +1,111 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// Toggles.cpp
+//
+//  Flipping an InspectableToggle only marks dirty the Inspectables using it, once each,
+//  and forgets the ones that stopped using it.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <memory>
+#include <vector>
+
+namespace {
+  const unsigned Count = 64;
+
+  void TestOnlyUsersMarked() {
+    InspectableToggle rules(false);
+    std::unique_ptr<InspectableF[]> stats(new InspectableF[Count]);
+    std::vector<InspectableTransformationF> bonuses(Count);
+    for(unsigned i = 0; i < Count; ++i) {
+      stats[i].SetIdentity((float)i, true);
+      bonuses[i].Set(xoins::AddOp(100.f));
+      // every third Inspectable uses the toggle, the rest an untoggled transformation.
+      if(i % 3 == 0)
+        bonuses[i].SetToggle(&rules);
+      stats[i].AddTransformation(&bonuses[i], true);
+    }
+    const size_t users = (Count + 2) / 3;
+    CHECK(rules.GetDependentCount() == users);
+    CHECK(xoins::GetDirtyInspectableCount() == 0);
+    CHECK(stats[0].GetValue() == 0.f && stats[1].GetValue() == 101.f);
+    CHECK(!bonuses[0].IsActive() && bonuses[0].IsEnabled());
+
+    rules.Enable();
+    CHECK(xoins::GetDirtyInspectableCount() == users);
+    for(unsigned i = 0; i < Count; ++i)
+      CHECK(stats[i].IsDirty() == (i % 3 == 0));
+    xoins::UpdateDirtyInspectables();
+    CHECK(xoins::GetDirtyInspectableCount() == 0);
+    for(unsigned i = 0; i < Count; ++i)
+      CHECK(!stats[i].IsDirty() && stats[i].GetValue() == (float)i + 100.f);
+
+    // setting what it already is doesn't mark anything.
+    rules.Set(true);
+    CHECK(xoins::GetDirtyInspectableCount() == 0);
+
+    // an Inspectable that stops using it isn't marked any more.
+    stats[3].RemoveTransformation(&bonuses[3], true);
+    CHECK(rules.GetDependentCount() == users - 1);
+    rules.Disable();
+    CHECK(xoins::GetDirtyInspectableCount() == users - 1);
+    CHECK(!stats[3].IsDirty());
+    xoins::UpdateDirtyInspectables();
+    CHECK(stats[0].GetValue() == 0.f && stats[3].GetValue() == 3.f && stats[4].GetValue() == 104.f);
+    for(unsigned i = 0; i < Count; ++i)
+      stats[i].RemoveTransformation(&bonuses[i]);
+    CHECK(rules.GetDependentCount() == 0);
+  }
+
+  void TestMarkedOnce() {
+    // several toggled transformations on one Inspectable, and one shared by several.
+    InspectableToggle set;
+    InspectableF a(1.f), b(1.f);
+    InspectableTransformationF first(xoins::AddOp(1.f)), second(xoins::MulOp(2.f)), shared(xoins::AddOp(3.f), -1);
+    first.SetToggle(&set);
+    second.SetToggle(&set);
+    shared.SetToggle(&set);
+    a.AddTransformation(&first).AddTransformation(&second).AddTransformation(&shared, true);
+    b.AddTransformation(&shared, true);
+    CHECK(set.GetDependentCount() == 2);
+    CHECK(a.GetValue() == 7.f && b.GetValue() == 4.f);
+
+    set.Disable();
+    CHECK(xoins::GetDirtyInspectableCount() == 2);
+    xoins::UpdateDirtyInspectables();
+    CHECK(a.GetValue() == 1.f && b.GetValue() == 1.f);
+
+    // a's count only drops to 0 once its last toggled transformation is gone.
+    a.RemoveTransformation(&first);
+    a.RemoveTransformation(&shared);
+    CHECK(set.GetDependentCount() == 2);
+    a.RemoveTransformation(&second);
+    CHECK(set.GetDependentCount() == 1);
+    set.Enable();
+    CHECK(xoins::GetDirtyInspectableCount() == 1 && b.IsDirty() && !a.IsDirty());
+    xoins::UpdateDirtyInspectables();
+    CHECK(b.GetValue() == 4.f);
+    b.RemoveTransformation(&shared);
+  }
+
+  void TestDestroyedUser() {
+    InspectableToggle rules;
+    InspectableTransformationF bonus(xoins::AddOp(1.f));
+    bonus.SetToggle(&rules);
+    {
+      InspectableF shortLived(0.f);
+      shortLived.AddTransformation(&bonus, true);
+      CHECK(rules.GetDependentCount() == 1);
+    }
+    CHECK(rules.GetDependentCount() == 0);
+    rules.Disable();
+    CHECK(xoins::GetDirtyInspectableCount() == 0);
+  }
+}
+
+int main() {
+  TestOnlyUsersMarked();
+  TestMarkedOnce();
+  TestDestroyedUser();
+  return xoins_test::CheckResult();
+}
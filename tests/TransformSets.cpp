@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// TransformSets.cpp
+//
+//  Replicating which transformations are attached, by definition id: full sets, edits of
+//  the last set sent, and malformed packets.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <vector>
+
+namespace {
+  const unsigned DefinitionCount = 24;
+
+  // one side's transformations, a copy of each definition per Inspectable. They detach
+  // themselves when they're destroyed.
+  struct Side {
+    Side() {
+      for(unsigned i = 0; i < 2; ++i) {
+        for(unsigned id = 1; id <= DefinitionCount; ++id) {
+          InspectableTransformationF& transformation = transformations[i][id - 1];
+          transformation.Set(xoins::AddOp((float)id), (int)id);
+          transformation.SetDefinitionId(id);
+        }
+      }
+    }
+
+    InspectableTransformationF* Find(uint32_t handle, uint32_t definitionId) {
+      if(handle >= 2 || definitionId == 0 || definitionId > DefinitionCount)
+        return nullptr;
+      return &transformations[handle][definitionId - 1];
+    }
+
+    InspectableF                stats[2];
+    InspectableTransformationF  transformations[2][DefinitionCount];
+  };
+
+  std::vector<uint32_t> Ids(const InspectableF& stat) {
+    std::vector<uint32_t> ids;
+    for(InspectableTransformationF* transformation : stat.GetTransformations())
+      ids.push_back(transformation->GetDefinitionId());
+    return ids;
+  }
+
+  void TestSets() {
+    Side server, client;
+    InspectableDeltaTrackerF tracker;
+    tracker.Track(&server.stats[0], 0);
+    tracker.Track(&server.stats[1], 1);
+    InspectableTransformSetWriterF writer(tracker);
+    InspectableTransformSetReaderF reader;
+    auto resolve = [&](uint32_t handle) { return handle < 2 ? &client.stats[handle] : nullptr; };
+    auto resolveTransform = [&](uint32_t handle, uint32_t id) { return client.Find(handle, id); };
+
+    // only enabled transformations with a definition id are part of the set.
+    InspectableTransformationF untracked(xoins::MulOp(2.f));
+    server.stats[0].AddTransformation(&server.transformations[0][2]);
+    server.stats[0].AddTransformation(&server.transformations[0][6]);
+    server.stats[0].AddTransformation(&untracked);
+    server.transformations[0][4].Disable();
+    server.stats[0].AddTransformation(&server.transformations[0][4], true);
+    std::vector<unsigned char> packet;
+    CHECK(writer.Write(packet) == 2);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve, resolveTransform));
+    CHECK(Ids(client.stats[0]) == std::vector<uint32_t>({ 7, 3 }));
+    CHECK(client.stats[0].GetValue() == 10.f);
+    CHECK(client.stats[1].GetTransformations().IsEmpty());
+
+    // nothing changed, nothing is sent.
+    tracker.AdvanceTick();
+    packet.clear();
+    CHECK(writer.Write(packet) == 0);
+
+    // enabling one changes the set, and the receiver keeps the sender's order.
+    server.transformations[0][4].Enable();
+    server.stats[0].ForceUpdate();
+    packet.clear();
+    CHECK(writer.Write(packet) == 1);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve, resolveTransform));
+    CHECK(Ids(client.stats[0]) == std::vector<uint32_t>({ 7, 5, 3 }));
+    CHECK(client.stats[0].GetValue() == 15.f);
+
+    // a set where one id changed out of many goes out as a smaller edit.
+    tracker.AdvanceTick();
+    std::vector<InspectableTransformationF*> all;
+    for(InspectableTransformationF& transformation : server.transformations[1])
+      all.push_back(&transformation);
+    server.stats[1].AddTransformations(all.data(), all.data() + all.size(), true);
+    packet.clear();
+    CHECK(writer.Write(packet) == 1);
+    size_t full = packet.size();
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve, resolveTransform));
+    tracker.AdvanceTick();
+    server.stats[1].RemoveTransformation(&server.transformations[1][11], true);
+    packet.clear();
+    CHECK(writer.Write(packet) == 1);
+    CHECK(packet.size() < full / 2);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve, resolveTransform));
+    CHECK(Ids(client.stats[1]) == Ids(server.stats[1]));
+    CHECK(client.stats[1].GetValue() == server.stats[1].GetValue());
+
+    // after a Reset every tracked set is sent in full again.
+    tracker.AdvanceTick();
+    writer.Reset();
+    reader.Reset();
+    packet.clear();
+    CHECK(writer.Write(packet) == 2);
+    CHECK(reader.Apply(packet.data(), packet.size(), resolve, resolveTransform));
+    CHECK(Ids(client.stats[0]) == std::vector<uint32_t>({ 7, 5, 3 }));
+    CHECK(Ids(client.stats[1]) == Ids(server.stats[1]));
+    server.stats[0].RemoveTransformation(&untracked);
+  }
+
+  void TestMalformed() {
+    InspectableF stat;
+    InspectableTransformSetReaderF reader;
+    auto resolve = [&](uint32_t) { return &stat; };
+    auto resolveTransform = [](uint32_t, uint32_t) { return (InspectableTransformationF*)nullptr; };
+    CHECK(!reader.Apply(nullptr, 0, resolve, resolveTransform));
+    const unsigned char badEncoding[] = { 1, 0, 7 };
+    CHECK(!reader.Apply(badEncoding, sizeof(badEncoding), resolve, resolveTransform));
+    // claims more ids than there are bytes.
+    const unsigned char truncated[] = { 1, 0, xoins::internal::TransformSetFull, 9, 1 };
+    CHECK(!reader.Apply(truncated, sizeof(truncated), resolve, resolveTransform));
+    const unsigned char empty[] = { 1, 0, xoins::internal::TransformSetFull, 0 };
+    CHECK(reader.Apply(empty, sizeof(empty), resolve, resolveTransform));
+    CHECK(stat.GetTransformations().IsEmpty());
+  }
+}
+
+int main() {
+  TestSets();
+  TestMalformed();
+  return xoins_test::CheckResult();
+}
@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// WorldHash.cpp
+//
+//  The world hash doesn't depend on the order Inspectables are tracked or changed in,
+//  follows every change, and its groups add up to it.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+#include "Check.h"
+
+#include <memory>
+
+namespace {
+  const unsigned Count = 8;
+
+  void TestOrderIndependent() {
+    InspectableF a[Count], b[Count];
+    InspectableWorldHashF forward, backward;
+    for(unsigned i = 0; i < Count; ++i) {
+      a[i].SetIdentity((float)i * 1.5f, true);
+      forward.Track(&a[i], i, i % 3);
+    }
+    // the same values reached in another order, tracked in another order.
+    for(unsigned i = Count; i-- > 0;) {
+      b[i].SetIdentity(100.f, true);
+      backward.Track(&b[i], i, i % 3);
+    }
+    for(unsigned i = Count; i-- > 0;)
+      b[i].SetIdentity((float)i * 1.5f, true);
+    CHECK(forward.GetHash() == backward.GetHash());
+    for(unsigned group = 0; group < 3; ++group)
+      CHECK(forward.GetGroupHash(group) == backward.GetGroupHash(group));
+
+    // the key says which value is which, so swapping two values is a different world.
+    b[1].SetIdentity(a[2].GetValue(), true);
+    b[2].SetIdentity(a[1].GetValue(), true);
+    CHECK(forward.GetHash() != backward.GetHash());
+    b[1].SetIdentity(a[1].GetValue(), true);
+    b[2].SetIdentity(a[2].GetValue(), true);
+    CHECK(forward.GetHash() == backward.GetHash());
+  }
+
+  void TestChanges() {
+    InspectableF stats[Count];
+    InspectableWorldHashF hash;
+    CHECK(hash.GetHash() == 0 && hash.GetGroupCount() == 0);
+    for(unsigned i = 0; i < Count; ++i)
+      hash.Track(&stats[i], 1000 + i, i < 2 ? 0 : 2);
+    uint64_t start = hash.GetHash();
+
+    // a transformation changes the value, and taking it away changes it back.
+    InspectableTransformationF bonus(xoins::AddOp(3.f));
+    stats[3].AddTransformation(&bonus, true);
+    CHECK(hash.GetHash() != start);
+    stats[3].RemoveTransformation(&bonus, true);
+    CHECK(hash.GetHash() == start);
+
+    // values are hashed bit for bit.
+    InspectableF zero(0.f), negativeZero(-0.f);
+    InspectableWorldHashF zeroHash, negativeZeroHash;
+    zeroHash.Track(&zero, 1);
+    negativeZeroHash.Track(&negativeZero, 1);
+    CHECK(zeroHash.GetHash() != negativeZeroHash.GetHash());
+
+    // the groups add up to the whole, and a group nothing is in hashes to 0.
+    stats[4].SetIdentity(7.f, true);
+    CHECK(hash.GetGroupCount() == 3);
+    CHECK(hash.GetGroupHash(1) == 0 && hash.GetGroupHash(9) == 0);
+    CHECK(hash.GetGroupHash(0) + hash.GetGroupHash(2) == hash.GetHash());
+
+    // untracking takes the contribution out, tracking again puts it back.
+    uint64_t before = hash.GetHash(), group = hash.GetGroupHash(2);
+    hash.Untrack(&stats[4]);
+    CHECK(hash.GetHash() != before && hash.GetGroupHash(2) != group);
+    CHECK(hash.GetGroupHash(0) + hash.GetGroupHash(2) == hash.GetHash());
+    hash.Track(&stats[4], 1004, 2);
+    CHECK(hash.GetHash() == before && hash.GetGroupHash(2) == group);
+  }
+
+  void TestDestroyed() {
+    InspectableF kept(1.f);
+    InspectableWorldHashF hash, without;
+    hash.Track(&kept, 1);
+    without.Track(&kept, 1);
+    std::unique_ptr<InspectableF> doomed(new InspectableF(5.f));
+    hash.Track(doomed.get(), 2, 1);
+    CHECK(hash.GetHash() != without.GetHash());
+    doomed.reset();
+    CHECK(hash.GetHash() == without.GetHash());
+    CHECK(hash.GetGroupHash(1) == 0);
+  }
+}
+
+int main() {
+  TestOrderIndependent();
+  TestChanges();
+  TestDestroyed();
+  return xoins_test::CheckResult();
+}
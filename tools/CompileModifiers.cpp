@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////////////////
+// CompileModifiers.cpp
+//
+//  Compiles a text file of modifiers into a table for xoins::ModifierTableView, so a build
+//  step can ship tables instead of expressions:
+//
+//    xoins_compile_modifiers [--double] modifiers.txt modifiers.table
+//
+//  Each line is '<id> <priority> <expression>'. Blank lines and lines starting with '#'
+//  are skipped. Tables are for float unless --double is given.
+//////////////////////////////////////////////////////////////////////////////////////////
+#include "Inspectable.h"
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+  bool ReadSources(const char* path, std::deque<std::string>& texts, std::vector<xoins::ModifierTableSource>& sources) {
+    std::ifstream file(path);
+    if(!file) {
+      std::fprintf(stderr, "can't open %s\n", path);
+      return false;
+    }
+    std::string line;
+    for(unsigned number = 1; std::getline(file, line); ++number) {
+      size_t start = line.find_first_not_of(" \t\r");
+      if(start == std::string::npos || line[start] == '#')
+        continue;
+      std::istringstream fields(line);
+      xoins::ModifierTableSource source;
+      if(!(fields >> source.id >> source.priority)) {
+        std::fprintf(stderr, "%s:%u: expected '<id> <priority> <expression>'\n", path, number);
+        return false;
+      }
+      std::string text;
+      std::getline(fields, text);
+      texts.push_back(text);
+      source.text = texts.back().c_str(); // a deque doesn't move what it already holds
+      sources.push_back(source);
+    }
+    return true;
+  }
+
+  template<typename T>
+  bool Compile(const std::vector<xoins::ModifierTableSource>& sources, std::vector<unsigned char>& bytes) {
+    std::string error;
+    if(!xoins::CompileModifierTable<T>(sources.data(), sources.size(), bytes, &error)) {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return false;
+    }
+    return true;
+  }
+}
+
+int main(int argc, char** argv) {
+  bool useDouble = argc == 4 && std::strcmp(argv[1], "--double") == 0;
+  if(argc != 3 && !useDouble) {
+    std::fprintf(stderr, "usage: %s [--double] <modifiers.txt> <output.table>\n", argv[0]);
+    return 2;
+  }
+  const char* input = argv[argc - 2];
+  const char* output = argv[argc - 1];
+
+  std::deque<std::string> texts;
+  std::vector<xoins::ModifierTableSource> sources;
+  if(!ReadSources(input, texts, sources))
+    return 1;
+  std::vector<unsigned char> bytes;
+  if(!(useDouble ? Compile<double>(sources, bytes) : Compile<float>(sources, bytes)))
+    return 1;
+
+  std::ofstream file(output, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+  if(!file) {
+    std::fprintf(stderr, "can't write %s\n", output);
+    return 1;
+  }
+  return 0;
+}